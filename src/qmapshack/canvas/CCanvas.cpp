@@ -1147,40 +1147,75 @@ void CCanvas::print(QPainter& p, const QRectF& area, const QPointF& focus, bool
   const QSize oldSize = size();
   const QSize newSize(area.size().toSize());
 
-  setDrawContextSize(newSize);
+  printTileStart(newSize, focus);
+  printTileFinish(p, newSize, focus, printScale ? QRectF(QPoint(0, 0), newSize) : QRectF());
+
+  setDrawContextSize(oldSize);
+}
+
+void CCanvas::printTileStart(const QSize& size, const QPointF& focus) {
+  // make sure no thread of a previous tile is blocking the resize
+  for (IDrawContext* context : qAsConst(allDrawContext)) {
+    context->wait();
+  }
+
+  setDrawContextSize(size);
 
   // ----- start to draw thread based content -----
+  // The draw context needs a painter to copy it's current buffer to. As the buffer
+  // is outdated anyway a minimal dummy image is sufficient. The real content is
+  // drawn by printTileFinish().
+  QImage dummy(1, 1, QImage::Format_ARGB32);
+  QPainter p(&dummy);
   // move coordinate system to center of the screen
-  p.translate(newSize.width() >> 1, newSize.height() >> 1);
-
-  redraw_e redraw = eRedrawAll;
+  p.translate(size.width() >> 1, size.height() >> 1);
 
   for (IDrawContext* context : qAsConst(allDrawContext)) {
-    context->draw(p, redraw, focus);
+    context->draw(p, eRedrawAll, focus);
   }
+}
 
+void CCanvas::printTileFinish(QPainter& p, const QSize& size, const QPointF& focus, const QRectF& rectScale) {
   for (IDrawContext* context : qAsConst(allDrawContext)) {
     context->wait();
   }
 
+  // move coordinate system to center of the screen
+  p.translate(size.width() >> 1, size.height() >> 1);
+
+  // copy the buffers without triggering the threads again
   for (IDrawContext* context : qAsConst(allDrawContext)) {
-    context->draw(p, redraw, focus);
+    context->draw(p, eRedrawNone, focus);
   }
 
   // restore coordinate system to default
   p.resetTransform();
   // ----- start to draw fast content -----
 
-  QRect r(QPoint(0, 0), area.size().toSize());
+  QRect r(QPoint(0, 0), size);
 
   grid->draw(p, r);
   gis->draw(p, r);
   rt->draw(p, r);
-  if (printScale) {
-    drawScale(p, r);
+  if (!rectScale.isEmpty()) {
+    drawScale(p, rectScale);
   }
+}
 
-  setDrawContextSize(oldSize);
+void CCanvas::printOverlays(QPainter& p, const QSize& size, const QPointF& focus) {
+  for (IDrawContext* context : qAsConst(allDrawContext)) {
+    context->wait();
+  }
+
+  setDrawContextSize(size);
+
+  // The scale is derived from the map's coordinate system. Passing the focus with
+  // eRedrawNone sets it up without triggering the draw context thread.
+  QImage dummy(1, 1, QImage::Format_ARGB32);
+  QPainter pDummy(&dummy);
+  map->draw(pDummy, eRedrawNone, focus);
+
+  drawScale(p, QRectF(QPointF(0, 0), size));
 }
 
 bool CCanvas::event(QEvent* event) {
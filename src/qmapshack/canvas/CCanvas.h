@@ -165,6 +165,42 @@ class CCanvas : public QWidget {
 
   void print(QPainter& p, const QRectF& area, const QPointF& focus, bool printScale = true);
 
+  /**
+     @brief Start to render a tile of the canvas in the background
+
+     This will resize all draw contexts to the tile size and trigger their threads.
+     It returns immediately. Thus several canvas objects can render their tiles
+     in parallel. Call printTileFinish() to collect the result.
+
+     @param size      the tile size in [px]
+     @param focus     the center of the tile in [rad]
+   */
+  void printTileStart(const QSize& size, const QPointF& focus);
+
+  /**
+     @brief Wait for the tile started by printTileStart() and draw it
+
+     @param p         the painter to draw the tile on
+     @param size      the tile size in [px], must be the same as for printTileStart()
+     @param focus     the center of the tile in [rad], must be the same as for printTileStart()
+     @param rectScale the area to place the scale into. No scale is drawn if the rectangle is empty.
+   */
+  void printTileFinish(QPainter& p, const QSize& size, const QPointF& focus, const QRectF& rectScale = QRectF());
+
+  /**
+     @brief Draw the overlays (e.g. the scale) onto an already rendered area
+
+     The scale is placed into the bottom right corner of the area.
+
+     @param p         the painter with the rendered area
+     @param size      the size of the area in [px]
+     @param focus     the center of the area in [rad]
+   */
+  void printOverlays(QPainter& p, const QSize& size, const QPointF& focus);
+
+  /// the current point of focus (the canvas center) in [rad]
+  const QPointF& getFocus() const { return posFocus; }
+
   /**
      @brief Set a single map file to be shown on the canvas
 
@@ -0,0 +1,132 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#include "device/CDeviceCache.h"
+
+#include <QtCore>
+
+#include "setup/IAppSetup.h"
+
+#define CACHE_MAGIC "QMSDeviceCache"
+#define CACHE_VERSION 1
+
+CDeviceCache::CDeviceCache(const QString& path) : path(QDir(path).absolutePath()) { loadCache(); }
+
+CDeviceCache::~CDeviceCache() { saveCache(); }
+
+bool CDeviceCache::get(const QFileInfo& fi, QString& name, QByteArray& data) {
+  auto entry = entries.find(fi.absoluteFilePath());
+  if (entry == entries.end()) {
+    return false;
+  }
+
+  if (entry->size != fi.size() || entry->lastModified != fi.lastModified().toMSecsSinceEpoch()) {
+    return false;
+  }
+
+  entry->used = true;
+  name = entry->name;
+  data = entry->data;
+  return true;
+}
+
+void CDeviceCache::set(const QFileInfo& fi, const QString& name, const QByteArray& data) {
+  entry_t& entry = entries[fi.absoluteFilePath()];
+  entry.size = fi.size();
+  entry.lastModified = fi.lastModified().toMSecsSinceEpoch();
+  entry.name = name;
+  entry.data = data;
+  entry.used = true;
+  cacheChanged = true;
+}
+
+QString CDeviceCache::getCacheFilename() const {
+  const QString& name = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Md5).toHex();
+  const QDir dir(IAppSetup::getPlatformInstance()->defaultCachePath());
+  return dir.absoluteFilePath("Devices/" + name + ".cache");
+}
+
+void CDeviceCache::loadCache() {
+  QFile file(getCacheFilename());
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  QDataStream stream(&file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream.setVersion(QDataStream::Qt_5_2);
+
+  QByteArray magic;
+  qint32 version = 0;
+  QString cachePath;
+  quint32 count = 0;
+  stream >> magic >> version >> cachePath >> count;
+  // the path is stored, too, to detect hash collisions of the filename
+  if (magic != CACHE_MAGIC || version != CACHE_VERSION || cachePath != path) {
+    return;
+  }
+
+  entries.reserve(count);
+  for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+    QString filename;
+    entry_t entry;
+    stream >> filename >> entry.size >> entry.lastModified >> entry.name >> entry.data;
+    if (stream.status() != QDataStream::Ok) {
+      break;
+    }
+    entries[filename] = entry;
+  }
+}
+
+void CDeviceCache::saveCache() {
+  // drop the entries of files that have been removed from the device
+  for (auto entry = entries.begin(); entry != entries.end();) {
+    if (entry->used) {
+      ++entry;
+    } else {
+      entry = entries.erase(entry);
+      cacheChanged = true;
+    }
+  }
+
+  if (!cacheChanged) {
+    return;
+  }
+
+  const QString& filename = getCacheFilename();
+  QDir().mkpath(QFileInfo(filename).absolutePath());
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Failed to write device cache" << filename;
+    return;
+  }
+
+  QDataStream stream(&file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream.setVersion(QDataStream::Qt_5_2);
+
+  stream << QByteArray(CACHE_MAGIC) << qint32(CACHE_VERSION) << path << quint32(entries.count());
+  for (auto entry = entries.constBegin(); entry != entries.constEnd(); ++entry) {
+    stream << entry.key() << entry->size << entry->lastModified << entry->name << entry->data;
+  }
+
+  if (file.commit()) {
+    cacheChanged = false;
+  }
+}
@@ -0,0 +1,91 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#ifndef CDEVICECACHE_H
+#define CDEVICECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+class QFileInfo;
+
+/**
+   @brief Persistent cache of the projects loaded from a device's directory
+
+   Parsing all GPX/FIT/TCX files of a device takes a long time, especially for
+   devices with hundreds of activities. However most of the files have not changed
+   since the device was connected last time. For each file the cache stores the
+   serialized project (see IGisProject::operator>>). The entry is valid as long as
+   the file's size and time of last modification match.
+
+   The cache is written when the object is destroyed. Entries of files not requested
+   during the object's lifetime are dropped.
+ */
+class CDeviceCache {
+ public:
+  /**
+     @brief Load the cache of a directory
+
+     @param path  the directory the files are read from
+   */
+  CDeviceCache(const QString& path);
+  virtual ~CDeviceCache();
+
+  /**
+     @brief Get the cached project of a file
+
+     @param fi    the file
+     @param name  set to the project's name
+     @param data  set to the serialized project
+     @return Return false if the file is not cached or has changed.
+   */
+  bool get(const QFileInfo& fi, QString& name, QByteArray& data);
+
+  /**
+     @brief Add or replace the project of a file
+
+     @param fi    the file
+     @param name  the project's name
+     @param data  the serialized project
+   */
+  void set(const QFileInfo& fi, const QString& name, const QByteArray& data);
+
+ private:
+  QString getCacheFilename() const;
+  void loadCache();
+  void saveCache();
+
+  struct entry_t {
+    qint64 size = 0;
+    /// time of last modification in [ms] since epoch
+    qint64 lastModified = 0;
+    QString name;
+    QByteArray data;
+    /// true if the entry was requested or set
+    bool used = false;
+  };
+
+  /// the absolute path of the directory
+  const QString path;
+  /// the entries by absolute path of the file
+  QHash<QString, entry_t> entries;
+  bool cacheChanged = false;
+};
+
+#endif  // CDEVICECACHE_H
@@ -22,9 +22,9 @@
 #include <QtXml>
 
 #include "canvas/CCanvas.h"
+#include "device/CDeviceCache.h"
 #include "device/CDeviceGarminArchive.h"
 #include "gis/CGisListWks.h"
-#include "gis/fit/CFitProject.h"
 #include "gis/gpx/CGpxProject.h"
 #include "gis/tcx/CTcxProject.h"
 #include "gis/wpt/CGisItemWpt.h"
@@ -118,40 +118,34 @@ CDeviceGarmin::CDeviceGarmin(const QString& path, const QString& key, const QStr
     dir.mkpath(pathTcx);
   }
 
-  createProjectsFromFiles(pathGpx, "gpx");
-  createProjectsFromFiles(pathGpx + "/Current", "gpx");
+  CDeviceCache cache(dir.absolutePath());
+
+  QStringList filenames;
+  listFiles(pathGpx, "gpx", filenames);
+  listFiles(pathGpx + "/Current", "gpx", filenames);
+  loadProjects(filenames, cache);
 
   QDir dirArchive(dir.absoluteFilePath(pathGpx + "/Archive"));
   if (dirArchive.exists() && (dirArchive.entryList(QStringList("*.gpx")).count() != 0)) {
     archive = new CDeviceGarminArchive(dir.absoluteFilePath(pathGpx + "/Archive"), this);
   }
 
-  createProjectsFromFiles(pathActivities, "fit");
-  createProjectsFromFiles(pathCourses, "fit");
-  createProjectsFromFiles(pathLocations, "fit");
+  filenames.clear();
+  listFiles(pathActivities, "fit", filenames);
+  listFiles(pathCourses, "fit", filenames);
+  listFiles(pathLocations, "fit", filenames);
   if (!pathTcx.isEmpty()) {
-    createProjectsFromFiles(pathTcx, "tcx");
+    listFiles(pathTcx, "tcx", filenames);
   }
+  loadProjects(filenames, cache);
 }
 
-void CDeviceGarmin::createProjectsFromFiles(QString subdirecoty, QString fileEnding) {
-  QDir dirLoop(dir.absoluteFilePath(subdirecoty));
+void CDeviceGarmin::listFiles(const QString& subdirectory, const QString& fileEnding, QStringList& filenames) {
+  QDir dirLoop(dir.absoluteFilePath(subdirectory));
   qDebug() << "reading files from device: " << dirLoop.path();
   const QStringList& entries = dirLoop.entryList(QStringList("*." + fileEnding));
   for (const QString& entry : entries) {
-    const QString filename = dirLoop.absoluteFilePath(entry);
-    IGisProject* project = nullptr;
-    if (fileEnding == "fit") {
-      project = new CFitProject(filename, this);
-    } else if (fileEnding == "gpx") {
-      project = new CGpxProject(filename, this);
-    } else if (fileEnding == "tcx") {
-      project = new CTcxProject(filename, this);
-    }
-
-    if (project && !project->isValid()) {
-      delete project;
-    }
+    filenames << dirLoop.absoluteFilePath(entry);
   }
 }
 
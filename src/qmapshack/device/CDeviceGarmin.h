@@ -37,7 +37,8 @@ class CDeviceGarmin : public IDevice {
   void aboutToRemoveProject(IGisProject* project) override;
 
  private:
-  void createProjectsFromFiles(QString subdirecoty, QString fileEnding);
+  /// append the absolute paths of all files in a subdirectory with the given ending
+  void listFiles(const QString& subdirectory, const QString& fileEnding, QStringList& filenames);
   void createAdventureFromProject(IGisProject* project, const QString& gpxFilename);
   void insertCopyOfProjectAsGpx(IGisProject* project);
   void insertCopyOfProjectAsTcx(IGisProject* project);
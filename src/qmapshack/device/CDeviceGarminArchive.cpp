@@ -21,10 +21,10 @@
 #include <QtWidgets>
 
 #include "canvas/CCanvas.h"
+#include "device/CDeviceCache.h"
 #include "device/CDeviceGarmin.h"
 #include "gis/CGisListWks.h"
 #include "gis/CGisWorkspace.h"
-#include "gis/gpx/CGpxProject.h"
 
 CDeviceGarminArchive::CDeviceGarminArchive(const QString& path, CDeviceGarmin* parent)
     : IDevice(path, eTypeGarmin, parent->getKey(), parent) {
@@ -45,14 +45,14 @@ void CDeviceGarminArchive::slotExpanded(QTreeWidgetItem* item) {
   CDeviceMountLock mountLock(*this);
   CCanvasCursorLock cursorLock(Qt::WaitCursor, __func__);
   qDebug() << "reading files from device: " << dir.path();
+  QStringList filenames;
   const QStringList& entries = dir.entryList(QStringList("*.gpx"));
   for (const QString& entry : entries) {
-    const QString filename = dir.absoluteFilePath(entry);
-    IGisProject* project = new CGpxProject(filename, this);
-    if (!project->isValid()) {
-      delete project;
-    }
+    filenames << dir.absoluteFilePath(entry);
   }
+
+  CDeviceCache cache(dir.absolutePath());
+  loadProjects(filenames, cache);
 }
 
 void CDeviceGarminArchive::slotCollapsed(QTreeWidgetItem* item) {
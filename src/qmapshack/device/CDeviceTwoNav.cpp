@@ -20,8 +20,8 @@
 
 #include <QtWidgets>
 
+#include "device/CDeviceCache.h"
 #include "gis/CGisListWks.h"
-#include "gis/gpx/CGpxProject.h"
 #include "gis/tnv/CTwoNavProject.h"
 
 CDeviceTwoNav::CDeviceTwoNav(const QString& path, const QString& key, const QString& model, QTreeWidget* parent)
@@ -50,13 +50,14 @@ CDeviceTwoNav::CDeviceTwoNav(const QString& path, const QString& key, const QStr
     }
   }
 
+  CDeviceCache cache(dir.absolutePath());
+
+  QStringList filenames;
   const QStringList& entriesGpx = dirData.entryList(QStringList("*.gpx"));
   for (const QString& entry : entriesGpx) {
-    IGisProject* project = new CGpxProject(dirData.absoluteFilePath(entry), this);
-    if (!project->isValid()) {
-      delete project;
-    }
+    filenames << dirData.absoluteFilePath(entry);
   }
+  loadProjects(filenames, cache);
 
   const QStringList& entriesDir = dirData.entryList(QDir::NoDotAndDotDot | QDir::Dirs);
   for (const QString& entry : entriesDir) {
@@ -68,13 +69,12 @@ CDeviceTwoNav::CDeviceTwoNav(const QString& path, const QString& key, const QStr
 
   // special case: read the gpx files in the track log directory.
   dirData.setPath(dir.absoluteFilePath(pathData + "Tracklog"));
+  filenames.clear();
   const QStringList& entriesLog = dirData.entryList(QStringList("*.gpx"));
   for (const QString& entry : entriesLog) {
-    IGisProject* project = new CGpxProject(dirData.absoluteFilePath(entry), this);
-    if (!project->isValid()) {
-      delete project;
-    }
+    filenames << dirData.absoluteFilePath(entry);
   }
+  loadProjects(filenames, cache);
 }
 
 CDeviceTwoNav::~CDeviceTwoNav() {}
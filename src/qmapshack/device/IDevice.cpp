@@ -18,11 +18,18 @@
 **********************************************************************************************/
 #include "device/IDevice.h"
 
+#include <QtWidgets>
+
 #include "CMainWindow.h"
 #include "canvas/CCanvas.h"
+#include "device/CDeviceCache.h"
 #include "device/CDeviceGarmin.h"
 #include "gis/CGisListWks.h"
+#include "gis/fit/CFitProject.h"
+#include "gis/gpx/CGpxProject.h"
 #include "gis/prj/IGisProject.h"
+#include "gis/tcx/CTcxProject.h"
+#include "gis/wpt/CGisItemWpt.h"
 #include "helpers/CSelectCopyAction.h"
 
 #ifdef HAVE_DBUS
@@ -34,12 +41,14 @@ int IDevice::cnt = 0;
 IDevice::IDevice(const QString& path, type_e type, const QString& key, QTreeWidget* parent)
     : QTreeWidgetItem(parent, type), dir(path), key(key) {
   setIcon(CGisListWks::eColumnIcon, QIcon("://icons/32x32/Device.png"));
+  threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
   cnt++;
 }
 
 IDevice::IDevice(const QString& path, type_e type, const QString& key, CDeviceGarmin* parent)
     : QTreeWidgetItem(parent, type), dir(path), key(key) {
   setIcon(CGisListWks::eColumnIcon, QIcon("://icons/32x32/PathGreen.png"));
+  threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
 }
 
 IDevice::~IDevice() { cnt--; }
@@ -72,6 +81,135 @@ void IDevice::umount(const QString& path) {
 
 QString IDevice::getName() const { return text(CGisListWks::eColumnName); }
 
+/**
+   @brief Load a file into a project without parent, called by the worker threads
+
+   The items create their icons while loading. This is fine as QPixmap is backed by a QImage
+   with the raster paint engine used on all supported platforms. Shared data touched on the way:
+   CWptIconManager locks its icon map, the FIT profile lookup is a local static created thread
+   safe and read only afterwards, CGisItemTrk does not show dialogs and the items' destructors do not
+   touch the user focus outside the main thread.
+ */
+static IGisProject* loadProjectFile(const QString& filename) {
+  const QString& suffix = QFileInfo(filename).suffix().toLower();
+  if (suffix == "fit") {
+    return new CFitProject(filename);
+  } else if (suffix == "gpx") {
+    return new CGpxProject(filename);
+  } else if (suffix == "tcx") {
+    return new CTcxProject(filename);
+  }
+  return nullptr;
+}
+
+void IDevice::loadProjects(const QStringList& filenames, CDeviceCache& cache) {
+  struct result_t {
+    QFileInfo fi;
+    QString name;
+    /// the serialized project, empty if the file failed to load
+    QByteArray data;
+    bool cached = false;
+    bool done = false;
+  };
+
+  const int N = filenames.count();
+  QVector<result_t> buffer(N);
+  // the workers get a pointer to their result, the vector must not be touched anymore
+  result_t* results = buffer.data();
+
+  QMutex mutex;
+  QWaitCondition condition;
+
+  for (int n = 0; n < N; n++) {
+    result_t* result = &results[n];
+    result->fi = QFileInfo(filenames[n]);
+    result->cached = cache.get(result->fi, result->name, result->data);
+    if (result->cached) {
+      result->done = true;
+      continue;
+    }
+
+    const QString& filename = filenames[n];
+    threadPool.start([filename, result, &mutex, &condition]() {
+      QString name;
+      QByteArray data;
+      IGisProject* project = loadProjectFile(filename);
+      if (project != nullptr && project->isValid()) {
+        name = project->getName();
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.setVersion(QDataStream::Qt_5_2);
+        *project >> stream;
+      }
+      delete project;
+
+      QMutexLocker lock(&mutex);
+      result->name = name;
+      result->data = data;
+      result->done = true;
+      condition.wakeAll();
+    });
+  }
+
+  // Attach the projects in the order of the files. Cached projects are restored
+  // while the workers are still busy with the others.
+  for (int n = 0; n < N; n++) {
+    result_t* result = &results[n];
+    {
+      QMutexLocker lock(&mutex);
+      while (!result->done) {
+        condition.wait(&mutex);
+      }
+    }
+
+    if (result->data.isEmpty()) {
+      continue;
+    }
+
+    if (!result->cached) {
+      cache.set(result->fi, result->name, result->data);
+    }
+    restoreProject(filenames[n], result->name, result->data);
+  }
+
+  // the workers might still hold the mutex
+  threadPool.waitForDone();
+}
+
+void IDevice::restoreProject(const QString& filename, const QString& name, QByteArray& data) {
+  // a name that is not a file creates an empty project, the filename is restored from the data
+  IGisProject* project = nullptr;
+  const QString& suffix = QFileInfo(filename).suffix().toLower();
+  if (suffix == "fit") {
+    project = new CFitProject(name, this);
+  } else if (suffix == "gpx") {
+    project = new CGpxProject(name, this);
+  } else if (suffix == "tcx") {
+    project = new CTcxProject(name, this);
+  }
+
+  if (project == nullptr) {
+    return;
+  }
+
+  QDataStream stream(&data, QIODevice::ReadOnly);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream.setVersion(QDataStream::Qt_5_2);
+  *project << stream;
+  project->setToolTip(CGisListWks::eColumnName, project->getInfo());
+
+  if (suffix == "gpx") {
+    // images attached to waypoints are stored in the device's file system, see CGpxProject::loadGpx()
+    const int N = project->childCount();
+    for (int n = 0; n < N; n++) {
+      CGisItemWpt* wpt = dynamic_cast<CGisItemWpt*>(project->child(n));
+      if (wpt != nullptr) {
+        loadImages(*wpt);
+      }
+    }
+  }
+}
+
 void IDevice::getItemsByPos(const QPointF& pos, QList<IGisItem*>& items) {
   const int N = childCount();
   for (int n = 0; n < N; n++) {
@@ -203,6 +341,9 @@ void IDevice::editItemByKey(const IGisItem::key_t& key) {
 }
 
 void IDevice::insertCopyOfProject(IGisProject* project, int& lastResult) {
+  // a workspace project might not have restored it's items yet
+  project->restoreItems();
+
   IGisProject* project2 = getProjectByKey(project->getKey());
   if (project2) {
     int result = lastResult;
@@ -233,6 +374,9 @@ void IDevice::insertCopyOfProject(IGisProject* project, int& lastResult) {
 }
 
 void IDevice::updateProject(IGisProject* project) {
+  // a workspace project might not have restored it's items yet
+  project->restoreItems();
+
   IGisProject* project2 = getProjectByKey(project->getKey());
   if (project2) {
     if (project2->remove()) {
@@ -279,7 +423,7 @@ bool IDevice::testForExternalProject(const QString& filename) {
   return false;
 }
 
-void IDevice::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) {
+void IDevice::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) {
   const int N = childCount();
   for (int n = 0; n < N; n++) {
     IGisProject* project = dynamic_cast<IGisProject*>(child(n));
@@ -295,7 +439,7 @@ void IDevice::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& bl
   }
 }
 
-void IDevice::drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+void IDevice::drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                         CGisDraw* gis) {
   const int N = childCount();
   for (int n = 0; n < N; n++) {
@@ -21,11 +21,13 @@
 #define IDEVICE_H
 
 #include <QDir>
+#include <QThreadPool>
 #include <QTreeWidgetItem>
 
 #include "gis/IGisItem.h"
 class CGisDraw;
 class CGisItemWpt;
+class CDeviceCache;
 class CDeviceGarmin;
 
 class IDevice : public QTreeWidgetItem {
@@ -55,8 +57,8 @@ class IDevice : public QTreeWidgetItem {
   void getItemsByKeys(const QList<IGisItem::key_t>& keys, QList<IGisItem*>& items);
   void editItemByKey(const IGisItem::key_t& key);
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis);
-  void drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis);
+  void drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                  CGisDraw* gis);
   void drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis);
 
@@ -83,10 +85,28 @@ class IDevice : public QTreeWidgetItem {
    */
   bool testForExternalProject(const QString& filename);
 
+  /**
+     @brief Load GPX, FIT and TCX files as projects of this device
+
+     Files found in the cache are restored from their serialized project. All others
+     are parsed in parallel by the thread pool and added to the cache. The projects
+     are attached in the order of the file list.
+
+     @param filenames  the absolute paths of the files
+     @param cache      the cache of the directory the files are read from
+   */
+  void loadProjects(const QStringList& filenames, CDeviceCache& cache);
+
   static int cnt;
 
   QDir dir;
   QString key;
+
+ private:
+  void restoreProject(const QString& filename, const QString& name, QByteArray& data);
+
+  /// the workers parsing the files in loadProjects()
+  QThreadPool threadPool;
 };
 
 class CDeviceMountLock {
@@ -135,6 +135,8 @@ CGisListDB::CGisListDB(QWidget* parent) : QTreeWidget(parent), socket(nullptr) {
   menuDatabase->addAction(actionAddFolder);
   actionSearch = menuDatabase->addAction(QIcon("://icons/32x32/Zoom.png"), tr("Search Database"), this,
                                          &CGisListDB::slotSearchDatabase);
+  actionSearchView = menuDatabase->addAction(QIcon("://icons/32x32/Zoom.png"), tr("Items in Current View"), this,
+                                             &CGisListDB::slotSearchDatabaseView);
   actionUpdate = menuDatabase->addAction(QIcon("://icons/32x32/DatabaseSync.png"), tr("Sync. with Database"), this,
                                          &CGisListDB::slotUpdateDatabase);
   actionDelDatabase = menuDatabase->addAction(QIcon("://icons/32x32/DeleteOne.png"), tr("Remove Database"), this,
@@ -331,6 +333,7 @@ void CGisListDB::slotContextMenu(const QPoint& point) {
     actionUpdate->setEnabled(enabled);
     actionAddFolder->setEnabled(enabled);
     actionSearch->setEnabled(enabled);
+    actionSearchView->setEnabled(enabled && (CMainWindow::self().getVisibleCanvas() != nullptr));
 
     menuDatabase->exec(p);
 
@@ -876,6 +879,30 @@ void CGisListDB::slotSearchDatabase() {
   isInternalEdit++;
 }
 
+void CGisListDB::slotSearchDatabaseView() {
+  CGisListDBEditLock lock(false, this, "slotSearchDatabaseView");
+
+  IDBFolder* db = dynamic_cast<IDBFolder*>(currentItem());
+  CCanvas* canvas = CMainWindow::self().getVisibleCanvas();
+  if ((db == nullptr) || (canvas == nullptr)) {
+    return;
+  }
+
+  // the bounding box of the viewport's corners in [rad]
+  QPolygonF area(QRectF(canvas->rect()));
+  for (QPointF& pt : area) {
+    canvas->convertPx2Rad(pt);
+  }
+
+  isInternalEdit--;
+  dlgSearch = new CSearchDatabase(*db, this);
+  connect(dlgSearch.data(), &CSearchDatabase::sigItemChanged, this, &CGisListDB::slotItemChanged);
+  dlgSearch->searchArea(area.boundingRect());
+  dlgSearch->exec();
+  delete dlgSearch;
+  isInternalEdit++;
+}
+
 void CGisListDB::slotReadyRead() {
   CGisListDBEditLock lock(true, this, "slotReadyRead");
 
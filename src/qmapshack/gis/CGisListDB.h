@@ -60,6 +60,7 @@ class CGisListDB : public QTreeWidget {
   void slotDelItem();
   void slotUpdateDatabase();
   void slotSearchDatabase();
+  void slotSearchDatabaseView();
   void slotRenameFolder();
   void slotCopyFolder();
   void slotMoveFolder();
@@ -91,6 +92,7 @@ class CGisListDB : public QTreeWidget {
   QAction* actionDelDatabase;
   QAction* actionUpdate;
   QAction* actionSearch;
+  QAction* actionSearchView;
 
   QMenu* menuItem;
   QAction* actionDelItem;
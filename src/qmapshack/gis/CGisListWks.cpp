@@ -36,6 +36,7 @@
 #include "device/IDevice.h"
 #include "gis/CGisDatabase.h"
 #include "gis/CGisListWks.h"
+#include "gis/CGisListWksSaveThread.h"
 #include "gis/CGisWorkspace.h"
 #include "gis/CSelDevices.h"
 #include "gis/IGisItem.h"
@@ -66,7 +67,7 @@
 #include "setup/IAppSetup.h"
 
 #undef DB_VERSION
-#define DB_VERSION 4
+#define DB_VERSION 5
 
 class CGisListWksEditLock {
  public:
@@ -95,6 +96,8 @@ CGisListWks::CGisListWks(QWidget* parent) : QTreeWidget(parent) {
   db.open();
   configDB();
 
+  threadSave = new CGisListWksSaveThread(db, this);
+
   // workspace project related actions
   actionEditPrj = addAction(QIcon("://icons/32x32/EditDetails.png"), tr("Edit.."), this, &CGisListWks::slotEditPrj);
   actionCopyPrj = addAction(QIcon("://icons/32x32/Copy.png"), tr("Copy to..."), this, &CGisListWks::slotCopyProject);
@@ -207,10 +210,11 @@ CGisListWks::CGisListWks(QWidget* parent) : QTreeWidget(parent) {
   actionEditPrxWpt =
       addAction(QIcon("://icons/32x32/WptEditProx.png"), tr("Change Proximity..."), this, &CGisListWks::slotEditPrxWpt);
 
-  connect(qApp, &QApplication::aboutToQuit, this, &CGisListWks::slotSaveWorkspace);
+  connect(qApp, &QApplication::aboutToQuit, this, &CGisListWks::slotAboutToQuit);
   connect(this, &CGisListWks::customContextMenuRequested, this, &CGisListWks::slotContextMenu);
   connect(this, &CGisListWks::itemDoubleClicked, this, &CGisListWks::slotItemDoubleClicked);
   connect(this, &CGisListWks::itemChanged, this, &CGisListWks::slotItemChanged);
+  connect(this, &CGisListWks::itemExpanded, this, &CGisListWks::slotItemExpanded);
 
   SETTINGS;
   saveOnExit = cfg.value("Database/saveOnExit", saveOnExit).toBool();
@@ -241,13 +245,16 @@ CGisListWks::CGisListWks(QWidget* parent) : QTreeWidget(parent) {
   }
 }
 
-CGisListWks::~CGisListWks() {}
+CGisListWks::~CGisListWks() { threadSave->wait(); }
 
 void CGisListWks::configDB() {
   QSqlQuery query(db);
 
-  QUERY_RUN("PRAGMA locking_mode=EXCLUSIVE", return )
-  QUERY_RUN("PRAGMA synchronous=OFF", return )
+  // The workspace is saved by CGisListWksSaveThread with a connection of it's own.
+  // Thus the database can't be locked exclusively. WAL mode lets the thread write
+  // while this connection reads.
+  QUERY_RUN("PRAGMA journal_mode=WAL", return )
+  QUERY_RUN("PRAGMA synchronous=NORMAL", return )
   QUERY_RUN("PRAGMA temp_store=MEMORY", return )
   QUERY_RUN("PRAGMA default_cache_size=50", return )
   QUERY_RUN("PRAGMA page_size=8192", return )
@@ -289,7 +296,8 @@ void CGisListWks::initDB() {
       "keyqms         TEXT NOT NULL,"
       "changed        BOOLEAN DEFAULT FALSE,"
       "visible        BOOLEAN DEFAULT TRUE,"
-      "data           BLOB NOT NULL"
+      "data           BLOB NOT NULL,"
+      "pos            INTEGER DEFAULT 0"
       ")",
       NO_CMD)
 
@@ -313,6 +321,9 @@ void CGisListWks::migrateDB(int version) {
   if (version < 4) {
     migrateDB3to4();
   }
+  if (version < 5) {
+    migrateDB4to5();
+  }
 
   // save the new version to the database
   QSqlQuery query(db);
@@ -361,6 +372,14 @@ void CGisListWks::migrateDB3to4() {
   }
 }
 
+void CGisListWks::migrateDB4to5() {
+  // add a new column `pos` to keep the order of the projects. As rows are updated
+  // in place the order of the row ids does not reflect the order in the workspace
+  // anymore. Existing rows keep their order by id.
+  QSqlQuery query(db);
+  QUERY_RUN("ALTER TABLE workspace ADD COLUMN pos INTEGER DEFAULT 0;", NO_CMD)
+}
+
 void CGisListWks::setExternalMenu(QMenu* project) {
   menuNone = project;
   connect(CMainWindow::self().findChild<QAction*>("actionAddEmptyProject"), &QAction::triggered, this,
@@ -726,64 +745,51 @@ CDBProject* CGisListWks::getProjectById(quint64 id, const QString& db) {
 }
 
 void CGisListWks::slotSaveWorkspace() {
-  CGisListWksEditLock lock(true, IGisItem::mutexItems);
-
   if (!saveOnExit) {
     return;
   }
 
-  QSqlQuery query(db);
-  QUERY_RUN("DELETE FROM workspace", return )
-
   qDebug() << "slotSaveWorkspace()";
 
-  const int total = topLevelItemCount();
-  PROGRESS_SETUP(tr("Saving workspace. Please wait."), 0, total, this);
+  // Only the snapshots are taken while holding the lock. Serializing and
+  // writing the changed projects is done by the thread.
+  QList<CGisListWksSaveThread::project_t> projects;
+  {
+    CGisListWksEditLock lock(false, IGisItem::mutexItems);
 
-  for (int i = 0; i < total; i++) {
-    PROGRESS(i, return );
-
-    IGisProject* project = dynamic_cast<IGisProject*>(topLevelItem(i));
-    if (nullptr == project) {
-      continue;
+    const int total = topLevelItemCount();
+    for (int i = 0; i < total; i++) {
+      const IGisProject* project = dynamic_cast<const IGisProject*>(topLevelItem(i));
+      if (nullptr == project) {
+        continue;
+      }
+      projects << CGisListWksSaveThread::getSnapshot(*project);
     }
-
-    QByteArray data;
-    QDataStream stream(&data, QIODevice::WriteOnly);
-    stream.setVersion(QDataStream::Qt_5_2);
-    stream.setByteOrder(QDataStream::LittleEndian);
-
-    project->IGisProject::operator>>(stream);
-
-    query.prepare(
-        "INSERT INTO workspace (type, keyqms, name, changed, visible, data) VALUES (:type, :keyqms, :name, :changed, "
-        ":visible, :data)");
-    query.bindValue(":type", project->getType());
-    query.bindValue(":keyqms", project->getKey());
-    query.bindValue(":name", project->getName());
-    query.bindValue(":changed", project->isChanged());
-
-    bool visible = (project->checkState(CGisListDB::eColumnCheckbox) == Qt::Checked);
-    query.bindValue(":visible", visible);
-    query.bindValue(":data", data);
-    QUERY_EXEC(continue);
   }
 
-  query.prepare("UPDATE userfocus set focus=:focus");
-  query.bindValue(":focus", IGisProject::getUserFocus());
-  QUERY_EXEC();
+  threadSave->save(projects, IGisProject::getUserFocus());
 
   if (saveEvery) {
     QTimer::singleShot(saveEvery * 60000, this, &CGisListWks::slotSaveWorkspace);
   }
 }
 
+void CGisListWks::slotAboutToQuit() {
+  CCanvas::setOverrideCursor(Qt::WaitCursor, "slotAboutToQuit");
+  slotSaveWorkspace();
+  threadSave->wait();
+  CCanvas::restoreOverrideCursor("slotAboutToQuit");
+}
+
 void CGisListWks::slotLoadWorkspace() {
   CGisListWksEditLock lock(true, IGisItem::mutexItems);
 
   QSqlQuery query(db);
 
-  QUERY_RUN("SELECT type, keyqms, name, changed, visible, data FROM workspace", return )
+  QUERY_RUN("SELECT id, type, keyqms, name, changed, visible, data, pos FROM workspace ORDER BY pos, id", return )
+
+  // the rows of all restored projects, to save only changed projects later on
+  QList<CGisListWksSaveThread::row_t> rows;
 
   {  // open context for progress dialog
     const int total = query.size();
@@ -793,11 +799,13 @@ void CGisListWks::slotLoadWorkspace() {
     while (query.next()) {
       PROGRESS(progCnt++, return );
 
-      int type = query.value(0).toInt();
-      QString name = query.value(2).toString();
-      bool changed = query.value(3).toBool();
-      Qt::CheckState visible = query.value(4).toBool() ? Qt::Checked : Qt::Unchecked;
-      QByteArray data = query.value(5).toByteArray();
+      qint64 id = query.value(0).toLongLong();
+      int type = query.value(1).toInt();
+      QString name = query.value(3).toString();
+      bool changed = query.value(4).toBool();
+      Qt::CheckState visible = query.value(5).toBool() ? Qt::Checked : Qt::Unchecked;
+      QByteArray data = query.value(6).toByteArray();
+      qint32 pos = query.value(7).toInt();
 
       QDataStream stream(&data, QIODevice::ReadOnly);
       stream.setVersion(QDataStream::Qt_5_2);
@@ -808,21 +816,21 @@ void CGisListWks::slotLoadWorkspace() {
         case IGisProject::eTypeQms: {
           project = new CQmsProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);  // (1a)
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
 
         case IGisProject::eTypeQlb: {
           project = new CQlbProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);  // (1a)
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
 
         case IGisProject::eTypeGpx: {
           project = new CGpxProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);  // (1b)
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
 
@@ -846,7 +854,7 @@ void CGisListWks::slotLoadWorkspace() {
         case IGisProject::eTypeSlf: {
           project = new CSlfProject(name, false);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);  // (1d)
-          *project << stream;
+          project->deferItems(stream);
 
           // the CSlfProject does not - as the other C*Project - register itself in the list
           // of currently opened projects. This is done manually here.
@@ -857,28 +865,28 @@ void CGisListWks::slotLoadWorkspace() {
         case IGisProject::eTypeFit: {
           project = new CFitProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
 
         case IGisProject::eTypeTcx: {
           project = new CTcxProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
 
         case IGisProject::eTypeSml: {
           project = new CSmlProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
 
         case IGisProject::eTypeLog: {
           project = new CSmlProject(name, this);
           project->setCheckState(CGisListDB::eColumnCheckbox, visible);
-          *project << stream;
+          project->deferItems(stream);
           break;
         }
       }
@@ -893,10 +901,22 @@ void CGisListWks::slotLoadWorkspace() {
         if (changed) {
           project->setChanged();
         }
+
+        CGisListWksSaveThread::row_t row;
+        row.key = project->getKey();
+        row.id = id;
+        row.pos = pos;
+        row.fingerprint = CGisListWksSaveThread::getFingerprint(CGisListWksSaveThread::getSnapshot(*project));
+        rows << row;
       }
     }
   }  // close context for progress dialog
 
+  threadSave->setRows(rows);
+
+  // restore the items of all visible projects step by step
+  restoreItemsLater();
+
   slotGeoSearch(static_cast<QAction*>(CMainWindow::self().findChild<QAction*>("actionGeoSearch"))->isChecked());
 
   for (const QString& filename : qlOpts->arguments) {
@@ -915,6 +935,43 @@ void CGisListWks::slotLoadWorkspace() {
   emit sigChanged();
 }
 
+void CGisListWks::restoreItemsLater() {
+  if (!restoreItemsScheduled) {
+    restoreItemsScheduled = true;
+    QTimer::singleShot(0, this, &CGisListWks::slotRestoreItems);
+  }
+}
+
+void CGisListWks::slotRestoreItems() {
+  CGisListWksEditLock lock(false, IGisItem::mutexItems);
+  restoreItemsScheduled = false;
+
+  // Restore a single project per call to keep the GUI responsive. Projects that
+  // are hidden are restored as soon as they get expanded, shown or saved.
+  const int N = topLevelItemCount();
+  for (int i = 0; i < N; i++) {
+    IGisProject* project = dynamic_cast<IGisProject*>(topLevelItem(i));
+    if (nullptr == project || !project->hasDeferredItems() || !project->isVisible()) {
+      continue;
+    }
+
+    project->restoreItems();
+    emit sigChanged();
+
+    restoreItemsLater();
+    return;
+  }
+}
+
+void CGisListWks::slotItemExpanded(QTreeWidgetItem* item) {
+  IGisProject* project = dynamic_cast<IGisProject*>(item);
+  if (nullptr != project && project->hasDeferredItems()) {
+    CGisListWksEditLock lock(true, IGisItem::mutexItems);
+    project->restoreItems();
+    emit sigChanged();
+  }
+}
+
 void CGisListWks::showMenuProjectWks(const QPoint& p) {
   QMenu menu(this);
   menu.addAction(actionEditPrj);
@@ -1088,6 +1145,9 @@ void CGisListWks::slotContextMenu(const QPoint& point) {
   for (QTreeWidgetItem* item : items) {
     IGisProject* project = dynamic_cast<IGisProject*>(item);
     if (nullptr != project) {
+      // all project related actions need the project's items
+      project->restoreItems();
+
       // as soon as we find an unchecked element, not all elements are checked (and vice versa)
       if (project->checkState(CGisListDB::eColumnCheckbox) == Qt::Unchecked) {
         allChecked = false;
@@ -1475,10 +1535,15 @@ void CGisListWks::slotItemDoubleClicked(QTreeWidgetItem* item, int) {
   }
 }
 
-void CGisListWks::slotItemChanged(QTreeWidgetItem* /*item*/, int column) {
+void CGisListWks::slotItemChanged(QTreeWidgetItem* item, int column) {
   CGisListWksEditLock lock(true, IGisItem::mutexItems);
 
   if (column == eColumnCheckBox) {
+    IGisProject* project = dynamic_cast<IGisProject*>(item);
+    if (nullptr != project && project->isVisible()) {
+      project->restoreItems();
+    }
+
     CGisWorkspace::self().slotWksItemSelectionReset();
     emit sigChanged();
   }
@@ -1887,6 +1952,9 @@ QSet<QString> CGisListWks::getAllDeviceKeys() const {
 }
 
 void CGisListWks::syncPrjToDevices(IGisProject* project, const QSet<QString>& keys) {
+  // hidden projects with automatic sync are not restored yet
+  project->restoreItems();
+
   const int N = topLevelItemCount();
   CCanvas* canvas = CMainWindow::self().getVisibleCanvas();
   for (int n = 0; n < N; n++) {
@@ -32,6 +32,7 @@ class QAction;
 class CGeoSearch;
 class IGisProject;
 class CDBProject;
+class CGisListWksSaveThread;
 class IDeviceWatcher;
 class QActionGroup;
 
@@ -61,6 +62,9 @@ class CGisListWks : public QTreeWidget {
 
   void removeDevice(const QString& key);
 
+  /// restore the deferred items of all visible projects in the background
+  void restoreItemsLater();
+
  public slots:
   void slotLoadWorkspace();
 
@@ -74,6 +78,9 @@ class CGisListWks : public QTreeWidget {
 
  private slots:
   void slotSaveWorkspace();
+  void slotAboutToQuit();
+  void slotRestoreItems();
+  void slotItemExpanded(QTreeWidgetItem* item);
   void slotContextMenu(const QPoint& point);
   void slotSaveProject();
   void slotSaveAsProject();
@@ -138,6 +145,7 @@ class CGisListWks : public QTreeWidget {
   void migrateDB1to2();
   void migrateDB2to3();
   void migrateDB3to4();
+  void migrateDB4to5();
   void setVisibilityOnMap(bool visible);
   QAction* addSortAction(QObject* parent, QActionGroup* actionGroup, const QString& icon, const QString& text,
                          IGisProject::sorting_folder_e mode);
@@ -175,6 +183,8 @@ class CGisListWks : public QTreeWidget {
   }
 
   QSqlDatabase db;
+  CGisListWksSaveThread* threadSave;
+  bool restoreItemsScheduled = false;
 
   QActionGroup* actionGroupSort;
   QAction* actionSave;
@@ -0,0 +1,218 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#include "gis/CGisListWksSaveThread.h"
+
+#include <QtSql>
+
+#include "gis/CGisListDB.h"
+#include "gis/db/macros.h"
+
+#define CONNECTION_NAME "WorkspaceSave"
+
+/// several projects can share a key, the occurrence is added to make it unique
+static QString getUniqueKey(const QString& key, QHash<QString, qint32>& cntKeys) {
+  const qint32 cnt = cntKeys[key]++;
+  return cnt == 0 ? key : key + "#" + QString::number(cnt);
+}
+
+CGisListWksSaveThread::CGisListWksSaveThread(QSqlDatabase& db, QObject* parent) : QThread(parent), dbParent(db) {}
+
+CGisListWksSaveThread::project_t CGisListWksSaveThread::getSnapshot(const IGisProject& project) {
+  project_t snapshot;
+  snapshot.type = project.getType();
+  snapshot.key = project.getKey();
+  snapshot.name = project.getName();
+  snapshot.changed = project.isChanged();
+  snapshot.visible = project.checkState(CGisListDB::eColumnCheckbox) == Qt::Checked;
+  project.getSnapshot(snapshot.snapshot, QDataStream::Qt_5_2, QDataStream::LittleEndian);
+  return snapshot;
+}
+
+QByteArray CGisListWksSaveThread::getFingerprint(const project_t& project) {
+  QByteArray buffer;
+  QDataStream stream(&buffer, QIODevice::WriteOnly);
+  stream << project.type << project.key << project.name << project.changed << project.visible;
+  stream << project.snapshot.header;
+  // deferred items are never changed before they are restored
+  stream << project.snapshot.itemsDeferred.size();
+
+  for (const IGisProject::item_snapshot_t& item : project.snapshot.items) {
+    const IGisItem::history_t& history = item.history;
+    stream << item.type << item.changed << item.lastDatabaseHash;
+    stream << history.histIdxInitial << history.histIdxCurrent;
+    for (const IGisItem::history_event_t& event : history.events) {
+      stream << event.hash;
+    }
+  }
+
+  return QCryptographicHash::hash(buffer, QCryptographicHash::Md5);
+}
+
+void CGisListWksSaveThread::setRows(const QList<row_t>& rows) {
+  wait();
+
+  QHash<QString, qint32> cntKeys;
+  this->rows.clear();
+  for (const row_t& row : rows) {
+    this->rows[getUniqueKey(row.key, cntKeys)] = row;
+  }
+}
+
+void CGisListWksSaveThread::save(const QList<project_t>& projects, const QString& focus) {
+  QMutexLocker lock(&mutex);
+  pendingProjects = projects;
+  pendingFocus = focus;
+  hasPending = true;
+
+  if (!busy) {
+    // the thread might still be about to return from run()
+    wait();
+    busy = true;
+    start();
+  }
+}
+
+void CGisListWksSaveThread::run() {
+  {
+    /*
+        As database connections can't be shared between threads the database connection
+        has to be cloned
+     */
+    QSqlDatabase db = QSqlDatabase::cloneDatabase(dbParent, CONNECTION_NAME);
+    if (db.open()) {
+      QSqlQuery query(db);
+      QUERY_RUN("PRAGMA synchronous=NORMAL", NO_CMD)
+      QUERY_RUN("PRAGMA temp_store=MEMORY", NO_CMD)
+    } else {
+      qWarning() << "Failed to open workspace database:" << db.lastError();
+    }
+
+    forever {
+      QList<project_t> projects;
+      QString focus;
+      {
+        QMutexLocker lock(&mutex);
+        if (!hasPending) {
+          busy = false;
+          break;
+        }
+        projects.swap(pendingProjects);
+        focus = pendingFocus;
+        hasPending = false;
+      }
+
+      if (db.isOpen()) {
+        write(db, projects, focus);
+      }
+    }
+
+    db.close();
+  }
+
+  QSqlDatabase::removeDatabase(CONNECTION_NAME);
+}
+
+bool CGisListWksSaveThread::write(QSqlDatabase& db, const QList<project_t>& projects, const QString& focus) {
+  qDebug() << "CGisListWksSaveThread::write()";
+
+  if (!db.transaction()) {
+    qWarning() << "Failed to start transaction on workspace database:" << db.lastError();
+    return false;
+  }
+
+  QSqlQuery query(db);
+
+  // The rows are updated on a copy. It is only applied if the transaction succeeds.
+  QHash<QString, row_t> rowsLeft = rows;
+  QHash<QString, row_t> rowsSaved;
+  QHash<QString, qint32> cntKeys;
+
+  const qint32 N = projects.count();
+  for (qint32 pos = 0; pos < N; pos++) {
+    const project_t& project = projects[pos];
+    const QString& key = getUniqueKey(project.key, cntKeys);
+    const QByteArray& fingerprint = getFingerprint(project);
+
+    row_t row = rowsLeft.take(key);
+    if (row.id != 0 && row.fingerprint == fingerprint) {
+      // the project is unchanged, but it might have been moved
+      if (row.pos != pos) {
+        query.prepare("UPDATE workspace SET pos=:pos WHERE id=:id");
+        query.bindValue(":pos", pos);
+        query.bindValue(":id", row.id);
+        QUERY_EXEC(db.rollback(); return false);
+      }
+    } else {
+      QByteArray data;
+      QDataStream stream(&data, QIODevice::WriteOnly);
+      stream.setVersion(QDataStream::Qt_5_2);
+      stream.setByteOrder(QDataStream::LittleEndian);
+      stream << project.snapshot;
+
+      if (row.id == 0) {
+        query.prepare(
+            "INSERT INTO workspace (type, keyqms, name, changed, visible, data, pos) VALUES (:type, :keyqms, :name, "
+            ":changed, :visible, :data, :pos)");
+      } else {
+        query.prepare(
+            "UPDATE workspace SET type=:type, keyqms=:keyqms, name=:name, changed=:changed, visible=:visible, "
+            "data=:data, pos=:pos WHERE id=:id");
+        query.bindValue(":id", row.id);
+      }
+      query.bindValue(":type", project.type);
+      query.bindValue(":keyqms", project.key);
+      query.bindValue(":name", project.name);
+      query.bindValue(":changed", project.changed);
+      query.bindValue(":visible", project.visible);
+      query.bindValue(":data", data);
+      query.bindValue(":pos", pos);
+      QUERY_EXEC(db.rollback(); return false);
+
+      if (row.id == 0) {
+        row.id = query.lastInsertId().toLongLong();
+      }
+    }
+
+    row.key = project.key;
+    row.pos = pos;
+    row.fingerprint = fingerprint;
+    rowsSaved[key] = row;
+  }
+
+  // All other rows belong to projects no longer in the workspace or to
+  // projects that failed to restore.
+  QStringList ids;
+  for (const row_t& row : qAsConst(rowsSaved)) {
+    ids << QString::number(row.id);
+  }
+  QUERY_RUN(QString("DELETE FROM workspace WHERE id NOT IN (%1)").arg(ids.join(",")), db.rollback(); return false)
+
+  query.prepare("UPDATE userfocus set focus=:focus");
+  query.bindValue(":focus", focus);
+  QUERY_EXEC(db.rollback(); return false);
+
+  if (!db.commit()) {
+    qWarning() << "Failed to commit workspace:" << db.lastError();
+    db.rollback();
+    return false;
+  }
+
+  rows = rowsSaved;
+  return true;
+}
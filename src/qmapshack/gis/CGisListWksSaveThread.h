@@ -0,0 +1,118 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#ifndef CGISLISTWKSSAVETHREAD_H
+#define CGISLISTWKSSAVETHREAD_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QThread>
+
+#include "gis/prj/IGisProject.h"
+
+/**
+   @brief Write the workspace to the workspace database in the background
+
+   The GUI thread passes snapshots of all projects (see IGisProject::getSnapshot()).
+   The thread serializes only the projects that changed since the last save and writes
+   them in a single transaction. Rows of projects that are still unchanged are kept.
+   Projects removed from the workspace are deleted.
+
+   If a save is requested while the thread is still busy the request is queued. Only
+   the latest request is kept.
+ */
+class CGisListWksSaveThread : public QThread {
+  Q_OBJECT
+ public:
+  /// a project as it is stored in the workspace table
+  struct project_t {
+    qint32 type = 0;
+    QString key;
+    QString name;
+    bool changed = false;
+    bool visible = true;
+    IGisProject::snapshot_t snapshot;
+  };
+
+  /// a row of the workspace table
+  struct row_t {
+    QString key;
+    qint64 id = 0;
+    qint32 pos = 0;
+    QByteArray fingerprint;
+  };
+
+  CGisListWksSaveThread(QSqlDatabase& db, QObject* parent);
+  virtual ~CGisListWksSaveThread() = default;
+
+  /**
+     @brief Take a snapshot of a project
+
+     The caller has to hold IGisItem::mutexItems.
+
+     @param project  the project in the workspace
+     @return The snapshot.
+   */
+  static project_t getSnapshot(const IGisProject& project);
+
+  /**
+     @brief Get a fingerprint of a project's snapshot
+
+     The fingerprint is calculated from the item history's hashes. Thus it is
+     much cheaper than serializing the project.
+   */
+  static QByteArray getFingerprint(const project_t& project);
+
+  /**
+     @brief Set the rows as they have been loaded from the workspace table
+
+     Rows not passed are rewritten or deleted by the next save.
+
+     @param rows  a list of rows in the order of the projects in the workspace
+   */
+  void setRows(const QList<row_t>& rows);
+
+  /**
+     @brief Queue the projects to be saved and start the thread if necessary
+
+     @param projects  the snapshots of all projects in the workspace
+     @param focus     the key of the project with user focus
+   */
+  void save(const QList<project_t>& projects, const QString& focus);
+
+ protected:
+  void run() override;
+
+ private:
+  bool write(QSqlDatabase& db, const QList<project_t>& projects, const QString& focus);
+
+  QMutex mutex;
+  bool busy = false;
+  bool hasPending = false;
+  QList<project_t> pendingProjects;
+  QString pendingFocus;
+
+  /// database connection from the main thread
+  QSqlDatabase& dbParent;
+
+  /// the rows as they are stored in the database, only accessed by run()
+  QHash<QString, row_t> rows;
+};
+
+#endif  // CGISLISTWKSSAVETHREAD_H
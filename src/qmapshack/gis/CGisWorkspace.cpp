@@ -46,6 +46,7 @@
 #include "gis/wpt/CGisItemWpt.h"
 #include "gis/wpt/CProjWpt.h"
 #include "helpers/CInputDialog.h"
+#include "helpers/COccupancyGrid.h"
 #include "helpers/CProgressDialog.h"
 #include "helpers/CSelectCopyAction.h"
 #include "helpers/CSelectProjectDialog.h"
@@ -106,7 +107,10 @@ CGisWorkspace::~CGisWorkspace() {
 void CGisWorkspace::slotLateInit() {
   // [Issue #265] Delay the loading of the workspace to make sure the complete IUnit system
   //              is up and running.
-  QTimer::singleShot(1000, treeWks, &CGisListWks::slotLoadWorkspace);
+  // The headless export (--export-view) renders the given files only.
+  if (qlOpts->exportView.isEmpty()) {
+    QTimer::singleShot(1000, treeWks, &CGisListWks::slotLoadWorkspace);
+  }
 }
 
 void CGisWorkspace::setOpacity(qreal val) { sliderOpacity->setValue(val * 100); }
@@ -420,34 +424,20 @@ void CGisWorkspace::mouseMove(const QPointF& pos) {
 }
 
 IGisItem* CGisWorkspace::getItemByKey(const IGisItem::key_t& key) {
-  IGisItem* item = nullptr;
+  IGisItem* item = IGisProject::getItemByKey(key, treeWks);
+  if (nullptr != item) {
+    return item;
+  }
+
+  // The item might be part of a project with items not restored yet.
   QMutexLocker lock(&IGisItem::mutexItems);
   for (int i = 0; i < treeWks->topLevelItemCount(); i++) {
-    QTreeWidgetItem* item1 = treeWks->topLevelItem(i);
-    IGisProject* project = dynamic_cast<IGisProject*>(item1);
-    if (project) {
-      if (project->getKey() != key.project) {
-        continue;
-      }
-
+    IGisProject* project = dynamic_cast<IGisProject*>(treeWks->topLevelItem(i));
+    if ((nullptr != project) && project->hasDeferredItems() && (project->getKey() == key.project)) {
       item = project->getItemByKey(key);
       if (nullptr != item) {
         break;
       }
-
-      continue;
-    }
-
-    IDevice* device = dynamic_cast<IDevice*>(item1);
-    if (device) {
-      if (device->getKey() != key.device) {
-        continue;
-      }
-
-      item = device->getItemByKey(key);
-      if (nullptr != item) {
-        break;
-      }
     }
   }
 
@@ -1099,7 +1089,11 @@ void CGisWorkspace::editPrxWpt(const QList<IGisItem::key_t>& keys) {
 
 void CGisWorkspace::draw(QPainter& p, const QPolygonF& viewport, CGisDraw* gis) {
   QFontMetricsF fm(CMainWindow::self().getMapFont());
-  QList<QRectF> blockedAreas;
+
+  // the viewport in screen coordinates to setup the grid of blocked areas
+  QPolygonF area = viewport;
+  gis->convertRad2Px(area);
+  COccupancyGrid blockedAreas(area.boundingRect());
 
   QMutexLocker lock(&IGisItem::mutexItems);
   // draw mandatory stuff first
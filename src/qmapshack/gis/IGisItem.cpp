@@ -120,7 +120,12 @@ IGisItem::IGisItem(IGisProject* parent, type_e typ, int idx) : QTreeWidgetItem(p
   }
 }
 
-IGisItem::~IGisItem() {}
+IGisItem::~IGisItem() {
+  IGisProject* project = getParentProject();
+  if (project != nullptr) {
+    project->updateItemKey(this, QString());
+  }
+}
 
 void IGisItem::init() {
   colorMap = {{"Black", tr("Black"), QColor(Qt::black), QString("://icons/8x8/bullet_black.png"),
@@ -215,6 +220,15 @@ void IGisItem::genKey() const {
       key.project = project->getKey();
     }
   }
+  updateKeyIndex();
+}
+
+void IGisItem::updateKeyIndex() const {
+  IGisProject* project = getParentProject();
+  if (project != nullptr) {
+    // the key is mutable and so is the item's entry in the index
+    project->updateItemKey(const_cast<IGisItem*>(this), key.item);
+  }
 }
 
 void IGisItem::loadFromDb(quint64 id, QSqlDatabase& db) {
@@ -230,24 +244,29 @@ void IGisItem::loadFromDb(quint64 id, QSqlDatabase& db) {
     in >> history;
     loadHistory(history.histIdxCurrent);
 
-    if (key.item.isEmpty()) {
-      QString keyFromDB = query.value(1).toString();
-      /*[Issue #72] Database/Workspace inconsistency in QMS 1.4.0
+    fixKeyFromDb(query.value(1).toString());
 
-         The root cause is a missing key in the serialized data. This is fixed by calling getKey() in setupHistory().
+    lastDatabaseHash = query.value(2).toString();
+  }
+}
 
-         As the database has a valid key the complete history data has to be fixed with that key.
-       */
-      const int N = history.events.size();
-      for (int i = 0; i < N; i++) {
-        loadHistory(i);
-        key.item = keyFromDB;
-        updateHistory();
-      }
-    }
+void IGisItem::fixKeyFromDb(const QString& keyFromDB) {
+  if (!key.item.isEmpty()) {
+    return;
+  }
+  /*[Issue #72] Database/Workspace inconsistency in QMS 1.4.0
 
-    lastDatabaseHash = query.value(2).toString();
+     The root cause is a missing key in the serialized data. This is fixed by calling getKey() in setupHistory().
+
+     As the database has a valid key the complete history data has to be fixed with that key.
+   */
+  const int N = history.events.size();
+  for (int i = 0; i < N; i++) {
+    loadHistory(i);
+    key.item = keyFromDB;
+    updateHistory();
   }
+  updateKeyIndex();
 }
 
 void IGisItem::updateFromDB(quint64 id, QSqlDatabase& db) {
@@ -411,6 +430,7 @@ void IGisItem::updateHistory() {
 
 void IGisItem::setupHistory() {
   getKey();
+  updateKeyIndex();
   history.histIdxInitial = NOIDX;
   history.histIdxCurrent = NOIDX;
 
@@ -469,6 +489,7 @@ void IGisItem::loadHistory(int idx) {
   stream.setByteOrder(QDataStream::LittleEndian);
   stream.setVersion(QDataStream::Qt_5_2);
   *this << stream;
+  updateKeyIndex();
 
   history.histIdxCurrent = idx;
 }
@@ -889,6 +910,42 @@ IGisItem* IGisItem::newGisItem(quint32 type, quint64 id, QSqlDatabase& db, IGisP
   return item;
 }
 
+IGisItem* IGisItem::newGisItem(quint32 type, const QByteArray& data, const QString& keyqms, const QString& hash,
+                               IGisProject* project) {
+  history_t history;
+  QDataStream in(data);
+  in.setByteOrder(QDataStream::LittleEndian);
+  in.setVersion(QDataStream::Qt_5_2);
+  in >> history;
+
+  IGisItem* item = nullptr;
+  switch (type) {
+    case IGisItem::eTypeWpt:
+      item = new CGisItemWpt(history, hash, project);
+      break;
+
+    case IGisItem::eTypeTrk:
+      item = new CGisItemTrk(history, hash, project);
+      break;
+
+    case IGisItem::eTypeRte:
+      item = new CGisItemRte(history, hash, project);
+      break;
+
+    case IGisItem::eTypeOvl:
+      item = new CGisItemOvlArea(history, hash, project);
+      break;
+
+    default:;
+  }
+
+  if (item != nullptr) {
+    item->fixKeyFromDb(keyqms);
+  }
+
+  return item;
+}
+
 qreal IGisItem::getRating() const { return rating; }
 
 void IGisItem::setRating(qreal rating) {
@@ -36,6 +36,7 @@
 #include "units/IUnit.h"
 
 class CGisDraw;
+class COccupancyGrid;
 class IScrOpt;
 class IMouse;
 class QSqlDatabase;
@@ -314,6 +315,16 @@ class IGisItem : public QTreeWidgetItem {
    */
   virtual bool isCloseTo(const QPointF& pos) = 0;
 
+  /**
+     @brief Get the screen area isCloseTo() can be true for
+
+     The area is derived from the screen coordinates of the last drawItem() call. It
+     is used by the project to index it's items for fast hit testing.
+
+     @return The area in screen pixel. An empty rectangle if the item is not drawn.
+   */
+  virtual QRectF getScreenArea() const = 0;
+
   virtual bool isWithin(const QRectF& area, selflags_t mode) = 0;
 
   /**
@@ -361,9 +372,9 @@ class IGisItem : public QTreeWidgetItem {
    */
   virtual bool setReadOnlyMode(bool readOnly);
 
-  virtual void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) = 0;
+  virtual void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) = 0;
   virtual void drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) {}
-  virtual void drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  virtual void drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                          CGisDraw* gis) = 0;
   virtual void drawHighlight(QPainter& p) = 0;
 
@@ -500,6 +511,21 @@ class IGisItem : public QTreeWidgetItem {
 
   static IGisItem* newGisItem(quint32 type, quint64 id, QSqlDatabase& db, IGisProject* project);
 
+  /**
+     @brief Create an item from a row of the database's items table
+
+     Use this to create many items from a single query instead of a query per item.
+
+     @param type      the item type as stored in the database
+     @param data      the serialized history as stored in the database
+     @param keyqms    the item key as stored in the database
+     @param hash      the hash as stored in the database
+     @param project   the project to add the item to, must not be nullptr
+     @return A new item or nullptr if the type is unknown.
+   */
+  static IGisItem* newGisItem(quint32 type, const QByteArray& data, const QString& keyqms, const QString& hash,
+                              IGisProject* project);
+
   /// a no key value that can be used to nullify references.
   const static QString noKey;
 
@@ -534,6 +560,8 @@ class IGisItem : public QTreeWidgetItem {
   void writeWpt(QDomElement& xml, const wpt_t& wpt, bool strictGpx11);
   /// generate a unique key from item's data
   virtual void genKey() const;
+  /// register the current item key with the parent project's key index
+  void updateKeyIndex() const;
   /// setup the history structure right after the creation of the item
   void setupHistory();
   /// update current history entry (e.g. to save the flags)
@@ -548,6 +576,8 @@ class IGisItem : public QTreeWidgetItem {
   virtual void changed(const QString& what, const QString& icon);
 
   void loadFromDb(quint64 id, QSqlDatabase& db);
+  /// restore a missing item key in all history entries with the key stored in the database
+  void fixKeyFromDb(const QString& keyFromDB);
   bool isVisible(const QRectF& rect, const QPolygonF& viewport, CGisDraw* gis);
   bool isVisible(const QPointF& point, const QPolygonF& viewport, CGisDraw* gis);
   bool isWithin(const QRectF& area, selflags_t flags, const QPolygonF& points);
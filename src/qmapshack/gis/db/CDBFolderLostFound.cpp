@@ -43,13 +43,13 @@ void CDBFolderLostFound::setupFromDB() {
 
   qDeleteAll(takeChildren());
 
+  query.setForwardOnly(true);
   QUERY_RUN(
-      "SELECT id FROM items AS t1 WHERE NOT EXISTS(SELECT * FROM folder2item WHERE child=t1.id) ORDER BY t1.type, "
-      "t1.name",
+      "SELECT id, type, keyqms, icon, name, date, comment FROM items AS t1 WHERE NOT EXISTS(SELECT * FROM folder2item "
+      "WHERE child=t1.id) ORDER BY t1.type, t1.name",
       return );
   while (query.next()) {
-    quint64 id = query.value(0).toULongLong();
-    new CDBItem(db, id, this);
+    new CDBItem(db, query, this);
     cnt++;
   }
 
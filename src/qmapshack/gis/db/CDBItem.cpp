@@ -27,42 +27,53 @@
 
 CDBItem::CDBItem(QSqlDatabase& db, quint64 id, IDBFolder* parent) : QTreeWidgetItem(parent), db(db), id(id) {
   QSqlQuery query(db);
-  query.prepare("SELECT type, keyqms, icon, name, date, comment FROM items WHERE id=:id");
+  query.prepare("SELECT id, type, keyqms, icon, name, date, comment FROM items WHERE id=:id");
   query.bindValue(":id", id);
   QUERY_EXEC(return );
   if (query.next()) {
-    QPixmap pixmap;
-    type = query.value(0).toInt();
-    key = query.value(1).toString();
-    pixmap.loadFromData(query.value(2).toByteArray(), "PNG");
-    setIcon(CGisListDB::eColumnCheckbox, pixmap);
-    setText(CGisListDB::eColumnName, query.value(3).toString());
-
-    date = query.value(4).toDateTime();
-
-    // limit comment to 300 characters
-    QString comment = query.value(5).toString();
-    if (comment.size() > 300) {
-      comment = comment.left(297) + "...";
-    }
-    setToolTip(CGisListDB::eColumnName, comment);
+    setup(query);
   }
 
   updateAge();
 }
 
+CDBItem::CDBItem(QSqlDatabase& db, const QSqlQuery& query, IDBFolder* parent)
+    : QTreeWidgetItem(parent), db(db), id(query.value(0).toULongLong()) {
+  setup(query);
+  updateAge();
+}
+
+void CDBItem::setup(const QSqlQuery& query) {
+  QPixmap pixmap;
+  type = query.value(1).toInt();
+  key = query.value(2).toString();
+  pixmap.loadFromData(query.value(3).toByteArray(), "PNG");
+  setIcon(CGisListDB::eColumnCheckbox, pixmap);
+  setText(CGisListDB::eColumnName, query.value(4).toString());
+
+  date = query.value(5).toDateTime();
+
+  // limit comment to 300 characters
+  QString comment = query.value(6).toString();
+  if (comment.size() > 300) {
+    comment = comment.left(297) + "...";
+  }
+  setToolTip(CGisListDB::eColumnName, comment);
+}
+
 QString CDBItem::getName() const { return text(CGisListDB::eColumnName); }
 
 void CDBItem::updateAge() {
+  // only items in the lost & found folder show their age
+  if ((parent() == nullptr) || (parent()->type() != IDBFolder::eTypeLostFound)) {
+    return;
+  }
+
   QSqlQuery query(db);
   query.prepare("SELECT trash FROM items WHERE id=:id");
   query.bindValue(":id", id);
   QUERY_EXEC(return );
-  if (!query.next()) {
-    return;
-  }
-
-  if ((parent() != nullptr) && (parent()->type() == IDBFolder::eTypeLostFound)) {
+  if (query.next()) {
     QString date = query.value(0).toString();
     QDateTime timestamp;
 
@@ -25,11 +25,20 @@
 
 class IDBFolder;
 class QSqlDatabase;
+class QSqlQuery;
 
 class CDBItem : public QTreeWidgetItem {
   Q_DECLARE_TR_FUNCTIONS(CDBItem)
  public:
   CDBItem(QSqlDatabase& db, quint64 id, IDBFolder* parent);
+  /**
+     @brief Setup the item from the current row of a query
+
+     This avoids a query per item when adding many items. The query has to
+     select the columns "id, type, keyqms, icon, name, date, comment" in that
+     order.
+   */
+  CDBItem(QSqlDatabase& db, const QSqlQuery& query, IDBFolder* parent);
   virtual ~CDBItem() = default;
 
   /**
@@ -65,6 +74,8 @@ class CDBItem : public QTreeWidgetItem {
   void updateAge();
 
  private:
+  void setup(const QSqlQuery& query);
+
   friend bool sortByTime(CDBItem* item1, CDBItem* item2);
   QSqlDatabase& db;
   quint64 id;
@@ -30,6 +30,11 @@
 #include "gis/db/macros.h"
 #include "gis/prj/CDetailsPrj.h"
 #include "helpers/CProgressDialog.h"
+
+// the maximum number of values in a single "IN (...)" clause
+#define N_VALUES_PER_QUERY 500
+#define MAX_CONFLICT_RETRIES 5
+
 CDBProject::CDBProject(CGisListWks* parent) : IGisProject(eTypeDb, "", parent), id(0) {
   setIcon(CGisListWks::eColumnIcon, QIcon("://icons/32x32/DBProject.png"));
 }
@@ -120,8 +125,9 @@ CDBProject::CDBProject(const QString& filename, IDBFolder* parentFolder, CGisLis
   key = prjIn->getKey();
   metadata = prjIn->getMetadata();
 
-  QList<QTreeWidgetItem*> items = prjIn->takeChildren();
+  QList<QTreeWidgetItem*> items = prjIn->takeItems();
   addChildren(items);
+  buildKeyIndex();
 
   // set change indication else the item will not be saved
   for (QTreeWidgetItem* item : qAsConst(items)) {
@@ -232,6 +238,12 @@ CDBProject::action_e CDBProject::checkForAction2(IGisItem* item, quint64& itemId
                                                  action_e& action2ForAll, QSqlQuery& query) {
   action_e action = eActionNone;
 
+  // The update failed and the current state is read to decide. Do this outside
+  // the transaction. Else a database with snapshot isolation (e.g. MySQL's
+  // REPEATABLE READ) will report the state at the beginning of the transaction
+  // and the dialog below would lock the database until the user decides.
+  pauseTransaction();
+
   query.prepare("SELECT hash, last_user, last_change FROM items WHERE id=:id");
   query.bindValue(":id", itemId);
   QUERY_EXEC(throw eReasonQueryFail);
@@ -243,6 +255,7 @@ CDBProject::action_e CDBProject::checkForAction2(IGisItem* item, quint64& itemId
 
     if (hash == hashItem) {
       // there seems to be no difference
+      resumeTransaction();
       return action;
     }
 
@@ -255,10 +268,12 @@ CDBProject::action_e CDBProject::checkForAction2(IGisItem* item, quint64& itemId
 
     CResolveDatabaseConflict dialog(msg, item, action2ForAll, CMainWindow::self().getBestWidgetForParent());
     action = dialog.getAction();
+    resumeTransaction();
   } else {
     // item has been removed. By throwing eReasonConflict
     // the save procedure is restarted for the item and
     // the item should be inserted into the database.
+    resumeTransaction();
     throw eReasonConflict;
   }
 
@@ -301,6 +316,9 @@ void CDBProject::updateItem(IGisItem*& item, quint64 idItem, action_e& action2Fo
     // the update has been successful.
     // set current hash as database hash.
     item->setLastDatabaseHash(idItem, db);
+    if (!IDB::updateSpatialIndex(query, idItem, *item)) {
+      throw eReasonQueryFail;
+    }
   } else {
     // there are two reasons why an update does not affect a row
     // 1) the hash is different because another user changed the item
@@ -343,6 +361,9 @@ void CDBProject::updateItem(IGisItem*& item, quint64 idItem, action_e& action2Fo
 
         if (query.numRowsAffected()) {
           item->setLastDatabaseHash(idItem, db);
+          if (!IDB::updateSpatialIndex(query, idItem, *item)) {
+            throw eReasonQueryFail;
+          }
         } else {
           // in the case someone updated the item between calling
           // checkForAction2() and this update our update fails.
@@ -391,12 +412,17 @@ quint64 CDBProject::insertItem(IGisItem* item, QSqlQuery& query) {
   QUERY_EXEC(throw eReasonQueryFail);
 
   if (query.numRowsAffected()) {
-    idItem = IDB::getLastInsertID(db, "items");
+    // The driver knows the id of the inserted row. Only ask the database if it doesn't.
+    const QVariant& lastInsertId = query.lastInsertId();
+    idItem = lastInsertId.isValid() ? lastInsertId.toULongLong() : IDB::getLastInsertID(db, "items");
     if (idItem == 0) {
       qDebug() << "childId equals 0. bad.";
       throw eReasonUnexpected;
     }
     item->setLastDatabaseHash(idItem, db);
+    if (!IDB::updateSpatialIndex(query, idItem, *item)) {
+      throw eReasonQueryFail;
+    }
   } else {
     throw eReasonConflict;
   }
@@ -404,27 +430,62 @@ quint64 CDBProject::insertItem(IGisItem* item, QSqlQuery& query) {
   return idItem;
 }
 
+bool CDBProject::lookupItems(const QStringList& keys, QHash<QString, item_in_db_t>& items) {
+  QSqlQuery query(db);
+  query.setForwardOnly(true);
+
+  const int N = keys.size();
+  for (int i = 0; i < N; i += N_VALUES_PER_QUERY) {
+    const int n = qMin(N - i, N_VALUES_PER_QUERY);
+    QString placeholders = QString("?,").repeated(n);
+    placeholders.chop(1);
+
+    query.prepare(QString("SELECT id, type, keyqms FROM items WHERE keyqms IN (%1)").arg(placeholders));
+    for (int j = 0; j < n; j++) {
+      query.addBindValue(keys[i + j]);
+    }
+    QUERY_EXEC(return false);
+
+    while (query.next()) {
+      const QString& key = query.value(2).toString();
+      // like a single query by key, the first item found wins
+      if (!items.contains(key)) {
+        item_in_db_t& item = items[key];
+        item.id = query.value(0).toULongLong();
+        item.type = query.value(1).toUInt();
+      }
+    }
+  }
+  return true;
+}
+
+bool CDBProject::lookupChildren(QSet<quint64>& children) {
+  QSqlQuery query(db);
+  query.setForwardOnly(true);
+  query.prepare("SELECT child FROM folder2item WHERE parent=:parent");
+  query.bindValue(":parent", id);
+  QUERY_EXEC(return false);
+
+  while (query.next()) {
+    children << query.value(0).toULongLong();
+  }
+  return true;
+}
+
 CDBProject::action_e CDBProject::checkForAction1(IGisItem* item, quint64& itemId,
-                                                 CSelectSaveAction::result_e& action1ForAll, QSqlQuery& query) {
+                                                 CSelectSaveAction::result_e& action1ForAll,
+                                                 const QHash<QString, item_in_db_t>& itemsInDb,
+                                                 const QSet<quint64>& children) {
   int action = eActionNone;
 
   // test if item exists in database
-  quint32 itemType = 0;
-  query.prepare("SELECT id, type FROM items WHERE keyqms=:keyqms");
-  query.bindValue(":keyqms", item->getKey().item);
-  QUERY_EXEC(throw eReasonQueryFail);
-
-  if (query.next()) {
-    itemId = query.value(0).toULongLong();
-    itemType = query.value(1).toUInt();
+  auto itemInDb = itemsInDb.constFind(item->getKey().item);
+  if (itemInDb != itemsInDb.constEnd()) {
+    itemId = itemInDb->id;
+    const quint32 itemType = itemInDb->type;
 
     // check if relation already exists.
-    query.prepare("SELECT id FROM folder2item WHERE parent=:parent AND child=:child");
-    query.bindValue(":parent", id);
-    query.bindValue(":child", itemId);
-    QUERY_EXEC(throw eReasonQueryFail);
-
-    if (!query.next()) {
+    if (!children.contains(itemId)) {
       // item is already in database but folder relation does not exit
       CSelectSaveAction::result_e result = action1ForAll;
 
@@ -438,7 +499,9 @@ CDBProject::action_e CDBProject::checkForAction1(IGisItem* item, quint64& itemId
         }
 
         CSelectSaveAction dlg(item, item1, CMainWindow::self().getBestWidgetForParent());
+        pauseTransaction();
         dlg.exec();
+        resumeTransaction();
 
         result = dlg.getResult();
         if (dlg.allOthersToo()) {
@@ -481,6 +544,28 @@ CDBProject::action_e CDBProject::checkForAction1(IGisItem* item, quint64& itemId
   return (action_e)action;
 }
 
+void CDBProject::pauseTransaction() {
+  if (!transaction) {
+    return;
+  }
+
+  transaction = false;
+  transactionPaused = true;
+  if (!db.commit()) {
+    qWarning() << "Failed to commit transaction:" << db.lastError();
+    db.rollback();
+  }
+}
+
+void CDBProject::resumeTransaction() {
+  if (!transactionPaused) {
+    return;
+  }
+
+  transactionPaused = false;
+  transaction = db.transaction();
+}
+
 bool CDBProject::save() { return save(CSelectSaveAction::eResultNone, eActionNone); }
 
 bool CDBProject::save(CSelectSaveAction::result_e action1ForAll, action_e action2ForAll) {
@@ -500,9 +585,38 @@ bool CDBProject::save(CSelectSaveAction::result_e action1ForAll, action_e action
   }
 
   int N = childCount();
+
+  /*
+      Look up all changed items and the project's links with a few queries
+      upfront instead of two queries per item. Both are kept up to date
+      while saving.
+   */
+  QStringList keysChanged;
+  for (int i = 0; i < N; i++) {
+    IGisItem* item = dynamic_cast<IGisItem*>(child(i));
+    if (item && item->isChanged()) {
+      keysChanged << item->getKey().item;
+    }
+  }
+
+  QHash<QString, item_in_db_t> itemsInDb;
+  QSet<quint64> children;
+  if (!lookupItems(keysChanged, itemsInDb) || !lookupChildren(children)) {
+    return false;
+  }
+
+  // Run all statements in a single transaction. Without, each statement is a
+  // transaction of it's own, forcing the database to sync once per statement.
+  // The transaction is paused for each dialog, so the user's decision never
+  // blocks other users of the database.
+  transaction = db.transaction();
+  transactionPaused = false;
+  int conflicts = 0;
+
   PROGRESS_SETUP(tr("Save ..."), 0, N, CMainWindow::getBestWidgetForParent());
 
   for (int i = 0; (i < N) && !stop; i++) {
+    QString keyItem;
     try {
       PROGRESS(i, throw eReasonCancel);
 
@@ -516,9 +630,10 @@ bool CDBProject::save(CSelectSaveAction::result_e action1ForAll, action_e action
         continue;
       }
 
+      keyItem = item->getKey().item;
       quint64 idItem = 0;
 
-      int action = checkForAction1(item, idItem, action1ForAll, query);
+      int action = checkForAction1(item, idItem, action1ForAll, itemsInDb, children);
 
       if (action & eActionInsert) {
         idItem = insertItem(item, query);
@@ -545,13 +660,23 @@ bool CDBProject::save(CSelectSaveAction::result_e action1ForAll, action_e action
         query.bindValue(":parent", id);
         query.bindValue(":child", idItem);
         QUERY_EXEC(throw eReasonQueryFail);
+        children << idItem;
       }
+
+      if (action & (eActionInsert | eActionClone)) {
+        item_in_db_t& itemInDb = itemsInDb[item->getKey().item];
+        itemInDb.id = idItem;
+        itemInDb.type = item->type();
+      }
+
       item->updateDecoration(IGisItem::eMarkNone,
                              IGisItem::eMarkChanged | IGisItem::eMarkNotPart | IGisItem::eMarkNotInDB);
+      conflicts = 0;
     } catch (reasons_e reason) {
       CProgressDialog::setAllVisible(false);
       switch (reason) {
         case eReasonQueryFail:
+          pauseTransaction();
           QMessageBox::critical(&progress, tr("Error"),
                                 tr("There was an unexpected database error:\n\n%1").arg(query.lastError().text()),
                                 QMessageBox::Abort);
@@ -563,7 +688,30 @@ bool CDBProject::save(CSelectSaveAction::result_e action1ForAll, action_e action
           break;
 
         case eReasonConflict:
-          i--;
+          if (++conflicts > MAX_CONFLICT_RETRIES) {
+            pauseTransaction();
+            QMessageBox::critical(&progress, tr("Error"),
+                                  tr("The item %1 keeps being changed in the database while saving. "
+                                     "Saving has been stopped.")
+                                      .arg(keyItem),
+                                  QMessageBox::Abort);
+            stop = true;
+            success = false;
+            break;
+          }
+
+          // the database changed in the meantime, get the current state of the item
+          // with a new transaction. The current one might still see the old state.
+          pauseTransaction();
+          resumeTransaction();
+          itemsInDb.remove(keyItem);
+          children.clear();
+          if (lookupItems({keyItem}, itemsInDb) && lookupChildren(children)) {
+            i--;
+          } else {
+            stop = true;
+            success = false;
+          }
           break;
       }
 
@@ -585,7 +733,23 @@ bool CDBProject::save(CSelectSaveAction::result_e action1ForAll, action_e action
   query.bindValue(":data", data);
   query.bindValue(":sortmode", getSortingFolder());
   query.bindValue(":id", getId());
-  QUERY_EXEC(return false);
+  bool successFolder = true;
+  QUERY_EXEC(successFolder = false);
+
+  // Items already saved are kept, even if the save has been stopped. Just
+  // like it would be without a transaction.
+  transactionPaused = false;
+  if (transaction && !db.commit()) {
+    transaction = false;
+    qWarning() << "Failed to commit transaction:" << db.lastError();
+    db.rollback();
+    return false;
+  }
+  transaction = false;
+
+  if (!successFolder) {
+    return false;
+  }
 
   postStatus(true);
   // update change flag
@@ -599,34 +763,77 @@ void CDBProject::showItems(CEvtD2WShowItems* evt, action_e action2ForAll) {
     restoreDlgDetails = !dlgDetails.isNull();
     delete dlgDetails;
 
-    qDeleteAll(takeChildren());
+    qDeleteAll(takeItems());
   }
 
-  for (const evt_item_t& item : qAsConst(evt->items)) {
-    IGisItem* gisItem = IGisItem::newGisItem(item.type, item.id, db, this);
-
-    /* [Issue #72] Database/Workspace inconsistency in QMS 1.4.0
-
-       When an item with no key is loaded it is "healed". The healing
-       will mark it as changed. To avoid this save all items that are
-       marked as changed right after loading from the database.
-
-     */
-    if (gisItem && gisItem->isChanged()) {
-      bool success = true;
-      try {
-        QSqlQuery query(db);
-        updateItem(gisItem, item.id, action2ForAll, query);
-      } catch (int) {
-        success = false;
+  /*
+      Load the items with one query per N_VALUES_PER_QUERY items instead of a
+      query per item. The ids are numbers and can be part of the statement.
+   */
+  const int nChildren = childCount();
+  QHash<quint64, QTreeWidgetItem*> itemsById;
+
+  blockUpdateItems(true);
+
+  QSqlQuery query(db);
+  query.setForwardOnly(true);
+
+  const int N = evt->items.size();
+  for (int i = 0; i < N; i += N_VALUES_PER_QUERY) {
+    QStringList ids;
+    const int n = qMin(N, i + N_VALUES_PER_QUERY);
+    for (int j = i; j < n; j++) {
+      ids << QString::number(evt->items[j].id);
+    }
+
+    QUERY_RUN(QString("SELECT id, type, data, keyqms, hash FROM items WHERE id IN (%1)").arg(ids.join(",")), break);
+
+    while (query.next()) {
+      const quint64 idItem = query.value(0).toULongLong();
+      IGisItem* gisItem = IGisItem::newGisItem(query.value(1).toUInt(), query.value(2).toByteArray(),
+                                               query.value(3).toString(), query.value(4).toString(), this);
+
+      /* [Issue #72] Database/Workspace inconsistency in QMS 1.4.0
+
+         When an item with no key is loaded it is "healed". The healing
+         will mark it as changed. To avoid this save all items that are
+         marked as changed right after loading from the database.
+
+       */
+      if (gisItem && gisItem->isChanged()) {
+        bool success = true;
+        try {
+          QSqlQuery queryUpdate(db);
+          updateItem(gisItem, idItem, action2ForAll, queryUpdate);
+        } catch (int) {
+          success = false;
+        }
+
+        if (success) {
+          gisItem->updateDecoration(IGisItem::eMarkNone, IGisItem::eMarkChanged);
+        }
       }
 
-      if (success) {
-        gisItem->updateDecoration(IGisItem::eMarkNone, IGisItem::eMarkChanged);
+      if (gisItem) {
+        itemsById[idItem] = gisItem;
       }
     }
   }
 
+  // The query returns the items in no particular order. Restore the order
+  // of the request.
+  QList<QTreeWidgetItem*> items = takeChildren();
+  QList<QTreeWidgetItem*> itemsOrdered = items.mid(0, nChildren);
+  for (const evt_item_t& item : qAsConst(evt->items)) {
+    QTreeWidgetItem* gisItem = itemsById.take(item.id);
+    if (gisItem != nullptr) {
+      itemsOrdered << gisItem;
+    }
+  }
+  addChildren(itemsOrdered);
+
+  blockUpdateItems(false);
+
   sortItems();
   postStatus(false);
   setToolTip(CGisListWks::eColumnName, getInfo());
@@ -713,31 +920,34 @@ void CDBProject::update() {
 
     CGisWorkspace::self().postEventForWks(evt);
   } else {
-    // Iterate over all children and update
+    // Look up all children with a few queries and update them
     const int N = childCount();
+    QStringList keys;
+    for (int i = 0; i < N; i++) {
+      IGisItem* item = dynamic_cast<IGisItem*>(child(i));
+      if (item != nullptr) {
+        keys << item->getKey().item;
+      }
+    }
+
+    QHash<QString, item_in_db_t> itemsInDb;
+    QSet<quint64> children;
+    if (!lookupItems(keys, itemsInDb) || !lookupChildren(children)) {
+      return;
+    }
+
     for (int i = 0; i < N; i++) {
       IGisItem* item = dynamic_cast<IGisItem*>(child(i));
       if (item == nullptr) {
         continue;
       }
 
-      const IGisItem::key_t& key = item->getKey();
-      // update item from database
-      query.prepare("SELECT id FROM items WHERE keyqms=:keyqms");
-      query.bindValue(":keyqms", key.item);
-      QUERY_EXEC(return );
-
-      if (query.next()) {
+      auto itemInDb = itemsInDb.constFind(item->getKey().item);
+      if (itemInDb != itemsInDb.constEnd()) {
         // item is in the database
-        quint64 idItem = query.value(0).toULongLong();
-
-        QSqlQuery query2(db);
-        query2.prepare("SELECT id FROM folder2item WHERE parent=:parent AND child=:child");
-        query2.bindValue(":parent", getId());
-        query2.bindValue(":child", idItem);
-        query2.exec();
+        const quint64 idItem = itemInDb->id;
 
-        if (query2.next()) {
+        if (children.contains(idItem)) {
           // item is connected to this project
           item->updateFromDB(idItem, db);
           item->updateDecoration(IGisItem::eMarkNone, IGisItem::eMarkChanged);
@@ -106,6 +106,9 @@ class CDBProject : public IGisProject {
 
   void update();
 
+  /// sort the items without the GUI related updates of blockUpdateItems(false), safe in a worker thread
+  void sortItemsOnly() { sortItems(); }
+
  protected:
   /**
      @brief Setup the items text with the name and suffix
@@ -122,8 +125,31 @@ class CDBProject : public IGisProject {
    */
   void updateItem(IGisItem*& item, quint64 idItem, action_e& action2ForAll, QSqlQuery& query);
 
+  /// id and type of an item in the database
+  struct item_in_db_t {
+    quint64 id = 0;
+    quint32 type = 0;
+  };
+
+  /**
+     @brief Find items by their key with as few queries as possible
+
+     @param keys      the item keys to look for
+     @param items     the found items are added to this hash, keyed by the item key
+     @return Return false on a database error.
+   */
+  bool lookupItems(const QStringList& keys, QHash<QString, item_in_db_t>& items);
+
+  /**
+     @brief Get the ids of all items linked to this project in the database
+
+     @param children  the ids are added to this set
+     @return Return false on a database error.
+   */
+  bool lookupChildren(QSet<quint64>& children);
+
   action_e checkForAction1(IGisItem* item, quint64& itemId, CSelectSaveAction::result_e& action1ForAll,
-                           QSqlQuery& query);
+                           const QHash<QString, item_in_db_t>& itemsInDb, const QSet<quint64>& children);
   action_e checkForAction2(IGisItem* item, quint64& itemId, QString& hashItem, action_e& action2ForAll,
                            QSqlQuery& query);
 
@@ -134,12 +160,33 @@ class CDBProject : public IGisProject {
    */
   quint64 insertItem(IGisItem* item, QSqlQuery& query);
 
+  /**
+     @brief Commit the transaction of save() before a dialog is shown
+
+     The database must not stay locked while the user decides. Items
+     saved so far are kept, just like after a stopped save().
+   */
+  void pauseTransaction();
+
+  /**
+     @brief Start a new transaction after pauseTransaction()
+
+     The new transaction reads the current state of the database, including
+     the changes of other users made while the dialog was open.
+   */
+  void resumeTransaction();
+
   QSqlDatabase db;
   quint64 id = 0;
 
   enum reasons_e { eReasonCancel = 0, eReasonQueryFail = -1, eReasonUnexpected = -2, eReasonConflict = -3 };
 
   Qt::CheckState checkState = Qt::Unchecked;
+
+  /// true while save() runs its statements in an open transaction
+  bool transaction = false;
+  /// true while the transaction of save() is paused for a dialog
+  bool transactionPaused = false;
 };
 
 #endif  // CDBPROJECT_H
@@ -26,8 +26,21 @@
 #include "gis/db/macros.h"
 #include "gis/gpx/CGpxProject.h"
 
+// the manifest file in the export path
+#define MANIFEST ".qmsexport"
+// the number of projects read from the database in advance per worker thread
+#define JOBS_PER_WORKER 2
+
 CExportDatabaseThread::CExportDatabaseThread(quint64 id, QSqlDatabase& db, QObject* parent)
-    : QThread(parent), parentFolderId(id), dbParent(db) {}
+    : QThread(parent), parentFolderId(id), dbParent(db) {
+  threadPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+  jobSlots.release(JOBS_PER_WORKER * threadPool.maxThreadCount());
+}
+
+CExportDatabaseThread::~CExportDatabaseThread() {
+  slotAbort();
+  wait();
+}
 
 void CExportDatabaseThread::start(const QString& path, bool saveAsGpx11) {
   if (isRunning()) {
@@ -60,6 +73,9 @@ void CExportDatabaseThread::run() {
     keepGoing = true;
   }
 
+  cntFailed = 0;
+  filenames.clear();
+
   try {
     /*
         As database connections can't be shared between threads the database connection
@@ -78,9 +94,26 @@ void CExportDatabaseThread::run() {
       }
     }
 
-    dumpFolder(parentFolderId, "", exportPath, db);
+    loadManifest();
 
-    emit sigOut(tr("Done!"));
+    try {
+      dumpFolder(parentFolderId, "", exportPath, db);
+    } catch (const QString& msg) {
+      // let the workers finish what they have started before reporting
+      threadPool.waitForDone();
+      saveManifest();
+      db.close();
+      throw msg;
+    }
+
+    threadPool.waitForDone();
+    saveManifest();
+
+    if (cntFailed > 0) {
+      emit sigErr(tr("Failed to export %1 project(s). Restart the export to retry.").arg(int(cntFailed)));
+    } else {
+      emit sigOut(tr("Done!"));
+    }
     db.close();
   } catch (const QString& msg) {
     emit sigErr(msg);
@@ -97,7 +130,7 @@ void CExportDatabaseThread::dumpFolder(quint64 id, const QString& parentName, co
   QDir dir(path);
 
   QSqlQuery query(db);
-  query.prepare("SELECT type, name FROM folders WHERE id=:id");
+  query.prepare("SELECT type, name, data FROM folders WHERE id=:id");
   query.bindValue(":id", id);
   QUERY_EXEC(throw tr("Database Error: %1").arg(query.lastError().text()));
   query.next();
@@ -119,42 +152,199 @@ void CExportDatabaseThread::dumpFolder(quint64 id, const QString& parentName, co
     dir.cd(simplifiedName);
   } else {
     // if it is a project or other folder dump it to a GPX file
-    const QString connectionName = db.connectionName();
-    CDBProject prj(connectionName, id, 0);
-
-    CEvtD2WShowItems evt(id, connectionName);
-    query.prepare("SELECT id, type FROM items WHERE id IN (SELECT child FROM folder2item WHERE parent=:parent)");
-    query.bindValue(":parent", id);
-    QUERY_EXEC(throw tr("Database Error: %1").arg(query.lastError().text()));
-    while (query.next()) {
-      quint64 itemId = query.value(0).toULongLong();
-      quint32 itemType = query.value(1).toUInt();
-      evt.items << evt_item_t(itemId, itemType);
-    }
-    prj.showItems(&evt);
+    dumpProject(id, type, name, query.value(2).toByteArray(), parentName, dir, db);
+  }
+
+  // query all child folders to this folder
+  query.prepare(
+      "SELECT id, name FROM folders WHERE id IN (SELECT child FROM folder2folder WHERE parent=:parent) ORDER BY id");
+  query.bindValue(":parent", id);
+  QUERY_EXEC(throw tr("Database Error: %1").arg(query.lastError().text()));
+  while (query.next()) {
+    quint64 childId = query.value(0).toULongLong();
+    dumpFolder(childId, simplifiedName, dir.absolutePath(), db);
+  }
+}
+
+void CExportDatabaseThread::dumpProject(quint64 id, quint32 type, const QString& name, const QByteArray& data,
+                                        const QString& parentName, const QDir& dir, QSqlDatabase& db) {
+  const QByteArray& hash = getHash(id, data, db);
+
+  // The project is created without items. They are added by the worker thread.
+  CDBProject* prj = new CDBProject(nullptr);
+  if (data.isEmpty()) {
+    prj->setName(name);
+  } else {
+    QDataStream in(data);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setVersion(QDataStream::Qt_5_2);
+    *prj << in;
+  }
 
-    QString simplifiedProjName = simplifyString(prj.getName());
+  // use simplified project name as filename. If the folder is of type "other" prepend it with the parent folder's
+  // name.
+  const QString& simplifiedProjName = simplifyString(prj->getName());
+  QString filename = dir.absoluteFilePath((!parentName.isEmpty() && (type == IDBFolder::eTypeOther))
+                                              ? parentName + "_" + simplifiedProjName
+                                              : simplifiedProjName);
+  // two projects with the same name must not be written to the same file
+  if (filenames.contains(filename)) {
+    filename += QString("_%1").arg(id);
+  }
+  filenames << filename;
+  filename += ".gpx";
 
-    // use simplified project name as filename. If the folder is of type "other" prepend it with the parent folder's
-    // name.
-    QString filename = dir.absoluteFilePath((!parentName.isEmpty() && (type == IDBFolder::eTypeOther))
-                                                ? parentName + "_" + simplifiedProjName
-                                                : simplifiedProjName) +
-                       ".gpx";
-    emit sigOut(tr("Save project as %1").arg(filename));
+  job_t job;
+  job.filename = filename;
+  job.project = prj;
+  job.hash = hash;
 
-    if (!CGpxProject::saveAs(filename, prj, asGpx11)) {
-      throw tr("Failed!");
+  if (QFile::exists(filename)) {
+    mutex.lock();
+    const bool unchanged = manifest.value(QDir(exportPath).relativeFilePath(filename)) == job.hash;
+    mutex.unlock();
+    if (unchanged) {
+      emit sigOut(tr("Skip unchanged %1").arg(filename));
+      delete prj;
+      return;
+    }
+    // CGpxProject::saveAs() would ask the user before overwriting a foreign file. That is not possible
+    // from a worker thread. Leave the file untouched instead.
+    if (!CGpxProject::isCreatedByQMS(filename)) {
+      emit sigErr(tr("Skip %1. The file exists and it has not been created by QMapShack.").arg(filename));
+      cntFailed.ref();
+      delete prj;
+      return;
     }
   }
 
-  // query all child folders to this folder
-  query.prepare("SELECT child FROM folder2folder WHERE parent=:parent");
-  query.prepare("SELECT id, name FROM folders WHERE id IN (SELECT child FROM folder2folder WHERE parent=:parent)");
+  // read the raw item data, the items are created by the worker
+  QSqlQuery query(db);
+  query.setForwardOnly(true);
+  query.prepare(
+      "SELECT t2.type, t2.data, t2.keyqms, t2.hash FROM folder2item AS t1, items AS t2 WHERE t1.parent=:parent AND "
+      "t2.id=t1.child ORDER BY t2.id");
+  query.bindValue(":parent", id);
+  QUERY_EXEC(delete prj; throw tr("Database Error: %1").arg(query.lastError().text()));
+  while (query.next()) {
+    item_t item;
+    item.type = query.value(0).toUInt();
+    item.data = query.value(1).toByteArray();
+    item.keyqms = query.value(2).toString();
+    item.hash = query.value(3).toString();
+    job.items << item;
+  }
+
+  // wait for a free slot to limit the memory used by pending projects
+  jobSlots.acquire();
+  threadPool.start([this, job]() {
+    writeProject(job);
+    jobSlots.release();
+  });
+}
+
+QByteArray CExportDatabaseThread::getHash(quint64 id, const QByteArray& data, QSqlDatabase& db) {
+  QCryptographicHash md5(QCryptographicHash::Md5);
+  md5.addData(data);
+  md5.addData(asGpx11 ? "gpx11" : "gpx");
+
+  // the items' hashes change with every change of an item
+  QSqlQuery query(db);
+  query.setForwardOnly(true);
+  query.prepare(
+      "SELECT t2.id, t2.hash FROM folder2item AS t1, items AS t2 WHERE t1.parent=:parent AND t2.id=t1.child ORDER BY "
+      "t2.id");
   query.bindValue(":parent", id);
   QUERY_EXEC(throw tr("Database Error: %1").arg(query.lastError().text()));
   while (query.next()) {
-    quint64 childId = query.value(0).toULongLong();
-    dumpFolder(childId, simplifiedName, dir.absolutePath(), db);
+    md5.addData(query.value(0).toByteArray());
+    md5.addData(query.value(1).toByteArray());
+  }
+
+  return md5.result().toHex();
+}
+
+void CExportDatabaseThread::writeProject(const job_t& job) {
+  // the worker owns the project
+  QScopedPointer<CDBProject> prj(job.project);
+  if (!getKeepGoing()) {
+    return;
+  }
+
+  // Keep the project blocked. Unblocking would run the correlation of tracks and waypoints
+  // with a progress dialog. That must not happen in a worker thread and is not needed to
+  // write the file.
+  prj->blockUpdateItems(true);
+  for (const item_t& item : job.items) {
+    IGisItem::newGisItem(item.type, item.data, item.keyqms, item.hash, prj.data());
+  }
+  prj->sortItemsOnly();
+
+  emit sigOut(tr("Save project as %1").arg(job.filename));
+  bool success = false;
+  try {
+    success = CGpxProject::saveAs(job.filename, *prj, asGpx11);
+  } catch (const QString& msg) {
+    // saveAs() forwards errors as exception if not called from the main thread
+    emit sigErr(msg);
+  }
+
+  if (success) {
+    addToManifest(QDir(exportPath).relativeFilePath(job.filename), job.hash);
+  } else {
+    emit sigErr(tr("Failed to save %1").arg(job.filename));
+    cntFailed.ref();
+  }
+}
+
+void CExportDatabaseThread::loadManifest() {
+  QMutexLocker lock(&mutex);
+  manifest.clear();
+
+  // The manifest is a list of "<hash> <filename>" lines. Later lines overwrite
+  // former ones, as new entries are appended while exporting.
+  QFile file(QDir(exportPath).absoluteFilePath(MANIFEST));
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return;
+  }
+
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+  while (!in.atEnd()) {
+    const QString& line = in.readLine();
+    const int idx = line.indexOf(' ');
+    if (idx > 0) {
+      manifest[line.mid(idx + 1)] = line.left(idx).toLatin1();
+    }
+  }
+}
+
+void CExportDatabaseThread::saveManifest() {
+  QMutexLocker lock(&mutex);
+
+  // rewrite the manifest to drop outdated entries
+  QFile file(QDir(exportPath).absoluteFilePath(MANIFEST));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    emit sigErr(tr("Failed to write %1").arg(file.fileName()));
+    return;
+  }
+
+  QTextStream out(&file);
+  out.setCodec("UTF-8");
+  for (auto it = manifest.constBegin(); it != manifest.constEnd(); ++it) {
+    out << it.value() << " " << it.key() << "\n";
+  }
+}
+
+void CExportDatabaseThread::addToManifest(const QString& filename, const QByteArray& hash) {
+  QMutexLocker lock(&mutex);
+  manifest[filename] = hash;
+
+  // append right away, so the entry survives a crash or a killed application
+  QFile file(QDir(exportPath).absoluteFilePath(MANIFEST));
+  if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << hash << " " << filename << "\n";
   }
 }
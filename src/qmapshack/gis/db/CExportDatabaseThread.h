@@ -19,15 +19,34 @@
 #ifndef CEXPORTDATABASETHREAD_H
 #define CEXPORTDATABASETHREAD_H
 
+#include <QAtomicInt>
+#include <QDir>
+#include <QMap>
 #include <QMutex>
+#include <QSemaphore>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QThread>
+#include <QThreadPool>
 
+class CDBProject;
+
+/**
+   @brief Export a database folder and all it's sub-folders as GPX files
+
+   The thread itself walks the folder tree and reads the raw item data of each
+   project from the database. Creating the items and writing the GPX files is done
+   by a pool of worker threads.
+
+   A manifest in the export path stores a hash of the database content for each
+   exported file. If the content did not change the file is skipped. Thus an
+   interrupted export resumes where it stopped.
+ */
 class CExportDatabaseThread : public QThread {
   Q_OBJECT
  public:
   CExportDatabaseThread(quint64 id, QSqlDatabase& db, QObject* parent);
-  virtual ~CExportDatabaseThread() = default;
+  virtual ~CExportDatabaseThread();
 
   void start(const QString& path, bool saveAsGpx11);
 
@@ -44,7 +63,35 @@ class CExportDatabaseThread : public QThread {
   void dumpFolder(quint64 id, const QString& parentName, const QString& path, QSqlDatabase& db);
 
  private:
+  /// an item as stored in the database
+  struct item_t {
+    quint32 type;
+    QByteArray data;
+    QString keyqms;
+    QString hash;
+  };
+
+  /// all data needed by a worker thread to write a project file
+  struct job_t {
+    QString filename;
+    QByteArray hash;
+    /// the project without items, owned by the worker
+    CDBProject* project;
+    QList<item_t> items;
+  };
+
   QString simplifyString(const QString& str) const;
+  /// read a project's items and pass them to a worker, if the file is not up to date
+  void dumpProject(quint64 id, quint32 type, const QString& name, const QByteArray& data, const QString& parentName,
+                   const QDir& dir, QSqlDatabase& db);
+  /// the hash of a project's data in the database, without reading the item data
+  QByteArray getHash(quint64 id, const QByteArray& data, QSqlDatabase& db);
+  /// write a project file, called by the worker threads
+  void writeProject(const job_t& job);
+
+  void loadManifest();
+  void saveManifest();
+  void addToManifest(const QString& filename, const QByteArray& hash);
 
   mutable QMutex mutex;
   bool keepGoing = false;
@@ -54,6 +101,18 @@ class CExportDatabaseThread : public QThread {
   QSqlDatabase& dbParent;
   QString exportPath;
   bool asGpx11 = false;
+
+  /// the workers creating the items and writing the files
+  QThreadPool threadPool;
+  /// limits the number of projects read from the database but not written yet
+  QSemaphore jobSlots;
+  QAtomicInt cntFailed;
+
+  /// all files written by this export, to avoid two workers writing the same file
+  QSet<QString> filenames;
+
+  /// the hash of the exported data by filename, relative to the export path. Protected by mutex.
+  QMap<QString, QByteArray> manifest;
 };
 
 #endif  // CEXPORTDATABASETHREAD_H
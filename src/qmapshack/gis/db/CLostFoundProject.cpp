@@ -40,20 +40,21 @@ CLostFoundProject::CLostFoundProject(const QString& dbName, CGisListWks* parent)
 CLostFoundProject::~CLostFoundProject() {}
 
 void CLostFoundProject::updateFromDb() {
-  qDeleteAll(takeChildren());
+  qDeleteAll(takeItems());
 
   QSqlQuery query(db);
+  query.setForwardOnly(true);
   QUERY_RUN(
-      "SELECT id, type FROM items AS t1 WHERE NOT EXISTS(SELECT * FROM folder2item WHERE child=t1.id) ORDER BY "
-      "t1.type, t1.name",
+      "SELECT type, data, keyqms, hash FROM items AS t1 WHERE NOT EXISTS(SELECT * FROM folder2item WHERE "
+      "child=t1.id) ORDER BY t1.type, t1.name",
       return )
 
+  blockUpdateItems(true);
   while (query.next()) {
-    quint64 id = query.value(0).toULongLong();
-    quint32 type = query.value(1).toUInt();
-
-    IGisItem::newGisItem(type, id, db, this);
+    IGisItem::newGisItem(query.value(0).toUInt(), query.value(1).toByteArray(), query.value(2).toString(),
+                         query.value(3).toString(), this);
   }
+  blockUpdateItems(false);
 
   setText(CGisListWks::eColumnDecoration, "");
 }
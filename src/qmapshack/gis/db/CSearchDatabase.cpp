@@ -27,6 +27,7 @@
 #include "gis/db/CDBFolderOther.h"
 #include "gis/db/CDBFolderProject.h"
 #include "gis/db/CDBItem.h"
+#include "gis/db/IDB.h"
 #include "gis/db/IDBFolder.h"
 #include "gis/db/macros.h"
 
@@ -67,14 +68,25 @@ void CSearchDatabase::slotItemChanged(QTreeWidgetItem* item, int column) {
 }
 
 void CSearchDatabase::slotSearch() {
+  QSqlQuery query(dbFolder.getDb());
+  dbFolder.search(lineQuery->text(), query);
+  showResult(query);
+}
+
+void CSearchDatabase::searchArea(const QRectF& area) {
+  labelName->setText(tr("Items of database '%1' in the current view:").arg(dbFolder.getDBName()));
+
+  QSqlQuery query(dbFolder.getDb());
+  IDB::searchSpatialIndex(query, area);
+  showResult(query);
+}
+
+void CSearchDatabase::showResult(QSqlQuery& query) {
   internalEdit = true;
 
   treeResult->clear();
 
   QSqlDatabase& db = dbFolder.getDb();
-  QSqlQuery query(db);
-  dbFolder.search(lineQuery->text(), query);
-
   QMap<quint64, IDBFolder*> folders;
 
   while (query.next()) {
@@ -26,6 +26,7 @@
 class CGisListDB;
 class IDBFolder;
 class QSqlDatabase;
+class QSqlQuery;
 class CEvtW2DAckInfo;
 
 class CSearchDatabase : public QDialog, private Ui::ISearchDatabase {
@@ -36,6 +37,13 @@ class CSearchDatabase : public QDialog, private Ui::ISearchDatabase {
 
   bool event(QEvent* e) override;
 
+  /**
+     @brief Show all items intersecting an area
+
+     @param area  the area in [rad]
+   */
+  void searchArea(const QRectF& area);
+
  signals:
   void sigItemChanged(QTreeWidgetItem* item, int column);
 
@@ -44,6 +52,7 @@ class CSearchDatabase : public QDialog, private Ui::ISearchDatabase {
   void slotItemChanged(QTreeWidgetItem* item, int column);
 
  private:
+  void showResult(QSqlQuery& query);
   void addWithParentFolders(QTreeWidget* result, IDBFolder* folder, QMap<quint64, IDBFolder*>& folders,
                             QSqlDatabase& sqlDB);
   void updateFolder(IDBFolder* folder, CEvtW2DAckInfo* evt);
@@ -36,6 +36,7 @@ CSetupWorkspace::CSetupWorkspace(CGisWorkspace* workspace, QWidget* parent) : QD
   checkDbUpdate->setChecked(cfg.value("listenUpdate", false).toBool());
   linePort->setText(cfg.value("port", "34123").toString());
   checkDeviceSupport->setChecked(cfg.value("device support", true).toBool());
+  checkQmsContainer->setChecked(cfg.value("qmsContainer", false).toBool());
   cfg.endGroup();
 
   checkShowTags->setChecked(!workspace->areTagsHidden());
@@ -53,6 +54,7 @@ void CSetupWorkspace::accept() {
   cfg.setValue("listenUpdate", checkDbUpdate->isChecked());
   cfg.setValue("port", linePort->text());
   cfg.setValue("device support", checkDeviceSupport->isChecked());
+  cfg.setValue("qmsContainer", checkQmsContainer->isChecked());
   cfg.endGroup();
 
   workspace->setTagsHidden(!checkShowTags->isChecked());
@@ -22,7 +22,9 @@
 #include <QtWidgets>
 
 #include "CMainWindow.h"
+#include "gis/IGisItem.h"
 #include "gis/db/macros.h"
+#include "gis/proj_x.h"
 
 QMap<QString, int> IDB::references;
 
@@ -106,3 +108,78 @@ quint64 IDB::getLastInsertID(QSqlDatabase& db, const QString& table) {
   query.next();
   return query.value(0).toULongLong();
 }
+
+// the geometry as used by MySQL's spatial index. A rectangle is defined by the envelope of it's diagonal.
+static QString toMysqlEnvelope(const QRectF& area) {
+  return QString("LINESTRING(%1 %2, %3 %4)")
+      .arg(area.left(), 0, 'f', 8)
+      .arg(area.top(), 0, 'f', 8)
+      .arg(area.right(), 0, 'f', 8)
+      .arg(area.bottom(), 0, 'f', 8);
+}
+
+bool IDB::updateSpatialIndex(QSqlQuery& query, quint64 id, const IGisItem& item) {
+  // the index uses [°], with west/south as left/top and east/north as right/bottom
+  const QRectF& rectRad = item.getBoundingRect().normalized();
+  const QRectF area(rectRad.topLeft() * RAD_TO_DEG, rectRad.bottomRight() * RAD_TO_DEG);
+
+  // A waypoint has a rectangle of zero size. For all other items this means no geometry at all.
+  if (area.isNull() && (item.type() != IGisItem::eTypeWpt)) {
+    query.prepare("DELETE FROM spatialindex WHERE id=:id");
+    query.bindValue(":id", id);
+    QUERY_EXEC(return false);
+    return true;
+  }
+
+  switch (query.driver()->dbmsType()) {
+    case QSqlDriver::SQLite:
+      query.prepare(
+          "INSERT OR REPLACE INTO spatialindex (id, west, east, south, north) VALUES (:id, :west, :east, :south, "
+          ":north)");
+      query.bindValue(":id", id);
+      query.bindValue(":west", area.left());
+      query.bindValue(":east", area.right());
+      query.bindValue(":south", area.top());
+      query.bindValue(":north", area.bottom());
+      break;
+
+    case QSqlDriver::MySqlServer:
+      query.prepare("REPLACE INTO spatialindex (id, boundary) VALUES (:id, ST_Envelope(ST_GeomFromText(:boundary)))");
+      query.bindValue(":id", id);
+      query.bindValue(":boundary", toMysqlEnvelope(area));
+      break;
+
+    default:
+      return true;
+  }
+
+  QUERY_EXEC(return false);
+  return true;
+}
+
+bool IDB::searchSpatialIndex(QSqlQuery& query, const QRectF& area) {
+  const QRectF& rectRad = area.normalized();
+  const QRectF rectDeg(rectRad.topLeft() * RAD_TO_DEG, rectRad.bottomRight() * RAD_TO_DEG);
+
+  switch (query.driver()->dbmsType()) {
+    case QSqlDriver::SQLite:
+      query.prepare(
+          "SELECT id FROM spatialindex WHERE east>=:west AND west<=:east AND north>=:south AND south<=:north");
+      query.bindValue(":west", rectDeg.left());
+      query.bindValue(":east", rectDeg.right());
+      query.bindValue(":south", rectDeg.top());
+      query.bindValue(":north", rectDeg.bottom());
+      break;
+
+    case QSqlDriver::MySqlServer:
+      query.prepare("SELECT id FROM spatialindex WHERE MBRIntersects(boundary, ST_Envelope(ST_GeomFromText(:area)))");
+      query.bindValue(":area", toMysqlEnvelope(rectDeg));
+      break;
+
+    default:
+      return false;
+  }
+
+  QUERY_EXEC(return false);
+  return true;
+}
@@ -21,8 +21,12 @@
 
 #include <QCoreApplication>
 #include <QMap>
+#include <QRectF>
 #include <QSqlDatabase>
 
+class IGisItem;
+class QSqlQuery;
+
 class IDB {
   Q_DECLARE_TR_FUNCTIONS(IDB)
 
@@ -34,6 +38,28 @@ class IDB {
 
   static quint64 getLastInsertID(QSqlDatabase& db, const QString& table);
 
+  /**
+     @brief Write an item's bounding box into the spatial index
+
+     The index is a R*Tree table for SQLite and a table with a spatial column for MySQL.
+     Items without geometry are removed from the index.
+
+     @param query     the query object to use. It defines the database connection.
+     @param id        the item's database id
+     @param item      the item
+     @return Return false on a database error.
+   */
+  static bool updateSpatialIndex(QSqlQuery& query, quint64 id, const IGisItem& item);
+
+  /**
+     @brief Get the ids of all items intersecting an area
+
+     @param query     the query object to use. It will contain the list of item ids
+     @param area      the area in [rad]
+     @return Return false on a database error.
+   */
+  static bool searchSpatialIndex(QSqlQuery& query, const QRectF& area);
+
   bool isUsable() const { return db.isOpen(); }
 
  protected:
@@ -416,70 +416,30 @@ void IDBFolder::addChildren(const QSet<QString>& activeChildren, bool showFolder
   }
 
   if (showItems) {
-    QList<CDBItem*> items;
-    // tracks 2nd
+    // all items with a single query, then grouped by type
+    query.setForwardOnly(true);
     query.prepare(
-        "SELECT t1.child FROM folder2item AS t1, items AS t2 WHERE t1.parent = :id AND t2.id = t1.child AND "
-        "t2.type=:type ORDER BY t2.id");
+        "SELECT t2.id, t2.type, t2.keyqms, t2.icon, t2.name, t2.date, t2.comment FROM folder2item AS t1, items AS t2 "
+        "WHERE t1.parent = :id AND t2.id = t1.child ORDER BY t2.id");
     query.bindValue(":id", id);
-    query.bindValue(":type", IGisItem::eTypeTrk);
     QUERY_EXEC(return );
-    while (query.next()) {
-      quint64 idChild = query.value(0).toULongLong();
-      CDBItem* item = new CDBItem(db, idChild, nullptr);
-      item->setCheckState(CGisListDB::eColumnCheckbox,
-                          activeChildren.contains(item->getKey()) ? Qt::Checked : Qt::Unchecked);
-      items << item;
-    }
-    addItemsSorted(items);
 
-    // routes 3rd
-    query.prepare(
-        "SELECT t1.child FROM folder2item AS t1, items AS t2 WHERE t1.parent = :id AND t2.id = t1.child AND "
-        "t2.type=:type ORDER BY t2.id");
-    query.bindValue(":id", id);
-    query.bindValue(":type", IGisItem::eTypeRte);
-    QUERY_EXEC(return );
+    QMap<quint32, QList<CDBItem*>> itemsByType;
     while (query.next()) {
-      quint64 idChild = query.value(0).toULongLong();
-      CDBItem* item = new CDBItem(db, idChild, nullptr);
+      CDBItem* item = new CDBItem(db, query, nullptr);
       item->setCheckState(CGisListDB::eColumnCheckbox,
                           activeChildren.contains(item->getKey()) ? Qt::Checked : Qt::Unchecked);
-      items << item;
+      itemsByType[query.value(1).toUInt()] << item;
     }
-    addItemsSorted(items);
 
-    // waypoints 4th
-    query.prepare(
-        "SELECT t1.child FROM folder2item AS t1, items AS t2 WHERE t1.parent = :id AND t2.id = t1.child AND "
-        "t2.type=:type ORDER BY t2.id");
-    query.bindValue(":id", id);
-    query.bindValue(":type", IGisItem::eTypeWpt);
-    QUERY_EXEC(return );
-    while (query.next()) {
-      quint64 idChild = query.value(0).toULongLong();
-      CDBItem* item = new CDBItem(db, idChild, nullptr);
-      item->setCheckState(CGisListDB::eColumnCheckbox,
-                          activeChildren.contains(item->getKey()) ? Qt::Checked : Qt::Unchecked);
-      items << item;
+    // tracks 2nd, routes 3rd, waypoints 4th and overlays 5th
+    for (quint32 type : {IGisItem::eTypeTrk, IGisItem::eTypeRte, IGisItem::eTypeWpt, IGisItem::eTypeOvl}) {
+      addItemsSorted(itemsByType[type]);
     }
-    addItemsSorted(items);
-
-    // overlays 5th
-    query.prepare(
-        "SELECT t1.child FROM folder2item AS t1, items AS t2 WHERE t1.parent = :id AND t2.id = t1.child AND "
-        "t2.type=:type ORDER BY t2.id");
-    query.bindValue(":id", id);
-    query.bindValue(":type", IGisItem::eTypeOvl);
-    QUERY_EXEC(return );
-    while (query.next()) {
-      quint64 idChild = query.value(0).toULongLong();
-      CDBItem* item = new CDBItem(db, idChild, nullptr);
-      item->setCheckState(CGisListDB::eColumnCheckbox,
-                          activeChildren.contains(item->getKey()) ? Qt::Checked : Qt::Unchecked);
-      items << item;
+    // drop items of unknown type, as they haven't been queried before either
+    for (QList<CDBItem*>& items : itemsByType) {
+      qDeleteAll(items);
     }
-    addItemsSorted(items);
   }
 }
 
@@ -165,7 +165,7 @@ bool IDBMysql::initDB() {
       "WHERE id=OLD.child AND OLD.child NOT IN(SELECT child FROM folder2item);",
       return false);
 
-  return true;
+  return createSpatialIndex();
 }
 
 bool IDBMysql::migrateDB(int version) {
@@ -183,6 +183,12 @@ bool IDBMysql::migrateDB(int version) {
         throw -1;
       }
     }
+
+    if (version < 7) {
+      if (!migrateDB6to7()) {
+        throw -1;
+      }
+    }
   } catch (int i) {
     if (i == -1) {
       return false;
@@ -289,3 +295,73 @@ bool IDBMysql::migrateDB5to6() {
 
   return true;
 }
+
+bool IDBMysql::migrateDB6to7() {
+  QSqlQuery query(db);
+
+  if (!createSpatialIndex()) {
+    return false;
+  }
+
+  // get number of items in the database
+  QUERY_RUN("SELECT Count(*) FROM items", return false);
+  query.next();
+  quint32 N = query.value(0).toUInt();
+
+  // over all items
+  QUERY_RUN("SELECT id, type FROM items", return false);
+  PROGRESS_SETUP(tr("Update to database version 7. Migrate all GIS items."), 0, N,
+                 CMainWindow::self().getBestWidgetForParent());
+  progress.enableCancel(false);
+  quint32 cnt = 0;
+  while (query.next()) {
+    PROGRESS(cnt++, ;);
+
+    quint64 itemId = query.value(0).toULongLong();
+    quint32 itemType = query.value(1).toUInt();
+    IGisItem* item = IGisItem::newGisItem(itemType, itemId, db, nullptr);
+
+    if (nullptr == item) {
+      continue;
+    }
+
+    // add the item's bounding box to the spatial index
+    QSqlQuery query2(db);
+    if (!updateSpatialIndex(query2, itemId, *item)) {
+      delete item;
+      return false;
+    }
+
+    delete item;
+  }
+
+  return true;
+}
+
+bool IDBMysql::createSpatialIndex() {
+  QSqlQuery query(db);
+
+  // MySQL 8 ignores a spatial index on a column without SRID. Older versions
+  // and MariaDB don't know the SRID attribute.
+  if (!query.exec("CREATE TABLE spatialindex ("
+                  "id             INTEGER PRIMARY KEY,"
+                  "boundary       GEOMETRY NOT NULL SRID 0,"
+                  "SPATIAL INDEX(boundary)"
+                  ")")) {
+    QUERY_RUN(
+        "CREATE TABLE spatialindex ("
+        "id             INTEGER PRIMARY KEY,"
+        "boundary       GEOMETRY NOT NULL,"
+        "SPATIAL INDEX(boundary)"
+        ")",
+        return false);
+  }
+
+  QUERY_RUN(
+      "CREATE TRIGGER spatialindex_delete "
+      "AFTER DELETE ON items "
+      "FOR EACH ROW DELETE FROM spatialindex WHERE id=OLD.id;",
+      return false);
+
+  return true;
+}
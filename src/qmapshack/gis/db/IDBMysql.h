@@ -35,6 +35,10 @@ class IDBMysql : public IDB {
   bool migrateDB(int version) override;
   bool migrateDB4to5();
   bool migrateDB5to6();
+  bool migrateDB6to7();
+
+ private:
+  bool createSpatialIndex();
 };
 
 #endif  // IDBMYSQL_H
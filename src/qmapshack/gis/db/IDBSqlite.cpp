@@ -170,6 +170,10 @@ bool IDBSqlite::initDB() {
         "END;",
         throw -1);
 
+    if (!createSpatialIndex()) {
+      throw -1;
+    }
+
     QUERY_RUN("END TRANSACTION;", throw -1);
   } catch (int i) {
     if (i == -1) {
@@ -216,6 +220,12 @@ bool IDBSqlite::migrateDB(int version) {
       }
     }
 
+    if (version < 7) {
+      if (!migrateDB6to7()) {
+        throw -1;
+      }
+    }
+
     QUERY_RUN("END TRANSACTION;", throw -1);
   } catch (int i) {
     if (i == -1) {
@@ -463,3 +473,62 @@ bool IDBSqlite::migrateDB5to6() {
 
   return true;
 }
+
+bool IDBSqlite::migrateDB6to7() {
+  QSqlQuery query(db);
+
+  if (!createSpatialIndex()) {
+    return false;
+  }
+
+  // get number of items in the database
+  QUERY_RUN("SELECT Count(*) FROM items", return false);
+  query.next();
+  quint32 N = query.value(0).toUInt();
+
+  // over all items
+  QUERY_RUN("SELECT id, type FROM items", return false);
+  PROGRESS_SETUP(tr("Update to database version 7. Migrate all GIS items."), 0, N,
+                 CMainWindow::self().getBestWidgetForParent());
+  progress.enableCancel(false);
+  quint32 cnt = 0;
+  while (query.next()) {
+    PROGRESS(cnt++, ;);
+
+    quint64 idItem = query.value(0).toULongLong();
+    quint32 typeItem = query.value(1).toUInt();
+
+    IGisItem* item = IGisItem::newGisItem(typeItem, idItem, db, nullptr);
+
+    if (nullptr == item) {
+      continue;
+    }
+
+    // add the item's bounding box to the spatial index
+    QSqlQuery query2(db);
+    if (!updateSpatialIndex(query2, idItem, *item)) {
+      delete item;
+      return false;
+    }
+
+    delete item;
+  }
+
+  return true;
+}
+
+bool IDBSqlite::createSpatialIndex() {
+  QSqlQuery query(db);
+
+  // R*Tree with the items' bounding boxes in [°]
+  QUERY_RUN("CREATE VIRTUAL TABLE spatialindex USING rtree(id, west, east, south, north)", return false);
+
+  QUERY_RUN(
+      "CREATE TRIGGER spatialindex_delete "
+      "AFTER DELETE ON items BEGIN "
+      "DELETE FROM spatialindex WHERE id=OLD.id; "
+      "END;",
+      return false);
+
+  return true;
+}
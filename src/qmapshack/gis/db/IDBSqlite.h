@@ -37,6 +37,10 @@ class IDBSqlite : public IDB {
   bool migrateDB3to4();
   bool migrateDB4to5();
   bool migrateDB5to6();
+  bool migrateDB6to7();
+
+ private:
+  bool createSpatialIndex();
 };
 
 #endif  // IDBSQLITE_H
@@ -19,7 +19,7 @@
 #ifndef MACROS_H
 #define MACROS_H
 
-#define DB_VERSION 6
+#define DB_VERSION 7
 
 #define NO_CMD ((void)0)
 
@@ -39,6 +39,17 @@ CFitProject::CFitProject(const QString& filename, IDevice* parent) : IGisProject
   loadFitFromFile(filename, false);
 }
 
+CFitProject::CFitProject(const QString& filename)
+    : IGisProject(eTypeFit, filename, static_cast<CGisListWks*>(nullptr)) {
+  blockUpdateItems(true);
+  try {
+    tryOpeningFitFile(filename);
+  } catch (QString& errormsg) {
+    qWarning() << "Failed to load FIT file:" << errormsg;
+    valid = false;
+  }
+}
+
 void CFitProject::loadFitFromFile(const QString& filename, bool showErrorMsg) {
   setIcon(CGisListWks::eColumnIcon, QIcon("://icons/32x32/FitProject.png"));
   blockUpdateItems(true);
@@ -54,7 +65,6 @@ void CFitProject::loadFitFromFile(const QString& filename, bool showErrorMsg) {
     valid = false;
   }
 
-  sortItems();
   blockUpdateItems(false);
 }
 
@@ -84,6 +94,7 @@ void CFitProject::tryOpeningFitFile(const QString& filename) {
   }
   file.close();
 
+  sortItems();
   markAsSaved();
 
   setToolTip(CGisListWks::eColumnName, getInfo());
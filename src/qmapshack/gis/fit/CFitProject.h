@@ -30,6 +30,8 @@ class CFitProject final : public IGisProject {
  public:
   CFitProject(const QString& filename, CGisListWks* parent);
   CFitProject(const QString& filename, IDevice* parent);
+  /// load a file into a project without parent, see CGpxProject::CGpxProject(const QString&)
+  explicit CFitProject(const QString& filename);
   virtual ~CFitProject();
 
   const QString getFileDialogFilter() const override { return IGisProject::filedialogFilterFIT; }
@@ -1674,38 +1674,26 @@ void initProfiles(QMap<quint16, CFitProfile*>& allProfiles) {
   allProfiles.insert(fitGlobalMesgNrInvalid, new CFitProfile());
 }
 
-CFitProfileLookup* fitLookupInstance = nullptr;
-
-CFitProfileLookup::CFitProfileLookup() {
-  initProfiles(allProfiles);
-  connect(qApp, &QApplication::aboutToQuit, this, &CFitProfileLookup::slotCleanup);
-}
+CFitProfileLookup::CFitProfileLookup() { initProfiles(allProfiles); }
 
 CFitProfileLookup::~CFitProfileLookup() { qDeleteAll(allProfiles); }
 
-void CFitProfileLookup::slotCleanup() {
-  fitLookupInstance = nullptr;
-  delete this;
+const CFitProfileLookup& CFitProfileLookup::self() {
+  // the initialization of a local static is thread safe
+  static const CFitProfileLookup lookup;
+  return lookup;
 }
 
 const CFitProfile* CFitProfileLookup::getProfile(quint16 globalMesgNr) {
-  if (fitLookupInstance == nullptr) {
-    fitLookupInstance = new CFitProfileLookup();
-  }
-
-  if (fitLookupInstance->allProfiles.contains(globalMesgNr)) {
-    return fitLookupInstance->allProfiles[globalMesgNr];
-  }
-  return fitLookupInstance->allProfiles[fitGlobalMesgNrInvalid];
+  const QMap<quint16, CFitProfile*>& allProfiles = self().allProfiles;
+  return allProfiles.value(globalMesgNr, allProfiles.value(fitGlobalMesgNrInvalid));
 }
 
 const CFitFieldProfile* CFitProfileLookup::getFieldForProfile(quint16 globalMesgNr, quint8 fieldDefNr) {
-  if (fitLookupInstance == nullptr) {
-    fitLookupInstance = new CFitProfileLookup();
-  }
-
-  if (fitLookupInstance->allProfiles.contains(globalMesgNr)) {
-    return fitLookupInstance->allProfiles[globalMesgNr]->getField(fieldDefNr);
+  const QMap<quint16, CFitProfile*>& allProfiles = self().allProfiles;
+  const auto& profile = allProfiles.constFind(globalMesgNr);
+  if (profile != allProfiles.constEnd()) {
+    return (*profile)->getField(fieldDefNr);
   }
-  return fitLookupInstance->allProfiles[fitGlobalMesgNrInvalid]->getField(fitFieldDefNrInvalid);
-}
\ No newline at end of file
+  return allProfiles.value(fitGlobalMesgNrInvalid)->getField(fitFieldDefNrInvalid);
+}
@@ -24,8 +24,7 @@
 class CFitProfile;
 class CFitFieldProfile;
 
-class CFitProfileLookup : public QObject {
-  Q_OBJECT
+class CFitProfileLookup {
  public:
   static const CFitProfile* getProfile(quint16 globalMesgNr);
   static const CFitFieldProfile* getFieldForProfile(quint16 globalMesgNr, quint8 fieldDefNr);
@@ -33,9 +32,10 @@ class CFitProfileLookup : public QObject {
  private:
   CFitProfileLookup();
   ~CFitProfileLookup();
+  /// the lookup is created on first use. This is thread safe as FIT files are loaded by worker threads, too.
+  static const CFitProfileLookup& self();
+  /// read only after construction, thus it can be shared by all threads
   QMap<quint16, CFitProfile*> allProfiles;
- private slots:
-  void slotCleanup();
 };
 
 #endif  // CFITPROFILELOOKUP_H
@@ -65,6 +65,17 @@ CGpxProject::CGpxProject(const QString& filename, const IGisProject* project, ID
   valid = true;
 }
 
+CGpxProject::CGpxProject(const QString& filename)
+    : IGisProject(eTypeGpx, filename, static_cast<CGisListWks*>(nullptr)) {
+  blockUpdateItems(true);
+  try {
+    loadGpx(filename, this);
+  } catch (QString& errormsg) {
+    qWarning() << "Failed to load GPX file:" << errormsg;
+    valid = false;
+  }
+}
+
 CGpxProject::~CGpxProject() {}
 
 void CGpxProject::loadGpx(const QString& filename) {
@@ -203,6 +214,22 @@ void CGpxProject::loadGpx(const QString& filename, CGpxProject* project) {
   project->valid = true;
 }
 
+bool CGpxProject::isCreatedByQMS(const QString& filename) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  // load file content to xml document
+  QDomDocument xml;
+  if (!xml.setContent(&file, false)) {
+    return false;
+  }
+  const QDomElement& docElem = xml.documentElement();
+  const QDomNamedNodeMap& attr = docElem.attributes();
+  return attr.namedItem("creator").nodeValue().startsWith("QMapShack");
+}
+
 bool CGpxProject::saveAs(const QString& fn, IGisProject& project, bool strictGpx11) {
   QString _fn_ = fn;
   QFileInfo fi(_fn_);
@@ -213,20 +240,8 @@ bool CGpxProject::saveAs(const QString& fn, IGisProject& project, bool strictGpx
   CProjectMountLock mountLock(project);
 
   // safety check for existing files
-  QFile file(_fn_);
-  if (file.exists()) {
-    file.open(QIODevice::ReadOnly);
-    bool createdByQMS = false;
-
-    // load file content to xml document
-    QDomDocument xml;
-    if (xml.setContent(&file, false)) {
-      const QDomElement& docElem = xml.documentElement();
-      const QDomNamedNodeMap& attr = docElem.attributes();
-      createdByQMS = attr.namedItem("creator").nodeValue().startsWith("QMapShack");
-    }
-
-    if (!createdByQMS) {
+  if (QFile::exists(_fn_)) {
+    if (!isCreatedByQMS(_fn_)) {
       int res = QMessageBox::warning(CMainWindow::getBestWidgetForParent(), tr("File exists ..."),
                                      tr("The file exists and it has not been created by QMapShack. "
                                         "If you press 'yes' all data in this file will be lost. "
@@ -239,8 +254,6 @@ bool CGpxProject::saveAs(const QString& fn, IGisProject& project, bool strictGpx
         return false;
       }
     }
-
-    file.close();
   }
 
   //  ---- start content of gpx
@@ -333,6 +346,7 @@ bool CGpxProject::saveAs(const QString& fn, IGisProject& project, bool strictGpx
   //  ---- stop  content of gpx
 
   bool res = true;
+  QFile file(_fn_);
   try {
     if (!file.open(QIODevice::WriteOnly)) {
       throw tr("Failed to create file '%1'").arg(_fn_);
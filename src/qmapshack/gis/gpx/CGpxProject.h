@@ -30,6 +30,14 @@ class CGpxProject : public IGisProject {
   CGpxProject(const QString& filename, CGisListWks* parent);
   CGpxProject(const QString& filename, IDevice* parent);
   CGpxProject(const QString& filename, const IGisProject* project, IDevice* parent);
+  /**
+     @brief Load a file into a project without parent
+
+     This is used to parse files in a worker thread. Errors are logged instead of
+     being shown in a message box. The items are not updated (e.g. no correlation of
+     tracks and waypoints). This is left to the project the data is restored to.
+   */
+  explicit CGpxProject(const QString& filename);
   virtual ~CGpxProject();
 
   const QString getFileDialogFilter() const override { return IGisProject::filedialogFilterGPX; }
@@ -42,6 +50,9 @@ class CGpxProject : public IGisProject {
 
   static void loadGpx(const QString& filename, CGpxProject* project);
 
+  /// true if the GPX file has been written by QMapShack and can be overwritten without asking
+  static bool isCreatedByQMS(const QString& filename);
+
  private:
   void loadGpx(const QString& filename);
 };
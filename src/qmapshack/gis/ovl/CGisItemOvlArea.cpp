@@ -29,6 +29,7 @@
 #include "gis/prj/IGisProject.h"
 #include "gis/proj_x.h"
 #include "helpers/CDraw.h"
+#include "helpers/COccupancyGrid.h"
 
 #define DEFAULT_COLOR 4
 #define MIN_DIST_CLOSE_TO 10
@@ -98,7 +99,9 @@ CGisItemOvlArea::CGisItemOvlArea(quint64 id, QSqlDatabase& db, IGisProject* proj
 
 CGisItemOvlArea::~CGisItemOvlArea() {
   // reset user focus if focused on this track
-  if (key == keyUserFocus) {
+  // The focus is owned by the main thread. Items deleted by worker threads (e.g. projects loaded
+  // by IDevice::loadProjects()) never have it and must not touch it.
+  if ((QThread::currentThread() == qApp->thread()) && (key == keyUserFocus)) {
     keyUserFocus.clear();
   }
 }
@@ -121,6 +124,12 @@ bool CGisItemOvlArea::isCloseTo(const QPointF& pos) {
   return dist < 20;
 }
 
+QRectF CGisItemOvlArea::getScreenArea() const {
+  QMutexLocker lock(&mutexItems);
+
+  return polygonArea.isEmpty() ? QRectF() : polygonArea.boundingRect().adjusted(-20, -20, 20, 20);
+}
+
 bool CGisItemOvlArea::isWithin(const QRectF& area, selflags_t flags) {
   QPolygonF l;
   getPolylineDegFromData(l);
@@ -228,7 +237,8 @@ void CGisItemOvlArea::deriveSecondaryData() {
   area.area = qAbs(area.area / 2);
 }
 
-void CGisItemOvlArea::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& /*blockedAreas*/, CGisDraw* gis) {
+void CGisItemOvlArea::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& /*blockedAreas*/,
+                               CGisDraw* gis) {
   QMutexLocker lock(&mutexItems);
 
   polygonArea.clear();
@@ -272,7 +282,7 @@ void CGisItemOvlArea::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRe
   p.restore();
 }
 
-void CGisItemOvlArea::drawLabel(QPainter& p, const QPolygonF& /*viewport*/, QList<QRectF>& blockedAreas,
+void CGisItemOvlArea::drawLabel(QPainter& p, const QPolygonF& /*viewport*/, COccupancyGrid& blockedAreas,
                                 const QFontMetricsF& fm, CGisDraw* /*gis*/) {
   QMutexLocker lock(&mutexItems);
 
@@ -285,7 +295,7 @@ void CGisItemOvlArea::drawLabel(QPainter& p, const QPolygonF& /*viewport*/, QLis
   rect.moveCenter(pt);
 
   CDraw::text(getName(), p, pt, Qt::darkBlue);
-  blockedAreas << rect;
+  blockedAreas.insert(rect);
 }
 
 void CGisItemOvlArea::drawHighlight(QPainter& p) {
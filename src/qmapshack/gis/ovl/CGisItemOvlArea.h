@@ -79,14 +79,15 @@ class CGisItemOvlArea : public IGisItem, public IGisLine {
   void edit() override;
 
   using IGisItem::drawItem;
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) override;
-  void drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) override;
+  void drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                  CGisDraw* gis) override;
   void drawHighlight(QPainter& p) override;
 
   IScrOpt* getScreenOptions(const QPoint& origin, IMouse* mouse) override;
   QPointF getPointCloseBy(const QPoint& screenPos) override;
   bool isCloseTo(const QPointF& pos) override;
+  QRectF getScreenArea() const override;
   bool isWithin(const QRectF& area, selflags_t flags) override;
 
   void gainUserFocus(bool yes) override;
@@ -32,6 +32,7 @@
 #include "gis/gpx/CGpxProject.h"
 #include "gis/ovl/CGisItemOvlArea.h"
 #include "gis/prj/CDetailsPrj.h"
+#include "gis/proj_x.h"
 #include "gis/qlb/CQlbProject.h"
 #include "gis/qms/CQmsProject.h"
 #include "gis/rte/CGisItemRte.h"
@@ -64,6 +65,8 @@ const QString IGisProject::filedialogLoadFilters =
     filedialogFilterSLF + ";; " + filedialogFilterFIT;
 
 QString IGisProject::keyUserFocus;
+QMultiHash<QString, IGisItem*> IGisProject::itemsByKeyAll;
+QRecursiveMutex IGisProject::mutexItemsByKey;
 
 IGisProject::IGisProject(type_e type, const QString& filename, CGisListWks* parent)
     : QTreeWidgetItem(parent), type(type), filename(filename) {
@@ -99,7 +102,15 @@ IGisProject::IGisProject(type_e type, const QString& filename, IDevice* parent)
 
 IGisProject::~IGisProject() {
   delete dlgDetails;
-  if (key == keyUserFocus) {
+  {
+    // The children are deleted by QTreeWidgetItem when the project is not an
+    // IGisProject anymore. They can't remove themselves from the index.
+    QMutexLocker lock(&mutexItemsByKey);
+    clearKeyIndex();
+  }
+  // The focus is owned by the main thread. Items deleted by worker threads (e.g. projects loaded
+  // by IDevice::loadProjects()) never have it and must not touch it.
+  if ((QThread::currentThread() == qApp->thread()) && (key == keyUserFocus)) {
     keyUserFocus.clear();
   }
 }
@@ -348,6 +359,8 @@ bool IGisProject::save() {
 }
 
 bool IGisProject::saveAs(QString fn, QString filter) {
+  restoreItems();
+
   SETTINGS;
 
   if (fn.isEmpty()) {
@@ -399,6 +412,8 @@ bool IGisProject::saveAs(QString fn, QString filter) {
 }
 
 bool IGisProject::saveAsStrictGpx11() {
+  restoreItems();
+
   SETTINGS;
 
   QString fn;
@@ -490,42 +505,141 @@ QString IGisProject::getInfo() const {
   if (cntItemsByType[IGisItem::eTypeOvl]) {
     str += "<br/>\n" + tr("Areas: %1").arg(cntItemsByType[IGisItem::eTypeOvl]);
   }
+  if (hasDeferredItems()) {
+    str += "<br/>\n" + tr("Items are loaded on demand.");
+  }
 
   return str;
 }
 
 IGisItem* IGisProject::getItemByKey(const IGisItem::key_t& key) {
-  for (int i = 0; i < childCount(); i++) {
-    IGisItem* item = dynamic_cast<IGisItem*>(child(i));
-    if (nullptr == item) {
-      continue;
+  restoreItems();
+
+  QMutexLocker lock(&mutexItemsByKey);
+  for (auto it = itemsByKey.constFind(key.item); (it != itemsByKey.constEnd()) && (it.key() == key.item); ++it) {
+    if (it.value()->getKey() == key) {
+      return it.value();
     }
+  }
+  return nullptr;
+}
 
-    if (item->getKey() == key) {
+IGisItem* IGisProject::getItemByKey(const IGisItem::key_t& key, const QTreeWidget* tree) {
+  QMutexLocker lock(&mutexItemsByKey);
+  for (auto it = itemsByKeyAll.constFind(key.item); (it != itemsByKeyAll.constEnd()) && (it.key() == key.item);
+       ++it) {
+    IGisItem* item = it.value();
+    if ((item->treeWidget() == tree) && (item->getKey() == key)) {
       return item;
     }
   }
   return nullptr;
 }
 
+void IGisProject::updateItemKey(IGisItem* item, const QString& key) {
+  QMutexLocker lock(&mutexItemsByKey);
+
+  auto it = keysByItem.find(item);
+  if (it != keysByItem.end()) {
+    if (*it == key) {
+      return;
+    }
+    itemsByKey.remove(*it, item);
+    itemsByKeyAll.remove(*it, item);
+    keysByItem.erase(it);
+  }
+
+  if (!key.isEmpty()) {
+    itemsByKey.insert(key, item);
+    itemsByKeyAll.insert(key, item);
+    keysByItem.insert(item, key);
+  }
+}
+
+QList<QTreeWidgetItem*> IGisProject::takeItems() {
+  QMutexLocker lock(&mutexItemsByKey);
+  clearKeyIndex();
+  return takeChildren();
+}
+
+void IGisProject::clearKeyIndex() {
+  for (auto it = keysByItem.constBegin(); it != keysByItem.constEnd(); ++it) {
+    itemsByKeyAll.remove(it.value(), const_cast<IGisItem*>(it.key()));
+  }
+  itemsByKey.clear();
+  keysByItem.clear();
+}
+
+void IGisProject::buildKeyIndex() {
+  QMutexLocker lock(&mutexItemsByKey);
+  clearKeyIndex();
+
+  const int N = childCount();
+  for (int i = 0; i < N; i++) {
+    IGisItem* item = dynamic_cast<IGisItem*>(child(i));
+    if (nullptr != item) {
+      updateItemKey(item, item->getKey().item);
+    }
+  }
+}
+
 void IGisProject::getItemsByKeys(const QList<IGisItem::key_t>& keys, QList<IGisItem*>& items) {
+  restoreItems();
+
+  // a set of the item keys to avoid a full compare with all keys for every item
+  QSet<QString> keysItem;
+  for (const IGisItem::key_t& key : keys) {
+    keysItem << key.item;
+  }
+
   for (int i = 0; i < childCount(); i++) {
     IGisItem* item = dynamic_cast<IGisItem*>(child(i));
     if (nullptr == item) {
       continue;
     }
 
-    if (keys.contains(item->getKey())) {
+    const IGisItem::key_t& key = item->getKey();
+    if (keysItem.contains(key.item) && keys.contains(key)) {
       items << item;
     }
   }
 }
 
+IGisItem* IGisProject::getIndexedItem(const indexed_item_t& entry) const {
+  QTreeWidgetItem* item = child(entry.idx);
+  return (item == entry.child) ? dynamic_cast<IGisItem*>(item) : nullptr;
+}
+
 void IGisProject::getItemsByPos(const QPointF& pos, QList<IGisItem*>& items) {
   if (!isVisible()) {
     return;
   }
 
+  if (validGrid) {
+    QVector<qint32> indices;
+    gridItems.findAll(QRectF(pos - QPointF(0.5, 0.5), QSizeF(1, 1)), indices);
+
+    QList<IGisItem*> candidates;
+    for (qint32 index : qAsConst(indices)) {
+      IGisItem* item = getIndexedItem(itemsInGrid[index]);
+      if (nullptr == item) {
+        // the project has changed since the last draw, fall back to a full scan
+        candidates.clear();
+        validGrid = false;
+        break;
+      }
+
+      if (!item->isHidden() && item->isCloseTo(pos)) {
+        candidates << item;
+      }
+    }
+
+    if (validGrid) {
+      items << candidates;
+      return;
+    }
+  }
+
   for (int i = 0; i < childCount(); i++) {
     IGisItem* item = dynamic_cast<IGisItem*>(child(i));
     if (nullptr == item || item->isHidden()) {
@@ -543,12 +657,23 @@ void IGisProject::getItemsByArea(const QRectF& area, IGisItem::selflags_t flags,
     return;
   }
 
+  // the items' bounding rectangles are in [rad] while the area is in [deg]
+  const QRectF areaRad = QRectF(area.topLeft() * DEG_TO_RAD, area.bottomRight() * DEG_TO_RAD).normalized();
+
   for (int i = 0; i < childCount(); i++) {
     IGisItem* item = dynamic_cast<IGisItem*>(child(i));
     if (nullptr == item || item->isHidden()) {
       continue;
     }
 
+    // Skip items with a bounding rectangle not touching the area before testing
+    // all points. The edges are included as a waypoint's rectangle has no size.
+    const QRectF rect = item->getBoundingRect().normalized();
+    if ((rect.left() > areaRad.right()) || (rect.right() < areaRad.left()) || (rect.top() > areaRad.bottom()) ||
+        (rect.bottom() < areaRad.top())) {
+      continue;
+    }
+
     if (item->isWithin(area, flags)) {
       items << item;
     }
@@ -573,6 +698,22 @@ void IGisProject::mouseMove(const QPointF& pos) {
     return;
   }
 
+  if (validGrid) {
+    bool isValid = true;
+    for (const indexed_item_t& entry : qAsConst(itemsMouseMove)) {
+      IGisItem* item = getIndexedItem(entry);
+      if (nullptr == item) {
+        isValid = false;
+        break;
+      }
+      item->mouseMove(pos);
+    }
+
+    if (isValid) {
+      return;
+    }
+  }
+
   for (int i = 0; i < childCount(); i++) {
     IGisItem* item = dynamic_cast<IGisItem*>(child(i));
     if (nullptr == item || item->isHidden()) {
@@ -708,14 +849,21 @@ void IGisProject::insertCopyOfItem(IGisItem* item, int off, CSelectCopyAction::r
   }
 }
 
-void IGisProject::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) {
+void IGisProject::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) {
+  validGrid = false;
   if (!isVisible()) {
     return;
   }
 
+  QPolygonF area = viewport;
+  gis->convertRad2Px(area);
+  gridItems.reset(area.boundingRect());
+  itemsInGrid.clear();
+  itemsMouseMove.clear();
+
   for (int i = 0; i < childCount(); i++) {
     if (gis->needsRedraw()) {
-      break;
+      return;
     }
 
     IGisItem* item = dynamic_cast<IGisItem*>(child(i));
@@ -724,7 +872,20 @@ void IGisProject::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>
     }
 
     item->drawItem(p, viewport, blockedAreas, gis);
+
+    const QRectF rect = item->getScreenArea();
+    if (!rect.isEmpty()) {
+      gridItems.insert(rect);
+      itemsInGrid << indexed_item_t{i, item};
+    }
+
+    CGisItemWpt* wpt = dynamic_cast<CGisItemWpt*>(item);
+    if (wpt != nullptr && wpt->hasBubble()) {
+      itemsMouseMove << indexed_item_t{i, item};
+    }
   }
+
+  validGrid = true;
 }
 
 void IGisProject::drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) {
@@ -742,7 +903,7 @@ void IGisProject::drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) {
   }
 }
 
-void IGisProject::drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas,
+void IGisProject::drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas,
                             const QFontMetricsF& fm, CGisDraw* gis) {
   if (!isVisible()) {
     return;
@@ -987,20 +1148,61 @@ void IGisProject::setWorkspaceFilter(const CSearch& search) {
 }
 
 void IGisProject::applyFilters() {
+  // a filter has to see all items
+  if (!projectSearch.isEmpty() || !workspaceSearch.isEmpty()) {
+    restoreItems();
+  }
+
   const int N = childCount();
 
+  // drop the values of properties not used anymore and all values if the units changed
+  const qint32 unitType = IUnit::self().type;
+  if (unitType != unitTypeFilterValues) {
+    filterValues.clear();
+    unitTypeFilterValues = unitType;
+  }
+  for (searchProperty_e property : filterValues.keys()) {
+    if ((projectSearch.isEmpty() || projectSearch.getSearchProperty() != property) &&
+        (workspaceSearch.isEmpty() || workspaceSearch.getSearchProperty() != property)) {
+      filterValues.remove(property);
+    }
+  }
+
   for (int n = 0; n < N; n++) {
     IGisItem* item = dynamic_cast<IGisItem*>(child(n));
     if (item == nullptr) {
       continue;
     }
 
-    bool projectFilterResult = projectSearch.getSearchResult(item);
-    bool workspaceFilterResult = workspaceSearch.getSearchResult(item);
+    // get search result returns wether the object matches
+    bool passed = true;
+    if (!projectSearch.isEmpty()) {
+      passed = projectSearch.getSearchResult(getFilterValue(item, n, projectSearch.getSearchProperty()));
+    }
+    if (passed && !workspaceSearch.isEmpty()) {
+      passed = workspaceSearch.getSearchResult(getFilterValue(item, n, workspaceSearch.getSearchProperty()));
+    }
+
+    // changing the visibility is expensive, even if nothing changes
+    if (item->isHidden() == passed) {
+      item->setHidden(!passed);
+    }
+  }
+}
+
+const searchValue_t& IGisProject::getFilterValue(IGisItem* item, qint32 idx, searchProperty_e property) {
+  QVector<filter_value_t>& values = filterValues[property];
+  if (values.size() != childCount()) {
+    values.resize(childCount());
+  }
 
-    item->setHidden(
-        !(projectFilterResult && workspaceFilterResult));  // get search result returns wether the object matches
+  filter_value_t& entry = values[idx];
+  if ((entry.child != item) || (entry.hash != item->getHash())) {
+    entry.child = item;
+    entry.hash = item->getHash();
+    entry.value = item->getValueByKeyword(property);
   }
+  return entry.value;
 }
 
 bool IGisProject::findPolylineCloseBy(const QPointF& pt1, const QPointF& pt2, qint32& threshold, QPolygonF& polyline) {
@@ -21,6 +21,7 @@
 #define IGISPROJECT_H
 
 #include <QDebug>
+#include <QHash>
 #include <QMessageBox>
 #include <QPointer>
 #include <QTreeWidgetItem>
@@ -28,6 +29,7 @@
 #include "gis/IGisItem.h"
 #include "gis/search/CProjectFilterItem.h"
 #include "gis/search/CSearch.h"
+#include "helpers/COccupancyGrid.h"
 #include "helpers/CSelectCopyAction.h"
 
 class CGisListWks;
@@ -95,6 +97,34 @@ class IGisProject : public QTreeWidgetItem {
     QMap<QString, QVariant> extensions;
   };
 
+  /// the state of a single item as it is serialized by operator>>()
+  struct item_snapshot_t {
+    quint8 type = 0;
+    IGisItem::history_t history;
+    quint8 changed = 0;
+    QString lastDatabaseHash;
+    /// not serialized, the item's boundary in [rad]
+    QRectF boundary;
+    /// not serialized, the item's timestamp
+    QDateTime timestamp;
+    /// not serialized, the item's last timestamp. Same as timestamp for items with a single one.
+    QDateTime timeEnd;
+  };
+
+  /**
+     @brief A copy of the project's serialized state
+
+     The project's header is already serialized. The item histories are implicitly
+     shared. Thus a snapshot is cheap to take while holding IGisItem::mutexItems and
+     can be written later without any access to the project.
+   */
+  struct snapshot_t {
+    QByteArray header;
+    QList<item_snapshot_t> items;
+    /// serialized items not restored yet, see deferItems()
+    QByteArray itemsDeferred;
+  };
+
   static const QString filedialogAllSupported;
   static const QString filedialogFilterGPX;
   static const QString filedialogFilterTCX;
@@ -259,6 +289,36 @@ class IGisProject : public QTreeWidgetItem {
    */
   IGisItem* getItemByKey(const IGisItem::key_t& key);
 
+  /**
+     @brief Get a temporary pointer to the item with matching key in all projects of a tree widget
+
+     This is the workspace wide lookup. It does not restore deferred items.
+
+     @param key     the item's key
+     @param tree    the tree widget the item's project is shown in
+     @return If no item is found 0 is returned.
+   */
+  static IGisItem* getItemByKey(const IGisItem::key_t& key, const QTreeWidget* tree);
+
+  /**
+     @brief Register an item's key in the key index
+
+     Items call this whenever their key might have changed. An empty key
+     removes the item from the index.
+
+     @param item    the item, a child of this project
+     @param key     the item's current item key
+   */
+  void updateItemKey(IGisItem* item, const QString& key);
+
+  /**
+     @brief Take all children and remove their keys from the key index
+
+     Use this instead of takeChildren() if the children are deleted or moved
+     to another project.
+   */
+  QList<QTreeWidgetItem*> takeItems();
+
   void getItemsByKeys(const QList<IGisItem::key_t>& keys, QList<IGisItem*>& items);
   /**
      @brief Get a list of items that are close to a given pixel coordinate of the screen
@@ -360,8 +420,8 @@ class IGisProject : public QTreeWidgetItem {
    */
   bool isChanged() const;
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis);
-  void drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis);
+  void drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                  CGisDraw* gis);
   void drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis);
 
@@ -385,6 +445,44 @@ class IGisProject : public QTreeWidgetItem {
    */
   virtual QDataStream& operator>>(QDataStream& stream) const;
 
+  /**
+     @brief Take a snapshot of the data written by IGisProject::operator>>()
+
+     Writing the snapshot to a stream with the same version and byte order results
+     in the same data as IGisProject::operator>>().
+
+     @param snapshot   the snapshot to fill
+     @param version    the version of the target stream
+     @param byteOrder  the byte order of the target stream
+   */
+  void getSnapshot(snapshot_t& snapshot, QDataStream::Version version, QDataStream::ByteOrder byteOrder) const;
+
+  /**
+     @brief Read the project's header but defer restoring the items
+
+     The serialized items are kept as they are until restoreItems() is called.
+     Restoring the items is by far the most expensive part. Thus projects that
+     are neither visible nor expanded can be restored without touching them.
+
+     Items added in the meantime and deferred items are both written by
+     IGisProject::operator>>() and getSnapshot(). Accessing the items by key,
+     applying a filter and copying the project to a device restore the items
+     on demand.
+
+     @param stream the binary data stream
+   */
+  void deferItems(QDataStream& stream);
+
+  /**
+     @brief Restore the items deferred by deferItems()
+
+     Does nothing if there are no deferred items.
+   */
+  void restoreItems();
+
+  /// return true if there are items to be restored by restoreItems()
+  bool hasDeferredItems() const { return !itemsDeferred.isEmpty(); }
+
   /**
      @brief writeMetadata
      @param doc
@@ -464,6 +562,13 @@ class IGisProject : public QTreeWidgetItem {
   void updateDecoration(bool saved);
   void sortItems();
   void sortItems(QList<IGisItem*>& items) const;
+  void setDeferredItems(const QByteArray& items, QDataStream::Version version, QDataStream::ByteOrder byteOrder);
+  bool readHeader(QDataStream& stream);
+  void readItems(QDataStream& stream);
+  void writeHeader(QDataStream& stream) const;
+  void getItemSnapshots(QList<item_snapshot_t>& items) const;
+  /// rebuild the key index from the children, e.g. after children have been added by addChildren()
+  void buildKeyIndex();
 
   /**
      @brief Converts a string with HTML tags to a string without HTML depending on the device
@@ -497,6 +602,11 @@ class IGisProject : public QTreeWidgetItem {
   QString filename;
   bool valid = false;
   bool noUpdate = false;
+
+  /// items read by deferItems() but not restored yet
+  QByteArray itemsDeferred;
+  QDataStream::Version itemsDeferredVersion = QDataStream::Qt_5_2;
+  QDataStream::ByteOrder itemsDeferredByteOrder = QDataStream::LittleEndian;
   bool noCorrelation = false;
   bool changedRoadbookMode = false;
   bool autoSave = false;              ///< flag to show if auto save is on or off
@@ -528,9 +638,66 @@ class IGisProject : public QTreeWidgetItem {
   CSearch workspaceSearch = CSearch("");
 
   CProjectFilterItem* projectFilter = nullptr;
+
+ private:
+  /// an item registered in the hit test index by it's child index
+  struct indexed_item_t {
+    qint32 idx;
+    const QTreeWidgetItem* child;
+  };
+
+  /// the value of an item's search property as used by the last filter run
+  struct filter_value_t {
+    const QTreeWidgetItem* child = nullptr;
+    QString hash;
+    searchValue_t value;
+  };
+
+  IGisItem* getIndexedItem(const indexed_item_t& entry) const;
+  const searchValue_t& getFilterValue(IGisItem* item, qint32 idx, searchProperty_e property);
+  /// remove all entries of this project from the key index, mutexItemsByKey must be locked
+  void clearKeyIndex();
+
+  /**
+      The screen areas of all items drawn by the last complete call of drawItem().
+      The screen coordinates used by IGisItem::isCloseTo() are updated by the same
+      call. Thus the index is in sync with the items. Items removed or inserted in
+      the meantime are detected by a child index not matching the item anymore.
+   */
+  COccupancyGrid gridItems;
+  QVector<indexed_item_t> itemsInGrid;
+  /// waypoints with bubble that have to receive mouse moves
+  QVector<indexed_item_t> itemsMouseMove;
+  bool validGrid = false;
+
+  /**
+      All items by their item key. Items update their entry with updateItemKey()
+      when their key is generated, loaded or changed and when they are deleted.
+      An item key can be used by more than one item, e.g. by a plain copy. Thus
+      the full key has to be compared, too.
+   */
+  QMultiHash<QString, IGisItem*> itemsByKey;
+  /// the item key each item is registered with in itemsByKey
+  QHash<const IGisItem*, QString> keysByItem;
+  /// the same as itemsByKey for the items of all projects
+  static QMultiHash<QString, IGisItem*> itemsByKeyAll;
+  /// protects the key index of all projects. Items are created by worker threads, too.
+  static QRecursiveMutex mutexItemsByKey;
+
+  /**
+      Querying a value from an item can be expensive, e.g. the full text. Thus the
+      values of the properties used by the current filters are kept by child index.
+      An entry is reused as long as the child and it's data hash did not change.
+   */
+  QMap<searchProperty_e, QVector<filter_value_t>> filterValues;
+  /// values with units depend on the unit system (IUnit::type_e) they were queried with
+  qint32 unitTypeFilterValues = NOIDX;
 };
 Q_DECLARE_METATYPE(IGisProject*)
 
+QDataStream& operator<<(QDataStream& stream, const IGisProject::item_snapshot_t& item);
+QDataStream& operator<<(QDataStream& stream, const IGisProject::snapshot_t& snapshot);
+
 class CProjectMountLock {
  public:
   CProjectMountLock(IGisProject& project) : project(project) { project.mount(); }
@@ -19,9 +19,183 @@
 #include "gis/qms/CQmsProject.h"
 
 #include <QtWidgets>
+#include <limits>
 
 #include "CMainWindow.h"
 #include "gis/CGisListWks.h"
+#include "gis/trk/CGisItemTrk.h"
+#include "helpers/CSettings.h"
+#include "units/IUnit.h"
+
+#define MAGIC_SIZE 10
+#define MAGIC_QMS "QMSCont   "
+#define VER_QMS quint8(2)
+#define NO_TIME std::numeric_limits<qint64>::min()
+
+/// the index of all items in a container, stored column by column
+struct index_t {
+  QVector<quint8> types;
+  QVector<quint32> sizes;
+  QVector<QRectF> boundaries;
+  QVector<qint64> timestamps;
+  QVector<qint64> timestampsEnd;
+  /// the size of the item's point chunk, 0 for items without
+  QVector<quint32> sizesChunk;
+};
+
+static void setupStream(QDataStream& stream) {
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream.setVersion(QDataStream::Qt_5_2);
+}
+
+static qint64 toMSecs(const QDateTime& time) { return time.isValid() ? time.toMSecsSinceEpoch() : NO_TIME; }
+
+/**
+   @brief Read the container's header and index
+
+   On success the stream is positioned at the point chunks, if the version has them.
+
+   @param in      the stream positioned at the start of the file
+   @param version the container's version
+   @param header  the project's header as written by IGisProject::operator>>()
+   @param index   the item index
+   @return False if the stream is not a container. The stream is not moved in that case.
+ */
+static bool readContainer(QDataStream& in, quint8& version, QByteArray& header, index_t& index) {
+  QIODevice* dev = in.device();
+  qint64 pos = dev->pos();
+
+  char magic[MAGIC_SIZE];
+  if (in.readRawData(magic, MAGIC_SIZE) != MAGIC_SIZE || strncmp(magic, MAGIC_QMS, MAGIC_SIZE)) {
+    dev->seek(pos);
+    return false;
+  }
+
+  QByteArray compressed;
+  in >> version;
+  in >> header;
+  in >> compressed;
+
+  QDataStream stream(qUncompress(compressed));
+  setupStream(stream);
+  stream >> index.types;
+  stream >> index.sizes;
+  stream >> index.boundaries;
+  stream >> index.timestamps;
+
+  const int N = index.types.size();
+  if (version > 1) {
+    stream >> index.timestampsEnd;
+    stream >> index.sizesChunk;
+  } else {
+    index.timestampsEnd = index.timestamps;
+    index.sizesChunk.fill(0, N);
+  }
+
+  if (index.sizes.size() != N || index.boundaries.size() != N || index.timestamps.size() != N ||
+      index.timestampsEnd.size() != N || index.sizesChunk.size() != N) {
+    qWarning() << "Corrupt item index in QMS file";
+    index = index_t();
+  }
+
+  return true;
+}
+
+/// move the stream from the point chunks to the items
+static void skipPointChunks(QDataStream& in, quint8 version) {
+  if (version > 1) {
+    quint32 size = 0;
+    in >> size;
+    in.skipRawData(size);
+  }
+}
+
+/**
+   @brief Get the compressed point chunk of a track
+
+   One column per value compresses much better than one point after the other.
+ */
+static QByteArray getPointChunk(const CGisItemTrk& trk) {
+  CQmsProject::track_points_t points;
+  for (const CTrackData::trkseg_t& seg : trk.getTrackData().segs) {
+    points.segments << quint32(seg.pts.size());
+    for (const CTrackData::trkpt_t& pt : seg.pts) {
+      points.lon << pt.lon;
+      points.lat << pt.lat;
+      points.ele << pt.ele;
+      points.time << toMSecs(pt.time);
+      points.flags << pt.flags;
+    }
+  }
+
+  QByteArray data;
+  QDataStream stream(&data, QIODevice::WriteOnly);
+  setupStream(stream);
+  stream << points.segments;
+  stream << points.lon;
+  stream << points.lat;
+  stream << points.ele;
+  stream << points.time;
+  stream << points.flags;
+
+  return qCompress(data);
+}
+
+/**
+   @brief Derive the summary from the container's header and index
+
+   @param header  the project's header as written by IGisProject::operator>>()
+   @param index   the item index
+   @param summary the summary to fill
+ */
+static void getSummary(const QByteArray& header, const index_t& index, CQmsProject::summary_t& summary) {
+  summary = CQmsProject::summary_t();
+
+  // the name is the second field after the project's magic string and version
+  QDataStream stream(header);
+  setupStream(stream);
+  stream.skipRawData(MAGIC_SIZE + sizeof(quint8));
+  QString filenameStored;
+  stream >> filenameStored >> summary.name;
+
+  // the boundaries have the north in top() and the south in bottom()
+  qreal west = 0, north = 0, east = 0, south = 0;
+  const int N = index.types.size();
+  for (int i = 0; i < N; i++) {
+    summary.cntItemsByType[IGisItem::type_e(index.types[i])]++;
+
+    const QRectF& boundary = index.boundaries[i];
+    if (i == 0) {
+      west = boundary.left();
+      north = boundary.top();
+      east = boundary.right();
+      south = boundary.bottom();
+    } else {
+      west = qMin(west, boundary.left());
+      north = qMax(north, boundary.top());
+      east = qMax(east, boundary.right());
+      south = qMin(south, boundary.bottom());
+    }
+
+    if (index.timestamps[i] != NO_TIME) {
+      const QDateTime& time = QDateTime::fromMSecsSinceEpoch(index.timestamps[i], Qt::UTC);
+      if (!summary.timeStart.isValid() || time < summary.timeStart) {
+        summary.timeStart = time;
+      }
+    }
+
+    if (index.timestampsEnd[i] != NO_TIME) {
+      const QDateTime& time = QDateTime::fromMSecsSinceEpoch(index.timestampsEnd[i], Qt::UTC);
+      if (!summary.timeEnd.isValid() || time > summary.timeEnd) {
+        summary.timeEnd = time;
+      }
+    }
+  }
+
+  if (N > 0) {
+    summary.boundary = QRectF(QPointF(west, north), QPointF(east, south));
+  }
+}
 
 CQmsProject::CQmsProject(const QString& filename, CGisListWks* parent) : IGisProject(eTypeQms, filename, parent) {
   setIcon(CGisListWks::eColumnIcon, QIcon("://icons/32x32/QmsProject.png"));
@@ -45,9 +219,35 @@ CQmsProject::CQmsProject(const QString& filename, CGisListWks* parent) : IGisPro
   }
 
   QDataStream in(&file);
-  in.setByteOrder(QDataStream::LittleEndian);
-  in.setVersion(QDataStream::Qt_5_2);
-  *this << in;
+  setupStream(in);
+
+  quint8 version = 0;
+  QByteArray header;
+  index_t index;
+  if (readContainer(in, version, header, index)) {
+    QDataStream stream(header);
+    setupStream(stream);
+    readHeader(stream);
+    skipPointChunks(in, version);
+
+    const QByteArray& items = file.readAll();
+    if (parent != nullptr) {
+      // the workspace restores the items as soon as they are needed
+      setDeferredItems(items, QDataStream::Qt_5_2, QDataStream::LittleEndian);
+      getSummary(header, index, summaryDeferred);
+      parent->restoreItemsLater();
+    } else {
+      QDataStream streamItems(items);
+      setupStream(streamItems);
+      blockUpdateItems(true);
+      readItems(streamItems);
+      sortItems();
+      blockUpdateItems(false);
+    }
+  } else {
+    // plain stream written by older versions
+    *this << in;
+  }
   file.close();
 
   markAsSaved();
@@ -58,7 +258,42 @@ CQmsProject::CQmsProject(const QString& filename, CGisListWks* parent) : IGisPro
   valid = true;
 }
 
+QString CQmsProject::getInfo() const {
+  QString str = IGisProject::getInfo();
+  if (!hasDeferredItems()) {
+    return str;
+  }
+
+  // the items are not restored yet but the index tells what is to come
+  const QMap<IGisItem::type_e, qint32>& cnt = summaryDeferred.cntItemsByType;
+  if (cnt.value(IGisItem::eTypeWpt)) {
+    str += "<br/>\n" + tr("Waypoints: %1").arg(cnt.value(IGisItem::eTypeWpt));
+  }
+  if (cnt.value(IGisItem::eTypeTrk)) {
+    str += "<br/>\n" + tr("Tracks: %1").arg(cnt.value(IGisItem::eTypeTrk));
+  }
+  if (cnt.value(IGisItem::eTypeRte)) {
+    str += "<br/>\n" + tr("Routes: %1").arg(cnt.value(IGisItem::eTypeRte));
+  }
+  if (cnt.value(IGisItem::eTypeOvl)) {
+    str += "<br/>\n" + tr("Areas: %1").arg(cnt.value(IGisItem::eTypeOvl));
+  }
+  if (summaryDeferred.timeStart.isValid()) {
+    str += "<br/>\n" + tr("Time: %1 - %2")
+                            .arg(IUnit::datetime2string(summaryDeferred.timeStart, IUnit::eTimeFormatLong),
+                                 IUnit::datetime2string(summaryDeferred.timeEnd, IUnit::eTimeFormatLong));
+  }
+
+  return str;
+}
+
 bool CQmsProject::saveAs(const QString& fn, IGisProject& project) {
+  SETTINGS;
+  const bool container = cfg.value("Database/qmsContainer", false).toBool();
+  return saveAs(fn, project, container ? eFormatContainer : eFormatStream);
+}
+
+bool CQmsProject::saveAs(const QString& fn, IGisProject& project, format_e format) {
   QString _fn_ = fn;
   QFileInfo fi(_fn_);
   if (fi.suffix().toLower() != "qms") {
@@ -74,17 +309,150 @@ bool CQmsProject::saveAs(const QString& fn, IGisProject& project) {
     return false;
   }
   QDataStream out(&file);
-  out.setByteOrder(QDataStream::LittleEndian);
-  out.setVersion(QDataStream::Qt_5_2);
+  setupStream(out);
 
   QString tmp = project.getFilename();
   project.setFilename(_fn_);
 
-  project.IGisProject::operator>>(out);
+  if (format == eFormatStream) {
+    project.IGisProject::operator>>(out);
+    project.setFilename(tmp);
+    file.close();
+    return true;
+  }
+
+  project.restoreItems();
+
+  IGisProject::snapshot_t snapshot;
+  project.getSnapshot(snapshot, QDataStream::Qt_5_2, QDataStream::LittleEndian);
 
   project.setFilename(tmp);
 
+  // The snapshot lists the tracks first and in the order of the children.
+  QList<const CGisItemTrk*> trks;
+  for (int i = 0; i < project.childCount(); i++) {
+    const CGisItemTrk* trk = dynamic_cast<const CGisItemTrk*>(project.child(i));
+    if (nullptr != trk) {
+      trks << trk;
+    }
+  }
+
+  // serialize all items first to know their size
+  index_t index;
+  QByteArray items;
+  QByteArray chunks;
+  QDataStream stream(&items, QIODevice::WriteOnly);
+  setupStream(stream);
+  int idxTrk = 0;
+  for (IGisProject::item_snapshot_t& item : snapshot.items) {
+    // Loading a file clears all changed marks. Items restored later on demand
+    // must not show them either.
+    item.changed = 0;
+
+    const int size = items.size();
+    stream << item;
+
+    quint32 sizeChunk = 0;
+    if ((item.type == IGisItem::eTypeTrk) && (idxTrk < trks.size())) {
+      const QByteArray& chunk = getPointChunk(*trks[idxTrk++]);
+      sizeChunk = chunk.size();
+      chunks += chunk;
+    }
+
+    index.types << item.type;
+    index.sizes << quint32(items.size() - size);
+    index.boundaries << item.boundary;
+    index.timestamps << toMSecs(item.timestamp);
+    index.timestampsEnd << toMSecs(item.timeEnd);
+    index.sizesChunk << sizeChunk;
+  }
+
+  // Columns of similar values compress much better than rows
+  QByteArray indexData;
+  QDataStream streamIndex(&indexData, QIODevice::WriteOnly);
+  setupStream(streamIndex);
+  streamIndex << index.types;
+  streamIndex << index.sizes;
+  streamIndex << index.boundaries;
+  streamIndex << index.timestamps;
+  streamIndex << index.timestampsEnd;
+  streamIndex << index.sizesChunk;
+
+  out.writeRawData(MAGIC_QMS, MAGIC_SIZE);
+  out << VER_QMS;
+  out << snapshot.header;
+  out << qCompress(indexData);
+  out << quint32(chunks.size());
+  out.writeRawData(chunks.constData(), chunks.size());
+  out.writeRawData(items.constData(), items.size());
+
   file.close();
 
   return true;
 }
+
+bool CQmsProject::readSummary(const QString& filename, summary_t& summary) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream in(&file);
+  setupStream(in);
+
+  quint8 version = 0;
+  QByteArray header;
+  index_t index;
+  if (!readContainer(in, version, header, index)) {
+    return false;
+  }
+
+  getSummary(header, index, summary);
+  return true;
+}
+
+bool CQmsProject::readTrackPoints(const QString& filename, QList<track_points_t>& tracks) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream in(&file);
+  setupStream(in);
+
+  quint8 version = 0;
+  QByteArray header;
+  index_t index;
+  if (!readContainer(in, version, header, index) || (version < 2)) {
+    return false;
+  }
+
+  quint32 size = 0;
+  in >> size;
+
+  for (quint32 sizeChunk : qAsConst(index.sizesChunk)) {
+    if (sizeChunk == 0) {
+      continue;
+    }
+
+    QByteArray chunk(sizeChunk, Qt::Uninitialized);
+    if (in.readRawData(chunk.data(), sizeChunk) != int(sizeChunk)) {
+      qWarning() << "Corrupt point chunk in QMS file";
+      return false;
+    }
+
+    QDataStream stream(qUncompress(chunk));
+    setupStream(stream);
+
+    track_points_t points;
+    stream >> points.segments;
+    stream >> points.lon;
+    stream >> points.lat;
+    stream >> points.ele;
+    stream >> points.time;
+    stream >> points.flags;
+    tracks << points;
+  }
+
+  return true;
+}
@@ -21,9 +21,70 @@
 
 #include "gis/prj/IGisProject.h"
 
+/**
+   @brief A project stored in QMapShack's native format
+
+   There are two formats:
+
+   - The plain project stream as written by IGisProject::operator>>(). This is the default
+     and every version of QMapShack can read it.
+   - An indexed container. Writing it is an option of the workspace setup
+     ("Database/qmsContainer"). QMapShack versions without this class can't read it.
+
+   The container (version 2) holds:
+
+   - the project's header as written by IGisProject::operator>>()
+   - a compressed index of all items, stored column by column: the type, the size
+     of the serialized item, the boundary [rad], the start and end time and the size
+     of the item's point chunk
+   - the point chunks. One compressed chunk per track with the track points stored
+     column by column.
+   - the serialized items, back to back, exactly as IGisProject::operator>>() writes them
+
+   The summary can be read from the header and the index without touching any item.
+   Projects in the workspace defer restoring the items until they are needed. Until
+   then the tooltip shows the item counts and the time span from the index. The
+   points of all tracks can be read from the point chunks without restoring any item.
+
+   Version 1 of the container had no end times and no point chunks. It is still read.
+
+   Migration: Both formats are read regardless of the option. To pass a file to an older
+   version of QMapShack, disable the option and save the project again.
+ */
 class CQmsProject : public IGisProject {
   Q_DECLARE_TR_FUNCTIONS(CQmsProject)
  public:
+  enum format_e {
+    eFormatStream,    ///< the plain project stream
+    eFormatContainer  ///< the indexed container
+  };
+
+  /// the information available without restoring any item
+  struct summary_t {
+    QString name;
+    QMap<IGisItem::type_e, qint32> cntItemsByType;
+    /// the union of all item boundaries in [rad]
+    QRectF boundary;
+    QDateTime timeStart;
+    QDateTime timeEnd;
+  };
+
+  /// the points of a track as stored in the container's point chunk
+  struct track_points_t {
+    /// the number of points of each segment
+    QVector<quint32> segments;
+    /// [deg]
+    QVector<qreal> lon;
+    /// [deg]
+    QVector<qreal> lat;
+    /// [m], NOINT if unknown
+    QVector<qint32> ele;
+    /// [ms] since epoch, the lowest qint64 if unknown
+    QVector<qint64> time;
+    /// CTrackData::trkpt_t::flags
+    QVector<quint32> flags;
+  };
+
   CQmsProject(const QString& filename, CGisListWks* parent);
   virtual ~CQmsProject() = default;
 
@@ -33,7 +94,33 @@ class CQmsProject : public IGisProject {
 
   bool canSave() const override { return true; }
 
+  QString getInfo() const override;
+
+  /// save in the format selected by the workspace setup
   static bool saveAs(const QString& fn, IGisProject& project);
+  static bool saveAs(const QString& fn, IGisProject& project, format_e format);
+
+  /**
+     @brief Read the summary of a file without restoring the items
+
+     @param filename  the file to read
+     @param summary   the summary to fill
+     @return False if the file is not a container. Plain streams have no index.
+   */
+  static bool readSummary(const QString& filename, summary_t& summary);
+
+  /**
+     @brief Read the points of all tracks without restoring the items
+
+     @param filename  the file to read
+     @param tracks    the points of each track in the order of the items in the file
+     @return False if the file has no point chunks, e.g. a plain stream or a version 1 container.
+   */
+  static bool readTrackPoints(const QString& filename, QList<track_points_t>& tracks);
+
+ private:
+  /// the summary from the file's index while the items are deferred
+  summary_t summaryDeferred;
 };
 
 #endif  // CQMSPROJECT_H
@@ -863,6 +863,61 @@ QDataStream& CGisItemOvlArea::operator>>(QDataStream& stream) const {
 }
 
 QDataStream& IGisProject::operator<<(QDataStream& stream) {
+  if (!readHeader(stream)) {
+    return stream;
+  }
+
+  blockUpdateItems(true);
+  readItems(stream);
+  sortItems();
+  blockUpdateItems(false);
+  return stream;
+}
+
+void IGisProject::deferItems(QDataStream& stream) {
+  if (!readHeader(stream)) {
+    return;
+  }
+
+  setDeferredItems(stream.device()->readAll(), QDataStream::Version(stream.version()), stream.byteOrder());
+}
+
+void IGisProject::setDeferredItems(const QByteArray& items, QDataStream::Version version,
+                                   QDataStream::ByteOrder byteOrder) {
+  itemsDeferred = items;
+  itemsDeferredVersion = version;
+  itemsDeferredByteOrder = byteOrder;
+
+  if (!itemsDeferred.isEmpty()) {
+    // the project has to look expandable even without any children
+    setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+  }
+}
+
+void IGisProject::restoreItems() {
+  if (itemsDeferred.isEmpty()) {
+    return;
+  }
+
+  QMutexLocker lock(&IGisItem::mutexItems);
+
+  QByteArray data;
+  data.swap(itemsDeferred);
+
+  QDataStream stream(&data, QIODevice::ReadOnly);
+  stream.setVersion(itemsDeferredVersion);
+  stream.setByteOrder(itemsDeferredByteOrder);
+
+  blockUpdateItems(true);
+  readItems(stream);
+  sortItems();
+  blockUpdateItems(false);
+
+  setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+  setToolTip(CGisListWks::eColumnName, getInfo());
+}
+
+bool IGisProject::readHeader(QDataStream& stream) {
   quint8 version;
   QIODevice* dev = stream.device();
   qint64 pos = dev->pos();
@@ -872,11 +927,9 @@ QDataStream& IGisProject::operator<<(QDataStream& stream) {
 
   if (strncmp(magic, MAGIC_PROJ, MAGIC_SIZE)) {
     dev->seek(pos);
-    return stream;
+    return false;
   }
 
-  blockUpdateItems(true);
-
   stream >> version;
   if (filename.isEmpty()) {
     stream >> filename;
@@ -916,6 +969,10 @@ QDataStream& IGisProject::operator<<(QDataStream& stream) {
     sortingFolder = (sorting_folder_e)tmp;
   }
 
+  return true;
+}
+
+void IGisProject::readItems(QDataStream& stream) {
   while (!stream.atEnd()) {
     QString lastDatabaseHash;
     IGisItem::history_t history;
@@ -962,14 +1019,22 @@ QDataStream& IGisProject::operator<<(QDataStream& stream) {
       }
     }
   }
+}
 
-  sortItems();
+QDataStream& IGisProject::operator>>(QDataStream& stream) const {
+  writeHeader(stream);
+
+  QList<item_snapshot_t> items;
+  getItemSnapshots(items);
+  for (const item_snapshot_t& item : qAsConst(items)) {
+    stream << item;
+  }
+  stream.writeRawData(itemsDeferred.constData(), itemsDeferred.size());
 
-  blockUpdateItems(false);
   return stream;
 }
 
-QDataStream& IGisProject::operator>>(QDataStream& stream) const {
+void IGisProject::writeHeader(QDataStream& stream) const {
   stream.writeRawData(MAGIC_PROJ, MAGIC_SIZE);
   stream << VER_PROJECT;
 
@@ -988,52 +1053,69 @@ QDataStream& IGisProject::operator>>(QDataStream& stream) const {
                   (invalidDataOk ? eFlagInvalidDataOk : 0) |
                   (autoSyncToDev ? eFlagAutoSyncToDev : 0));  // collect trivial flags in one field.
   stream << qint32(sortingFolder);
+}
 
-  for (int i = 0; i < childCount(); i++) {
-    CGisItemTrk* item = dynamic_cast<CGisItemTrk*>(child(i));
-    if (nullptr == item) {
-      continue;
-    }
-    stream << VER_ITEM;
-    stream << quint8(item->type());
-    stream << item->getHistory();
-    stream << quint8(item->data(1, Qt::UserRole).toUInt() & IGisItem::eMarkChanged);
-    stream << item->getLastDatabaseHash();
-  }
-  for (int i = 0; i < childCount(); i++) {
-    CGisItemRte* item = dynamic_cast<CGisItemRte*>(child(i));
-    if (nullptr == item) {
-      continue;
-    }
-    stream << VER_ITEM;
-    stream << quint8(item->type());
-    stream << item->getHistory();
-    stream << quint8(item->data(1, Qt::UserRole).toUInt() & IGisItem::eMarkChanged);
-    stream << item->getLastDatabaseHash();
-  }
-  for (int i = 0; i < childCount(); i++) {
-    CGisItemWpt* item = dynamic_cast<CGisItemWpt*>(child(i));
-    if (nullptr == item) {
-      continue;
-    }
-    stream << VER_ITEM;
-    stream << quint8(item->type());
-    stream << item->getHistory();
-    stream << quint8(item->data(1, Qt::UserRole).toUInt() & IGisItem::eMarkChanged);
-    stream << item->getLastDatabaseHash();
-  }
-  for (int i = 0; i < childCount(); i++) {
-    CGisItemOvlArea* item = dynamic_cast<CGisItemOvlArea*>(child(i));
+static QDateTime getTimeEnd(const IGisItem& item) { return item.getTimestamp(); }
+
+static QDateTime getTimeEnd(const CGisItemTrk& trk) { return trk.getTimeEnd(); }
+
+template <typename T>
+static void appendItemSnapshots(const IGisProject& project, QList<IGisProject::item_snapshot_t>& items) {
+  for (int i = 0; i < project.childCount(); i++) {
+    T* item = dynamic_cast<T*>(project.child(i));
     if (nullptr == item) {
       continue;
     }
-    stream << VER_ITEM;
-    stream << quint8(item->type());
-    stream << item->getHistory();
-    stream << quint8(item->data(1, Qt::UserRole).toUInt() & IGisItem::eMarkChanged);
-    stream << item->getLastDatabaseHash();
+
+    IGisProject::item_snapshot_t snapshot;
+    snapshot.type = quint8(item->type());
+    snapshot.history = item->getHistory();
+    snapshot.changed = quint8(item->data(1, Qt::UserRole).toUInt() & IGisItem::eMarkChanged);
+    snapshot.lastDatabaseHash = item->getLastDatabaseHash();
+    snapshot.boundary = item->getBoundingRect();
+    snapshot.timestamp = item->getTimestamp();
+    snapshot.timeEnd = getTimeEnd(*item);
+    items << snapshot;
   }
+}
+
+void IGisProject::getItemSnapshots(QList<item_snapshot_t>& items) const {
+  // the items are grouped by type
+  appendItemSnapshots<CGisItemTrk>(*this, items);
+  appendItemSnapshots<CGisItemRte>(*this, items);
+  appendItemSnapshots<CGisItemWpt>(*this, items);
+  appendItemSnapshots<CGisItemOvlArea>(*this, items);
+}
 
+void IGisProject::getSnapshot(snapshot_t& snapshot, QDataStream::Version version,
+                              QDataStream::ByteOrder byteOrder) const {
+  snapshot.header.clear();
+  snapshot.items.clear();
+
+  QDataStream stream(&snapshot.header, QIODevice::WriteOnly);
+  stream.setVersion(version);
+  stream.setByteOrder(byteOrder);
+  writeHeader(stream);
+
+  getItemSnapshots(snapshot.items);
+  snapshot.itemsDeferred = itemsDeferred;
+}
+
+QDataStream& operator<<(QDataStream& stream, const IGisProject::item_snapshot_t& item) {
+  stream << VER_ITEM;
+  stream << item.type;
+  stream << item.history;
+  stream << item.changed;
+  stream << item.lastDatabaseHash;
+  return stream;
+}
+
+QDataStream& operator<<(QDataStream& stream, const IGisProject::snapshot_t& snapshot) {
+  stream.writeRawData(snapshot.header.constData(), snapshot.header.size());
+  for (const IGisProject::item_snapshot_t& item : snapshot.items) {
+    stream << item;
+  }
+  stream.writeRawData(snapshot.itemsDeferred.constData(), snapshot.itemsDeferred.size());
   return stream;
 }
 
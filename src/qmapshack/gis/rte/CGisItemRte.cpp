@@ -34,6 +34,7 @@
 #include "gis/rte/CScrOptRte.h"
 #include "gis/trk/CGisItemTrk.h"
 #include "helpers/CDraw.h"
+#include "helpers/COccupancyGrid.h"
 #include "helpers/CWptIconManager.h"
 #include "units/IUnit.h"
 
@@ -126,7 +127,9 @@ CGisItemRte::CGisItemRte(CFitStream& stream, IGisProject* project)
 
 CGisItemRte::~CGisItemRte() {
   // reset user focus if focused on this track
-  if (key == keyUserFocus) {
+  // The focus is owned by the main thread. Items deleted by worker threads (e.g. projects loaded
+  // by IDevice::loadProjects()) never have it and must not touch it.
+  if ((QThread::currentThread() == qApp->thread()) && (key == keyUserFocus)) {
     keyUserFocus.clear();
   }
 }
@@ -435,6 +438,12 @@ bool CGisItemRte::isCloseTo(const QPointF& pos) {
   return dist < 20;
 }
 
+QRectF CGisItemRte::getScreenArea() const {
+  QMutexLocker lock(&mutexItems);
+
+  return line.isEmpty() ? QRectF() : line.boundingRect().adjusted(-20, -20, 20, 20);
+}
+
 bool CGisItemRte::isWithin(const QRectF& area, selflags_t flags) {
   QPolygonF l;
   getPolylineDegFromData(l);
@@ -449,7 +458,7 @@ void CGisItemRte::looseUserFocus() {
   }
 }
 
-void CGisItemRte::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) {
+void CGisItemRte::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) {
   QMutexLocker lock(&mutexItems);
 
   line.clear();
@@ -477,7 +486,7 @@ void CGisItemRte::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>
     icons << rtept.icon;
     focus << rtept.focus;
 
-    blockedAreas << QRectF(pt - rtept.focus, rtept.icon.size());
+    blockedAreas.insert(QRectF(pt - rtept.focus, rtept.icon.size()));
     for (const subpt_t& subpt : rtept.subpts) {
       QPointF pt(subpt.lon * DEG_TO_RAD, subpt.lat * DEG_TO_RAD);
       gis->convertRad2Px(pt);
@@ -581,7 +590,7 @@ void CGisItemRte::drawItem(QPainter& p, const QRectF& /*viewport*/, CGisDraw* gi
   }
 }
 
-void CGisItemRte::drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas,
+void CGisItemRte::drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas,
                             const QFontMetricsF& fm, CGisDraw* gis) {
   QMutexLocker lock(&mutexItems);
   if (!isVisible(boundingRect, viewport, gis)) {
@@ -618,7 +627,7 @@ void CGisItemRte::drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF
     }
 
     CDraw::text(rtept.name, p, rect.toRect(), Qt::darkBlue);
-    blockedAreas << rect;
+    blockedAreas.insert(rect);
   }
 }
 
@@ -112,13 +112,14 @@ class CGisItemRte : public IGisItem, public IGisLine {
   QString getInfo(quint32 feature) const override;
   IScrOpt* getScreenOptions(const QPoint& origin, IMouse* mouse) override;
   QPointF getPointCloseBy(const QPoint& screenPos) override;
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) override;
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) override;
   void drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) override;
-  void drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  void drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                  CGisDraw* gis) override;
   void drawHighlight(QPainter& p) override;
   void save(QDomNode& gpx, bool strictGpx11) override;
   bool isCloseTo(const QPointF& pos) override;
+  QRectF getScreenArea() const override;
   bool isWithin(const QRectF& area, selflags_t flags) override;
   /**
      @brief Switch user focus on and off.
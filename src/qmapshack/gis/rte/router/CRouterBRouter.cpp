@@ -192,6 +192,35 @@ QString CRouterBRouter::getOptions() {
                      .arg(comboAlternative->currentData().toInt() + 1));
 }
 
+QString CRouterBRouter::getCacheKey() {
+  // results of the online service can change at any time
+  if (setup->installMode != CRouterBRouterSetup::eModeLocal || comboProfile->count() == 0) {
+    return "";
+  }
+
+  const QDir dir(setup->localDir);
+  const QDir profileDir(dir.absoluteFilePath(setup->localProfileDir));
+  const QFileInfo profile(profileDir.absoluteFilePath(comboProfile->currentData().toString() + ".brf"));
+
+  // the segment files are identified by name, size and time stamp
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  const QDir segmentsDir(dir.absoluteFilePath(setup->localSegmentsDir));
+  const QFileInfoList& segments = segmentsDir.entryInfoList(QStringList("*.rd5"), QDir::Files, QDir::Name);
+  for (const QFileInfo& segment : segments) {
+    hash.addData(QString("%1|%2|%3;")
+                     .arg(segment.fileName())
+                     .arg(segment.size())
+                     .arg(segment.lastModified().toMSecsSinceEpoch())
+                     .toUtf8());
+  }
+
+  return QString("brouter|%1|%2|%3|%4")
+      .arg(profile.absoluteFilePath())
+      .arg(profile.lastModified().toMSecsSinceEpoch())
+      .arg(comboAlternative->currentData().toString())
+      .arg(QString(hash.result().toHex()));
+}
+
 void CRouterBRouter::routerSelected() { getBRouterVersion(); }
 
 bool CRouterBRouter::hasFastRouting() {
@@ -295,6 +324,57 @@ int CRouterBRouter::calcRoute(const QPointF& p1, const QPointF& p2, QPolygonF& c
   return synchronousRequest(points, nogos, coords, costs);
 }
 
+quint32 CRouterBRouter::calcRouteAsync(const QPointF& p1, const QPointF& p2) {
+  if (!hasFastRouting()) {
+    return 0;
+  }
+
+  if (setup->installMode == CRouterBRouterSetup::eModeLocal && localBRouter->isBRouterNotRunning()) {
+    localBRouter->startBRouter();
+  }
+
+  const QVector<QPointF> points = {p1 * RAD_TO_DEG, p2 * RAD_TO_DEG};
+
+  QList<IGisItem*> nogos;
+  CGisWorkspace::self().getNogoAreas(nogos);
+
+  const quint32 id = getNextRouteId();
+  QNetworkReply* reply = networkAccessManager->get(getRequest(points, nogos));
+  // the reply is handled below and not by slotRequestFinished()
+  reply->setProperty("async", true);
+  repliesAsync[id] = reply;
+
+  const int cntNogos = nogos.size();
+  connect(reply, &QNetworkReply::finished, this, [this, id, reply, cntNogos]() {
+    repliesAsync.remove(id);
+
+    QPolygonF coords;
+    QString error;
+    try {
+      if (reply->error() != QNetworkReply::OperationCanceledError) {
+        parseReply(reply, cntNogos, coords, nullptr);
+      }
+    } catch (const QString& msg) {
+      coords.clear();
+      if (!msg.isEmpty()) {
+        error = tr("Bad response from server: %1").arg(msg);
+      }
+    }
+
+    reply->deleteLater();
+    emit sigRouteFinished(id, coords, error);
+  });
+
+  return id;
+}
+
+void CRouterBRouter::abortRouteAsync(quint32 id) {
+  QNetworkReply* reply = repliesAsync.value(id, nullptr);
+  if (reply != nullptr) {
+    reply->abort();
+  }
+}
+
 int CRouterBRouter::synchronousRequest(const QVector<QPointF>& points, const QList<IGisItem*>& nogos, QPolygonF& coords,
                                        qreal* costs = nullptr) {
   if (!mutex.tryLock()) {
@@ -321,64 +401,7 @@ int CRouterBRouter::synchronousRequest(const QVector<QPointF>& points, const QLi
     connect(reply, &QNetworkReply::finished, &eventLoop, &QEventLoop::quit);
     eventLoop.exec(QEventLoop::AllEvents);
 
-    const QNetworkReply::NetworkError& netErr = reply->error();
-    if (netErr == QNetworkReply::RemoteHostClosedError && nogos.size() > 1 && !isMinimumVersion(1, 4, 10)) {
-      throw tr("this version of BRouter does not support more then 1 nogo-area");
-    } else if (netErr != QNetworkReply::NoError) {
-      throw reply->errorString();
-    }
-    slotClearError();
-
-    const QByteArray& res = reply->readAll();
-
-    if (res.isEmpty()) {
-      throw tr("response is empty");
-    }
-
-    QDomDocument xml;
-    xml.setContent(res);
-    const QDomElement& xmlGpx = xml.documentElement();
-
-    if (xmlGpx.isNull() || xmlGpx.tagName() != "gpx") {
-      throw QString(res);
-    }
-    setup->parseBRouterVersion(xmlGpx.attribute("creator"));
-
-    // read the shape
-    const QDomNodeList& xmlLatLng =
-        xmlGpx.firstChildElement("trk").firstChildElement("trkseg").elementsByTagName("trkpt");
-    for (int n = 0; n < xmlLatLng.size(); n++) {
-      const QDomElement& elem = xmlLatLng.item(n).toElement();
-      coords << QPointF();
-      QPointF& point = coords.last();
-      point.setX(elem.attribute("lon").toFloat() * DEG_TO_RAD);
-      point.setY(elem.attribute("lat").toFloat() * DEG_TO_RAD);
-    }
-
-    // find costs of route (copied and adapted from CGisItemRte::setResultFromBrouter)
-    if (costs != nullptr) {
-      const QDomNodeList& nodes = xml.childNodes();
-      for (int i = 0; i < nodes.count(); i++) {
-        const QDomNode& node = nodes.at(i);
-        if (!node.isComment()) {
-          continue;
-        }
-        const QString& commentTxt = node.toComment().data();
-        // ' track-length = 180864 filtered ascend = 428 plain-ascend = -172 cost=270249 '
-        const QRegExp rxAscDes(
-            "(\\s*track-length\\s*=\\s*)(-?\\d+)(\\s*)(filtered "
-            "ascend\\s*=\\s*-?\\d+)(\\s*)(plain-ascend\\s*=\\s*-?\\d+)(\\s*)(cost\\s*=\\s*)(-?\\d+)(\\s*)");
-        int pos = rxAscDes.indexIn(commentTxt);
-        if (pos > -1) {
-          bool ok;
-          *costs = rxAscDes.cap(9).toDouble(&ok);
-          if (!ok) {
-            *costs = -1;
-          }
-        }
-        break;
-      }
-    }
+    parseReply(reply, nogos.size(), coords, costs);
   } catch (const QString& msg) {
     coords.clear();
     if (!msg.isEmpty()) {
@@ -394,6 +417,67 @@ int CRouterBRouter::synchronousRequest(const QVector<QPointF>& points, const QLi
   return coords.size();
 }
 
+void CRouterBRouter::parseReply(QNetworkReply* reply, int nogos, QPolygonF& coords, qreal* costs) {
+  const QNetworkReply::NetworkError& netErr = reply->error();
+  if (netErr == QNetworkReply::RemoteHostClosedError && nogos > 1 && !isMinimumVersion(1, 4, 10)) {
+    throw tr("this version of BRouter does not support more then 1 nogo-area");
+  } else if (netErr != QNetworkReply::NoError) {
+    throw reply->errorString();
+  }
+  slotClearError();
+
+  const QByteArray& res = reply->readAll();
+
+  if (res.isEmpty()) {
+    throw tr("response is empty");
+  }
+
+  QDomDocument xml;
+  xml.setContent(res);
+  const QDomElement& xmlGpx = xml.documentElement();
+
+  if (xmlGpx.isNull() || xmlGpx.tagName() != "gpx") {
+    throw QString(res);
+  }
+  setup->parseBRouterVersion(xmlGpx.attribute("creator"));
+
+  // read the shape
+  const QDomNodeList& xmlLatLng =
+      xmlGpx.firstChildElement("trk").firstChildElement("trkseg").elementsByTagName("trkpt");
+  for (int n = 0; n < xmlLatLng.size(); n++) {
+    const QDomElement& elem = xmlLatLng.item(n).toElement();
+    coords << QPointF();
+    QPointF& point = coords.last();
+    point.setX(elem.attribute("lon").toFloat() * DEG_TO_RAD);
+    point.setY(elem.attribute("lat").toFloat() * DEG_TO_RAD);
+  }
+
+  // find costs of route (copied and adapted from CGisItemRte::setResultFromBrouter)
+  if (costs != nullptr) {
+    const QDomNodeList& nodes = xml.childNodes();
+    for (int i = 0; i < nodes.count(); i++) {
+      const QDomNode& node = nodes.at(i);
+      if (!node.isComment()) {
+        continue;
+      }
+      const QString& commentTxt = node.toComment().data();
+      // ' track-length = 180864 filtered ascend = 428 plain-ascend = -172 cost=270249 '
+      const QRegExp rxAscDes(
+          "(\\s*track-length\\s*=\\s*)(-?\\d+)(\\s*)(filtered "
+          "ascend\\s*=\\s*-?\\d+)(\\s*)(plain-ascend\\s*=\\s*-?\\d+)(\\s*)(cost\\s*=\\s*)(-?\\d+)(\\s*)");
+      int pos = rxAscDes.indexIn(commentTxt);
+      if (pos > -1) {
+        bool ok;
+        *costs = rxAscDes.cap(9).toDouble(&ok);
+        if (!ok) {
+          *costs = -1;
+        }
+      }
+      break;
+    }
+  }
+}
+
 void CRouterBRouter::calcRoute(const IGisItem::key_t& key) {
   mutex.lock();
   if (setup->installMode == CRouterBRouterSetup::eModeLocal && localBRouter->isBRouterNotRunning()) {
@@ -439,7 +523,7 @@ void CRouterBRouter::calcRoute(const IGisItem::key_t& key) {
 }
 
 void CRouterBRouter::slotRequestFinished(QNetworkReply* reply) {
-  if (synchronous) {
+  if (synchronous || reply->property("async").toBool()) {
     return;
   }
 
@@ -46,6 +46,9 @@ class CRouterBRouter : public IRouter, private Ui::IRouterBRouter {
   int calcRoute(const QPointF& p1, const QPointF& p2, QPolygonF& coords, qreal* costs = nullptr) override;
   bool hasFastRouting() override;
   QString getOptions() override;
+  QString getCacheKey() override;
+  quint32 calcRouteAsync(const QPointF& p1, const QPointF& p2) override;
+  void abortRouteAsync(quint32 id) override;
   void routerSelected() override;
 
   void setupLocalDir(QString localDir);
@@ -71,6 +74,8 @@ class CRouterBRouter : public IRouter, private Ui::IRouterBRouter {
   void updateBRouterStatus() const;
   int synchronousRequest(const QVector<QPointF>& points, const QList<IGisItem*>& nogos, QPolygonF& coords,
                          qreal* costs);
+  /// parse the GPX of a route request, throws a QString on error
+  void parseReply(QNetworkReply* reply, int nogos, QPolygonF& coords, qreal* costs);
   QNetworkRequest getRequest(const QVector<QPointF>& routePoints, const QList<IGisItem*>& nogos) const;
   QUrl getServiceUrl() const;
 
@@ -79,6 +84,8 @@ class CRouterBRouter : public IRouter, private Ui::IRouterBRouter {
   QNetworkAccessManager* networkAccessManager;
   QTimer* timerCloseStatusMsg;
   bool synchronous = false;
+  /// the replies of asynchronous requests by id
+  QHash<quint32, QNetworkReply*> repliesAsync;
   QMutex mutex;
   CRouterBRouterSetup* setup;
   CRouterSetup* routerSetup;
@@ -18,12 +18,35 @@
 
 #include "CRouterOptimization.h"
 
+#include <QtCore>
+#include <algorithm>
+
 #include "gis/GeoMath.h"
 #include "gis/rte/router/CRouterSetup.h"
 #include "helpers/CProgressDialog.h"
+#include "setup/IAppSetup.h"
+
+// coordinates in [rad] are rounded to this precision, roughly 0.6 m
+#define KEY_PRECISION 1e-7
+#define CACHE_MAGIC "QMSRouteCache"
+#define CACHE_VERSION 2
+// maximum number of routes kept in the cache
+#define CACHE_MAX_ROUTES 20000
+// routes not used for this time [ms] are dropped when loading the cache (90 days)
+#define CACHE_MAX_AGE (90LL * 24 * 3600 * 1000)
+// a route's time of use is only stored again if it is older than this [ms] (1 day)
+#define CACHE_TOUCH_INTERVAL (24LL * 3600 * 1000)
+
+CRouterOptimization::route_key_t::route_key_t(const QPointF& from, const QPointF& to)
+    : x1(qRound(from.x() / KEY_PRECISION)),
+      y1(qRound(from.y() / KEY_PRECISION)),
+      x2(qRound(to.x() / KEY_PRECISION)),
+      y2(qRound(to.y() / KEY_PRECISION)) {}
 
 CRouterOptimization::CRouterOptimization() { routerOptions = CRouterSetup::self().getOptions(); }
 
+CRouterOptimization::~CRouterOptimization() { saveCache(); }
+
 int CRouterOptimization::optimize(SGisLine& line) {
   checkRouter();
   if (!CRouterSetup::self().hasFastRouting()) {
@@ -75,6 +98,7 @@ int CRouterOptimization::optimize(SGisLine& line) {
   while (numOfRestarts < line.length()) {
     progress.setValue(numOfRestarts + 2);
     if (progress.wasCanceled()) {
+      saveCache();
       return -1;
     }
 
@@ -108,7 +132,9 @@ int CRouterOptimization::optimize(SGisLine& line) {
 
   // Do this a last time, since it happens that the route is already optimal.
   // Return the return value as this is the last point the code may fail for some odd reason
-  return fillSubPts(line);
+  int res = fillSubPts(line);
+  saveCache();
+  return res;
 }
 
 qreal CRouterOptimization::createNextBestOrder(const SGisLine& oldOrder, SGisLine& newOrder) {
@@ -204,16 +230,9 @@ qreal CRouterOptimization::getRealRouteCosts(const SGisLine& line, qreal costCut
 }
 
 qreal CRouterOptimization::bestKnownDistance(const IGisLine::point_t& start, const IGisLine::point_t& end) {
-  // 10 digits after the decimal point in exponential format should be by far enough
-  QString start_key = QString::number(start.coord.x(), 'e', 10) + QString::number(start.coord.y(), 'e', 10);
-  QString end_key = QString::number(end.coord.x(), 'e', 10) + QString::number(end.coord.y(), 'e', 10);
-
-  if (!routingCache.contains(start_key)) {
-    routingCache[start_key] = {};
-  }
-
-  if (routingCache[start_key].contains(end_key)) {
-    return routingCache[start_key][end_key].costs;
+  const auto& item = routingCache.constFind(route_key_t(start.coord, end.coord));
+  if (item != routingCache.constEnd()) {
+    return item->costs;
   } else {
     // Multiply it with the average of the minimum occuring factor and the average factor
     //  to get a reasonable compromise of optimization speed and optimality of results
@@ -228,29 +247,45 @@ qreal CRouterOptimization::bestKnownDistance(const IGisLine::point_t& start, con
 
 const CRouterOptimization::routing_cache_item_t* CRouterOptimization::getRoute(const QPointF& start,
                                                                                const QPointF& end) {
-  QString start_key = QString::number(start.x(), 'e', 10) + QString::number(start.y(), 'e', 10);
-  QString end_key = QString::number(end.x(), 'e', 10) + QString::number(end.y(), 'e', 10);
-
-  if (!routingCache.contains(start_key)) {
-    routingCache[start_key] = {};
-  }
+  const route_key_t key(start, end);
 
-  if (!routingCache[start_key].contains(end_key)) {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  auto item = routingCache.find(key);
+  if (item == routingCache.end()) {
     routing_cache_item_t cacheItem;
     int response = CRouterSetup::self().calcRoute(start, end, cacheItem.route, &cacheItem.costs);
     if (response < 0) {
       return nullptr;
     }
-    routingCache[start_key][end_key] = cacheItem;
+    cacheItem.lastUsed = now;
+    item = routingCache.insert(key, cacheItem);
+    cacheChanged = true;
 
-    qreal airToCostFactor = cacheItem.costs / GPS_Math_DistanceQuick(start.x(), start.y(), end.x(), end.y());
-    if (airToCostFactor < minAirToCostFactor || minAirToCostFactor < 0) {
-      minAirToCostFactor = airToCostFactor;
+    addAirToCostFactor(key, cacheItem.costs);
+  } else {
+    // Do not rewrite the cache file just because a route has been used again.
+    // Only if the stored time is outdated enough to matter for the eviction.
+    if (now - item->lastUsed > CACHE_TOUCH_INTERVAL) {
+      cacheChanged = true;
     }
-    totalAirToCosts += airToCostFactor;
-    totalNumOfRoutes++;
+    item->lastUsed = now;
+  }
+  return &item.value();
+}
+
+void CRouterOptimization::addAirToCostFactor(const route_key_t& key, qreal costs) {
+  const qreal distance = GPS_Math_DistanceQuick(key.x1 * KEY_PRECISION, key.y1 * KEY_PRECISION,
+                                                key.x2 * KEY_PRECISION, key.y2 * KEY_PRECISION);
+  if (distance <= 0) {
+    return;
+  }
+
+  qreal airToCostFactor = costs / distance;
+  if (airToCostFactor < minAirToCostFactor || minAirToCostFactor < 0) {
+    minAirToCostFactor = airToCostFactor;
   }
-  return &routingCache[start_key][end_key];
+  totalAirToCosts += airToCostFactor;
+  totalNumOfRoutes++;
 }
 
 int CRouterOptimization::fillSubPts(SGisLine& line) {
@@ -269,8 +304,133 @@ int CRouterOptimization::fillSubPts(SGisLine& line) {
 
 void CRouterOptimization::checkRouter() {
   const QString& options = CRouterSetup::self().getOptions();
-  if (routerOptions != options) {
+  const QString& cacheKey = CRouterSetup::self().getCacheKey();
+  if (routerOptions != options || routerCacheKey != cacheKey) {
+    saveCache();
+
     routingCache.clear();
+    minAirToCostFactor = -1;
+    totalAirToCosts = 0;
+    totalNumOfRoutes = 0;
+
     routerOptions = options;
+    routerCacheKey = cacheKey;
+    loadCache();
+  }
+}
+
+QString CRouterOptimization::getCacheFilename() const {
+  const QString& name = QCryptographicHash::hash(routerCacheKey.toUtf8(), QCryptographicHash::Md5).toHex();
+  const QDir dir(IAppSetup::getPlatformInstance()->defaultCachePath());
+  return dir.absoluteFilePath("RouterOptimization/" + name + ".cache");
+}
+
+void CRouterOptimization::loadCache() {
+  cacheChanged = false;
+  if (routerCacheKey.isEmpty()) {
+    return;
+  }
+
+  QFile file(getCacheFilename());
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  QDataStream stream(&file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream.setVersion(QDataStream::Qt_5_2);
+
+  QByteArray magic;
+  qint32 version = 0;
+  QString cacheKey;
+  quint32 count = 0;
+  stream >> magic >> version >> cacheKey >> count;
+  // the key is stored, too, to detect hash collisions of the filename
+  if (magic != CACHE_MAGIC || version != CACHE_VERSION || cacheKey != routerCacheKey) {
+    return;
+  }
+
+  const qint64 oldest = QDateTime::currentMSecsSinceEpoch() - CACHE_MAX_AGE;
+  routingCache.reserve(count);
+  for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+    route_key_t key;
+    routing_cache_item_t item;
+    stream >> key.x1 >> key.y1 >> key.x2 >> key.y2 >> item.costs >> item.lastUsed >> item.route;
+    if (stream.status() != QDataStream::Ok) {
+      break;
+    }
+    if (item.lastUsed < oldest) {
+      // the route has not been used for a long time, drop it with the next save
+      cacheChanged = true;
+      continue;
+    }
+    routingCache[key] = item;
+    addAirToCostFactor(key, item.costs);
+  }
+}
+
+void CRouterOptimization::saveCache() {
+  if (!cacheChanged || routerCacheKey.isEmpty()) {
+    return;
+  }
+
+  evictRoutes();
+
+  const QString& filename = getCacheFilename();
+  QDir().mkpath(QFileInfo(filename).absolutePath());
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Failed to write routing cache" << filename;
+    return;
+  }
+
+  QDataStream stream(&file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  stream.setVersion(QDataStream::Qt_5_2);
+
+  stream << QByteArray(CACHE_MAGIC) << qint32(CACHE_VERSION) << routerCacheKey << quint32(routingCache.count());
+  for (auto item = routingCache.constBegin(); item != routingCache.constEnd(); ++item) {
+    const route_key_t& key = item.key();
+    stream << key.x1 << key.y1 << key.x2 << key.y2 << item->costs << item->lastUsed << item->route;
+  }
+
+  if (file.commit()) {
+    cacheChanged = false;
+  }
+}
+
+void CRouterOptimization::evictRoutes() {
+  const int excess = routingCache.count() - CACHE_MAX_ROUTES;
+  if (excess <= 0) {
+    return;
+  }
+
+  // find the time of use that separates the routes to drop from the ones to keep
+  QVector<qint64> times;
+  times.reserve(routingCache.count());
+  for (const routing_cache_item_t& item : qAsConst(routingCache)) {
+    times << item.lastUsed;
+  }
+  std::nth_element(times.begin(), times.begin() + excess, times.end());
+  const qint64 limit = times[excess];
+
+  // drop all routes used before the limit and as many as needed of the ones used at the limit
+  int toRemove = excess;
+  for (auto item = routingCache.begin(); item != routingCache.end() && toRemove > 0;) {
+    if (item->lastUsed < limit) {
+      item = routingCache.erase(item);
+      toRemove--;
+    } else {
+      ++item;
+    }
+  }
+  for (auto item = routingCache.begin(); item != routingCache.end() && toRemove > 0;) {
+    if (item->lastUsed == limit) {
+      item = routingCache.erase(item);
+      toRemove--;
+    } else {
+      ++item;
+    }
   }
 }
@@ -21,19 +21,42 @@
 #include <gis/IGisLine.h>
 
 #include <QCoreApplication>
-#include <QMap>
+#include <QHash>
 #include <QPolygonF>
 
 class CRouterOptimization {
   Q_DECLARE_TR_FUNCTIONS(CRouterOptimization)
  public:
   CRouterOptimization();
+  virtual ~CRouterOptimization();
   int optimize(SGisLine& line);
 
+  /**
+     @brief Key of a route in the routing cache
+
+     The coordinates are rounded to a fixed precision. Thus points that differ by
+     floating point noise only share the same route.
+   */
+  struct route_key_t {
+    route_key_t() = default;
+    route_key_t(const QPointF& from, const QPointF& to);
+
+    bool operator==(const route_key_t& other) const {
+      return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2;
+    }
+
+    qint32 x1 = 0;
+    qint32 y1 = 0;
+    qint32 x2 = 0;
+    qint32 y2 = 0;
+  };
+
  private:
   struct routing_cache_item_t {
     QPolygonF route;
     qreal costs;
+    /// time of the last use in [ms] since epoch, used to evict routes from the cache
+    qint64 lastUsed = 0;
   };
 
   /// returns value by which the costs were changed
@@ -42,16 +65,39 @@ class CRouterOptimization {
 
   qreal getRealRouteCosts(const SGisLine& line, qreal costCutoff = -1);
   qreal bestKnownDistance(const IGisLine::point_t& start, const IGisLine::point_t& end);
+  /**
+     @brief Get the route between two points from the cache or calculate it
+
+     @note The pointer is valid until the next route is added to the cache.
+
+     @return A pointer to the cached route or nullptr if the routing failed.
+   */
   const routing_cache_item_t* getRoute(const QPointF& from, const QPointF& to);
   int fillSubPts(SGisLine& line);
+  void addAirToCostFactor(const route_key_t& key, qreal costs);
   /// checks if router settings were changed and if yes, discards the routingCache
   void checkRouter();
 
-  QMap<QString, QMap<QString, routing_cache_item_t> > routingCache;
+  /// the file the routing cache is stored to for the current router key
+  QString getCacheFilename() const;
+  void loadCache();
+  void saveCache();
+  /// drop the least recently used routes if the cache exceeds its maximum size
+  void evictRoutes();
+
+  QHash<route_key_t, routing_cache_item_t> routingCache;
   qreal minAirToCostFactor = -1;
   qreal totalAirToCosts = 0;
   qreal totalNumOfRoutes = 0;
   QString routerOptions = "";
+  /// the key of the router's data, empty if the routes must not be stored
+  QString routerCacheKey = "";
+  /// true if routes were added since the cache was loaded or stored
+  bool cacheChanged = false;
 };
 
+inline uint qHash(const CRouterOptimization::route_key_t& key, uint seed = 0) {
+  return qHash(qMakePair(qMakePair(key.x1, key.y1), qMakePair(key.x2, key.y2)), seed);
+}
+
 #endif  // CROUTEROPTIMIZATION_H
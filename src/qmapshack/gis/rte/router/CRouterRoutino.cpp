@@ -32,6 +32,12 @@
 #include "helpers/CSettings.h"
 #include "setup/IAppSetup.h"
 
+// coordinates in [rad] are rounded to this precision for the cache keys, roughly 0.6 m
+#define COORD_PRECISION 1e-7
+#define MAX_CACHED_WAYPOINTS 2000
+// the leg cache's size is counted in route points
+#define MAX_CACHED_LEG_POINTS 500000
+
 QPointer<CProgressDialog> CRouterRoutino::progress;
 
 int ProgressFunc(double complete) {
@@ -50,6 +56,12 @@ CRouterRoutino::CRouterRoutino(QWidget* parent) : IRouter(true, parent) {
   pSelf = this;
   setupUi(this);
 
+  // Routino is not reentrant. Asynchronous requests are calculated one by one.
+  threadPool.setMaxThreadCount(1);
+
+  cacheWaypoints.setMaxCost(MAX_CACHED_WAYPOINTS);
+  cacheLegs.setMaxCost(MAX_CACHED_LEG_POINTS);
+
   connect(labelHelp, &QLabel::linkActivated, &CMainWindow::self(),
           static_cast<void (CMainWindow::*)(const QString&)>(&CMainWindow::slotLinkActivated));
 
@@ -113,6 +125,7 @@ CRouterRoutino::~CRouterRoutino() {
   cfg.setValue("Route/routino/mode", comboMode->currentIndex());
   cfg.setValue("Route/routino/database", comboDatabase->currentIndex());
 
+  waitForAsyncRouting();
   freeDatabaseList();
   Routino_FreeXMLProfiles();
   Routino_FreeXMLTranslations();
@@ -193,6 +206,26 @@ QString CRouterRoutino::getOptions() {
   return str;
 }
 
+QString CRouterRoutino::getCacheKey() {
+  if (comboDatabase->count() == 0) {
+    return "";
+  }
+
+  // the database files are identified by path, size and time stamp of the segments file
+  const QVariantMap& dmap = comboDatabase->currentData(Qt::UserRole).toMap();
+  const QFileInfo segments(dmap["segments"].toString());
+  const QFileInfo profiles(dmap["profilesPath"].toString());
+
+  return QString("routino|%1|%2|%3|%4|%5|%6|%7")
+      .arg(segments.absoluteFilePath())
+      .arg(segments.size())
+      .arg(segments.lastModified().toMSecsSinceEpoch())
+      .arg(profiles.absoluteFilePath())
+      .arg(profiles.lastModified().toMSecsSinceEpoch())
+      .arg(comboProfile->currentData(Qt::UserRole).toString())
+      .arg(comboMode->currentIndex());
+}
+
 void CRouterRoutino::setupPath(const QString& path) {
   if (dbPaths.contains(path)) {
     return;
@@ -213,6 +246,8 @@ void CRouterRoutino::slotSetupPaths() {
 
 void CRouterRoutino::buildDatabaseList() {
   QRegExp re("(.*)-segments.mem");
+  // the databases are about to be unloaded
+  waitForAsyncRouting();
   freeDatabaseList();
 
   // initialise
@@ -248,6 +283,7 @@ void CRouterRoutino::buildDatabaseList() {
       /* determine the profile to use for each database*/
       QVariantMap dmap;
       dmap["db"] = QVariant((qulonglong)data);
+      dmap["segments"] = dir.absoluteFilePath(filename);
 
       /* check possible profiles.xml locations and use the first available */
       int pError = 0;
@@ -299,6 +335,8 @@ void CRouterRoutino::freeDatabaseList() {
     Routino_UnloadDatabase(data);
   }
   comboDatabase->clear();
+  // the cached waypoints refer to the unloaded databases
+  clearCache();
 }
 
 int CRouterRoutino::loadProfiles(const QString& profilesPath) {
@@ -318,7 +356,7 @@ void CRouterRoutino::updateHelpText() {
 }
 
 void CRouterRoutino::calcRoute(const IGisItem::key_t& key) {
-  if (!mutex.tryLock()) {
+  if (!lockFromGui()) {
     return;
   }
 
@@ -331,165 +369,316 @@ void CRouterRoutino::calcRoute(const IGisItem::key_t& key) {
       throw QString();
     }
 
-    QVariantMap map = comboDatabase->currentData(Qt::UserRole).toMap();
-    Routino_Database* data = (Routino_Database*)(map["db"].toULongLong());
-    if (nullptr == data) {
+    request_t request;
+    if (!getRequest(request)) {
       throw QString();
     }
 
-    loadProfiles(map["profilesPath"].toString());
+    routing_t routing;
+    setupRouting(request, routing);
 
     rte->reset();
 
-    QString strProfile = comboProfile->currentData(Qt::UserRole).toString();
-    QString strLanguage = comboLanguage->currentData(Qt::UserRole).toString();
-
-    Routino_Profile* profile = Routino_GetProfile(strProfile.toUtf8());
-    if (profile == NULL) {
-      throw tr("Required profile '%1' is not in the current profiles file.").arg(strProfile);
-    }
-    Routino_Translation* translation = Routino_GetTranslation(strLanguage.toUtf8());
-
-    int res = Routino_ValidateProfile(data, profile);
-    if (res != 0) {
-      throw xlateRoutinoError(Routino_errno);
-    }
-
-    int options = ROUTINO_ROUTE_LIST_HTML_ALL;
-    if (comboMode->currentIndex() == 0) {
-      options |= ROUTINO_ROUTE_SHORTEST;
-    }
-    if (comboMode->currentIndex() == 1) {
-      options |= ROUTINO_ROUTE_QUICKEST;
-    }
-
     SGisLine line;
     rte->getPolylineFromData(line);
 
-    int idx = 0;
-    QVector<Routino_Waypoint*> waypoints(line.size(), nullptr);
-    for (const IGisLine::point_t& pt : qAsConst(line)) {
-      waypoints[idx] = Routino_FindWaypoint(data, profile, pt.coord.y() * RAD_TO_DEG, pt.coord.x() * RAD_TO_DEG);
-      if (waypoints[idx] == nullptr) {
-        throw xlateRoutinoError(Routino_errno);
-      }
-      idx++;
-    }
-
+    // Route leg by leg. Legs not changed since the last request are taken from the cache.
     progress = new CProgressDialog(tr("Calculate route with %1").arg(getOptions()), 0, NOINT, this);
 
-    Routino_Output* route =
-        Routino_CalculateRoute(data, profile, translation, waypoints.data(), waypoints.size(), options, ProgressFunc);
+    QVector<leg_t> legs;
+    for (int i = 0; i < line.size() - 1; i++) {
+      if (!progress.isNull() && progress->wasCanceled()) {
+        throw QString();
+      }
+      legs << calcLeg(request, routing, line[i].coord, line[i + 1].coord, ProgressFunc);
+    }
 
     delete progress;
 
-    if (nullptr != route) {
-      rte->setResult(route, getOptions() + tr("<br/>Calculation time: %1s").arg(time.elapsed() / 1000.0, 0, 'f', 2));
-      Routino_DeleteRoute(route);
-    } else {
-      if (Routino_errno != ROUTINO_ERROR_PROGRESS_ABORTED) {
-        throw xlateRoutinoError(Routino_errno);
-      }
+    if (!legs.isEmpty()) {
+      QVector<Routino_Output> route;
+      stitchLegs(legs, route);
+      rte->setResult(route.data(),
+                     getOptions() + tr("<br/>Calculation time: %1s").arg(time.elapsed() / 1000.0, 0, 'f', 2));
     }
   } catch (const QString& msg) {
+    delete progress;
     if (!msg.isEmpty()) {
       QMessageBox::critical(this, "Routino...", msg, QMessageBox::Abort);
     }
   }
 
-  mutex.unlock();
+  unlockFromGui();
 
   CCanvas::triggerCompleteUpdate(CCanvas::eRedrawGis);
 }
 
 int CRouterRoutino::calcRoute(const QPointF& p1, const QPointF& p2, QPolygonF& coords, qreal* costs = nullptr) {
-  if (!mutex.tryLock()) {
+  if (!lockFromGui()) {
     return -1;
   }
 
   try {
-    QVariantMap map = comboDatabase->currentData(Qt::UserRole).toMap();
-    Routino_Database* data = (Routino_Database*)(map["db"].toULongLong());
-    if (nullptr == data) {
+    request_t request;
+    if (!getRequest(request)) {
       throw QString();
     }
 
-    loadProfiles(map["profilesPath"].toString());
-
-    QString strProfile = comboProfile->currentData(Qt::UserRole).toString();
-    QString strLanguage = comboLanguage->currentData(Qt::UserRole).toString();
+    progress = new CProgressDialog(tr("Calculate route with %1").arg(getOptions()), 0, NOINT, this);
+    calcRoute(request, p1, p2, ProgressFunc, coords, costs);
+    delete progress;
+  } catch (const QString& msg) {
+    delete progress;
+    coords.clear();
 
-    Routino_Profile* profile = Routino_GetProfile(strProfile.toUtf8());
-    if (profile == NULL) {
-      throw tr("Required profile '%1' is not in the current profiles file.").arg(strProfile);
+    if (!msg.isEmpty()) {
+      unlockFromGui();
+      throw msg;
     }
-    Routino_Translation* translation = Routino_GetTranslation(strLanguage.toUtf8());
+  }
 
-    int res = Routino_ValidateProfile(data, profile);
-    if (res != 0) {
-      throw xlateRoutinoError(Routino_errno);
-    }
+  unlockFromGui();
+  return coords.size();
+}
 
-    int options = ROUTINO_ROUTE_LIST_HTML_ALL;
-    if (comboMode->currentIndex() == 0) {
-      options |= ROUTINO_ROUTE_SHORTEST;
-    }
-    if (comboMode->currentIndex() == 1) {
-      options |= ROUTINO_ROUTE_QUICKEST;
-    }
+quint32 CRouterRoutino::calcRouteAsync(const QPointF& p1, const QPointF& p2) {
+  // only one request at a time, the caller has to abort the running one first
+  request_t request;
+  if (idAsync != 0 || !getRequest(request)) {
+    return 0;
+  }
 
-    Routino_Waypoint* waypoints[2] = {0};
-    waypoints[0] = Routino_FindWaypoint(data, profile, p1.y() * RAD_TO_DEG, p1.x() * RAD_TO_DEG);
-    if (waypoints[0] == nullptr) {
-      throw xlateRoutinoError(Routino_errno);
+  idAsync = getNextRouteId();
+
+  const quint32 id = idAsync;
+  threadPool.start([this, id, request, p1, p2]() {
+    QPolygonF coords;
+    QString error;
+
+    mutex.lock();
+    idAsyncRunning.storeRelease(id);
+    // skip requests aborted while waiting in the queue
+    if (id > idAsyncAborted.loadAcquire()) {
+      try {
+        calcRoute(request, p1, p2, progressAsync, coords, nullptr);
+      } catch (const QString& msg) {
+        coords.clear();
+        error = msg;
+      }
     }
+    mutex.unlock();
 
-    waypoints[1] = Routino_FindWaypoint(data, profile, p2.y() * RAD_TO_DEG, p2.x() * RAD_TO_DEG);
-    if (waypoints[1] == nullptr) {
-      throw xlateRoutinoError(Routino_errno);
+    QMetaObject::invokeMethod(
+        this,
+        [this, id, coords, error]() {
+          if (idAsync == id) {
+            idAsync = 0;
+          }
+          emit sigRouteFinished(id, coords, error);
+        },
+        Qt::QueuedConnection);
+  });
+
+  return id;
+}
+
+void CRouterRoutino::abortRouteAsync(quint32 id) {
+  if (id != 0 && id == idAsync) {
+    // Accept the next request right away. The aborted one still reports an
+    // empty result, but must not block a new request until then.
+    idAsyncAborted.storeRelease(id);
+    idAsync = 0;
+  }
+}
+
+void CRouterRoutino::waitForAsyncRouting() {
+  abortRouteAsync(idAsync);
+  threadPool.waitForDone();
+}
+
+int CRouterRoutino::progressAsync(double complete) {
+  return pSelf->idAsyncRunning.loadAcquire() > pSelf->idAsyncAborted.loadAcquire();
+}
+
+bool CRouterRoutino::lockFromGui() {
+  // Calls from the GUI thread can be nested by the event loop of the progress dialog.
+  if (lockedByGui) {
+    return false;
+  }
+  // wait for a running asynchronous request
+  mutex.lock();
+  lockedByGui = true;
+  return true;
+}
+
+void CRouterRoutino::unlockFromGui() {
+  lockedByGui = false;
+  mutex.unlock();
+}
+
+bool CRouterRoutino::getRequest(request_t& request) const {
+  const QVariantMap& map = comboDatabase->currentData(Qt::UserRole).toMap();
+  request.data = (Routino_Database*)(map["db"].toULongLong());
+  if (nullptr == request.data) {
+    return false;
+  }
+
+  request.profilesPath = map["profilesPath"].toString();
+  request.profile = comboProfile->currentData(Qt::UserRole).toString();
+  request.language = comboLanguage->currentData(Qt::UserRole).toString();
+  request.quickest = comboMode->currentIndex() == 1;
+  return true;
+}
+
+void CRouterRoutino::setupRouting(const request_t& request, routing_t& routing) {
+  loadProfiles(request.profilesPath);
+
+  routing.profile = Routino_GetProfile(request.profile.toUtf8());
+  if (routing.profile == NULL) {
+    throw tr("Required profile '%1' is not in the current profiles file.").arg(request.profile);
+  }
+  routing.translation = Routino_GetTranslation(request.language.toUtf8());
+
+  int res = Routino_ValidateProfile(request.data, routing.profile);
+  if (res != 0) {
+    throw xlateRoutinoError(Routino_errno);
+  }
+
+  routing.options = ROUTINO_ROUTE_LIST_HTML_ALL;
+  routing.options |= request.quickest ? ROUTINO_ROUTE_QUICKEST : ROUTINO_ROUTE_SHORTEST;
+}
+
+void CRouterRoutino::calcRoute(const request_t& request, const QPointF& p1, const QPointF& p2,
+                               int (*funcProgress)(double), QPolygonF& coords, qreal* costs) {
+  routing_t routing;
+  setupRouting(request, routing);
+
+  const leg_t& leg = calcLeg(request, routing, p1, p2, funcProgress);
+  for (const leg_point_t& point : leg) {
+    if (point.type != ROUTINO_POINT_WAYPOINT) {
+      coords << QPointF(point.lon, point.lat);
     }
+  }
 
-    progress = new CProgressDialog(tr("Calculate route with %1").arg(getOptions()), 0, NOINT, this);
+  if (costs != nullptr && !leg.isEmpty()) {
+    // This works, since CRouteOptimization adapts it's weights according to the data it gets
+    *costs = request.quickest ? leg.last().time : leg.last().dist;
+  }
+}
+
+QString CRouterRoutino::getPointKey(const request_t& request, const QPointF& pt) {
+  return QString("%1|%2|%3|%4|%5")
+      .arg(quintptr(request.data))
+      .arg(request.profilesPath, request.profile)
+      .arg(qRound(pt.x() / COORD_PRECISION))
+      .arg(qRound(pt.y() / COORD_PRECISION));
+}
 
-    Routino_Output* route = Routino_CalculateRoute(data, profile, translation, waypoints, 2, options, ProgressFunc);
+Routino_Waypoint* CRouterRoutino::findWaypoint(const request_t& request, const routing_t& routing, const QPointF& pt) {
+  const QString& key = getPointKey(request, pt);
 
-    delete progress;
+  waypoint_t* waypoint = cacheWaypoints.object(key);
+  if (waypoint != nullptr) {
+    return waypoint->waypoint;
+  }
 
-    if (route != nullptr) {
-      Routino_Output* next = route;
-      while (next) {
-        if (next->type != ROUTINO_POINT_WAYPOINT) {
-          coords << QPointF(next->lon, next->lat);
-        }
-        if (costs != nullptr) {
-          if (comboMode->currentIndex() == 1) {
-            // ROUTINO_ROUTE_QUICKEST
-            // This works, since CRouteOptimization adapts it's weights according to the data it gets
-            *costs = next->time;
-          } else {
-            // ROUTINO_ROUTE_SHORTEST
-            *costs = next->dist;
-          }
-        }
-        next = next->next;
-      }
-      Routino_DeleteRoute(route);
+  Routino_Waypoint* data =
+      Routino_FindWaypoint(request.data, routing.profile, pt.y() * RAD_TO_DEG, pt.x() * RAD_TO_DEG);
+  if (data == nullptr) {
+    throw xlateRoutinoError(Routino_errno);
+  }
+
+  waypoint = new waypoint_t(data);
+  cacheWaypoints.insert(key, waypoint);
+  return data;
+}
+
+CRouterRoutino::leg_t CRouterRoutino::calcLeg(const request_t& request, const routing_t& routing, const QPointF& p1,
+                                              const QPointF& p2, int (*funcProgress)(double)) {
+  const QString& key = QString("%1|%2|%3|%4")
+                           .arg(getPointKey(request, p1), getPointKey(request, p2), request.language)
+                           .arg(request.quickest);
+
+  const leg_t* cached = cacheLegs.object(key);
+  if (cached != nullptr) {
+    return *cached;
+  }
+
+  // the first waypoint is the most recently used one and will not be dropped by the second one
+  Routino_Waypoint* waypoints[2] = {findWaypoint(request, routing, p1), nullptr};
+  waypoints[1] = findWaypoint(request, routing, p2);
+
+  Routino_Output* route = Routino_CalculateRoute(request.data, routing.profile, routing.translation, waypoints, 2,
+                                                 routing.options, funcProgress);
+  if (route == nullptr) {
+    if (Routino_errno != ROUTINO_ERROR_PROGRESS_ABORTED) {
+      throw xlateRoutinoError(Routino_errno);
     } else {
-      if (Routino_errno != ROUTINO_ERROR_PROGRESS_ABORTED) {
-        throw xlateRoutinoError(Routino_errno);
-      } else {
-        throw QString();
-      }
+      throw QString();
     }
-  } catch (const QString& msg) {
-    coords.clear();
+  }
 
-    if (!msg.isEmpty()) {
-      mutex.unlock();
-      throw msg;
+  leg_t leg;
+  for (Routino_Output* next = route; next != nullptr; next = next->next) {
+    leg_point_t point;
+    point.lon = next->lon;
+    point.lat = next->lat;
+    point.dist = next->dist;
+    point.time = next->time;
+    point.type = next->type;
+    point.turn = next->turn;
+    point.bearing = next->bearing;
+    point.name = next->name;
+    point.desc1 = next->desc1;
+    point.desc2 = next->desc2;
+    leg << point;
+  }
+  Routino_DeleteRoute(route);
+
+  cacheLegs.insert(key, new leg_t(leg), leg.size());
+  return leg;
+}
+
+void CRouterRoutino::stitchLegs(const QVector<leg_t>& legs, QVector<Routino_Output>& route) {
+  route.clear();
+
+  float dist = 0;
+  float time = 0;
+  for (int i = 0; i < legs.size(); i++) {
+    const leg_t& leg = legs[i];
+    // The end of a leg is the start of the next one. Take the next leg's start.
+    const int N = (i < legs.size() - 1) ? leg.size() - 1 : leg.size();
+    for (int n = 0; n < N; n++) {
+      const leg_point_t& point = leg[n];
+
+      Routino_Output output;
+      memset(&output, 0, sizeof(output));
+      output.lon = point.lon;
+      output.lat = point.lat;
+      output.dist = dist + point.dist;
+      output.time = time + point.time;
+      output.type = point.type;
+      output.turn = point.turn;
+      output.bearing = point.bearing;
+      // the strings are owned by the legs and stay valid as long as they exist
+      output.name = point.name.isNull() ? nullptr : const_cast<char*>(point.name.constData());
+      output.desc1 = point.desc1.isNull() ? nullptr : const_cast<char*>(point.desc1.constData());
+      output.desc2 = point.desc2.isNull() ? nullptr : const_cast<char*>(point.desc2.constData());
+      route << output;
+    }
+
+    if (!leg.isEmpty()) {
+      dist += leg.last().dist;
+      time += leg.last().time;
     }
   }
 
-  mutex.unlock();
-  return coords.size();
+  for (int i = 0; i < route.size() - 1; i++) {
+    route[i].next = &route[i + 1];
+  }
+}
+
+void CRouterRoutino::clearCache() {
+  cacheLegs.clear();
+  cacheWaypoints.clear();
 }
@@ -21,7 +21,10 @@
 
 #include <routino.h>
 
+#include <QAtomicInt>
+#include <QCache>
 #include <QPoint>
+#include <QThreadPool>
 
 #include "gis/rte/router/IRouter.h"
 #include "ui_IRouterRoutino.h"
@@ -40,6 +43,9 @@ class CRouterRoutino : public IRouter, private Ui::IRouterRoutino {
   bool hasFastRouting() override;
 
   QString getOptions() override;
+  QString getCacheKey() override;
+  quint32 calcRouteAsync(const QPointF& p1, const QPointF& p2) override;
+  void abortRouteAsync(quint32 id) override;
 
   static QPointer<CProgressDialog> progress;
 
@@ -50,6 +56,69 @@ class CRouterRoutino : public IRouter, private Ui::IRouterRoutino {
 
  private:
   virtual ~CRouterRoutino();
+
+  /// a snapshot of the router's setup to calculate a route without the GUI
+  struct request_t {
+    Routino_Database* data = nullptr;
+    QString profilesPath;
+    QString profile;
+    QString language;
+    bool quickest = false;
+  };
+
+  /// the Routino objects derived from a request
+  struct routing_t {
+    Routino_Profile* profile = nullptr;
+    Routino_Translation* translation = nullptr;
+    int options = 0;
+  };
+
+  /// a copy of a point of Routino's result
+  struct leg_point_t {
+    float lon = 0;
+    float lat = 0;
+    float dist = 0;
+    float time = 0;
+    int type = 0;
+    int turn = 0;
+    int bearing = 0;
+    QByteArray name;
+    QByteArray desc1;
+    QByteArray desc2;
+  };
+
+  /// the route between two waypoints
+  using leg_t = QVector<leg_point_t>;
+
+  /// a waypoint snapped to the routing graph
+  struct waypoint_t {
+    waypoint_t(Routino_Waypoint* waypoint) : waypoint(waypoint) {}
+    ~waypoint_t() { free(waypoint); }
+    Routino_Waypoint* waypoint;
+  };
+
+  bool getRequest(request_t& request) const;
+  void setupRouting(const request_t& request, routing_t& routing);
+  /// calculate a route, the mutex has to be locked, throws a QString on error
+  void calcRoute(const request_t& request, const QPointF& p1, const QPointF& p2, int (*funcProgress)(double),
+                 QPolygonF& coords, qreal* costs);
+  /// calculate a leg or take it from the cache, the mutex has to be locked, throws a QString on error
+  leg_t calcLeg(const request_t& request, const routing_t& routing, const QPointF& p1, const QPointF& p2,
+                int (*funcProgress)(double));
+  /// snap a point to the routing graph or take it from the cache, throws a QString on error
+  Routino_Waypoint* findWaypoint(const request_t& request, const routing_t& routing, const QPointF& pt);
+  static QString getPointKey(const request_t& request, const QPointF& pt);
+  /// join the legs to a single result as returned by Routino
+  static void stitchLegs(const QVector<leg_t>& legs, QVector<Routino_Output>& route);
+  void clearCache();
+
+  /// lock the mutex from the GUI thread, fails if the GUI thread holds the lock already
+  bool lockFromGui();
+  void unlockFromGui();
+  /// abort a pending asynchronous request and wait for it to finish
+  void waitForAsyncRouting();
+  static int progressAsync(double complete);
+
   void buildDatabaseList();
   void freeDatabaseList();
   int loadProfiles(const QString& profilesPath);
@@ -61,6 +130,20 @@ class CRouterRoutino : public IRouter, private Ui::IRouterRoutino {
   QString currentProfilesPath;
 
   QMutex mutex;
+
+  QThreadPool threadPool;
+  /// the id of the pending asynchronous request, 0 if there is none or it has been aborted
+  quint32 idAsync = 0;
+  /// the id of the request calculated by the worker thread
+  QAtomicInteger<quint32> idAsyncRunning;
+  /// requests with an id up to this one are aborted
+  QAtomicInteger<quint32> idAsyncAborted;
+  bool lockedByGui = false;
+
+  /// snapped waypoints by database, profile and position
+  QCache<QString, waypoint_t> cacheWaypoints;
+  /// legs by the key of both waypoints, language and mode
+  QCache<QString, leg_t> cacheLegs;
 };
 
 #endif  // CROUTERROUTINO_H
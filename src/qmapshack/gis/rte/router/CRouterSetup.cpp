@@ -40,6 +40,13 @@ CRouterSetup::CRouterSetup(QWidget* parent) : QWidget(parent) {
   stackedWidget->addWidget(new CRouterMapQuest(this));
   stackedWidget->addWidget(new CRouterBRouter(this));
 
+  for (int i = 0; i < stackedWidget->count(); i++) {
+    IRouter* router = dynamic_cast<IRouter*>(stackedWidget->widget(i));
+    if (router != nullptr) {
+      connect(router, &IRouter::sigRouteFinished, this, &CRouterSetup::sigRouteFinished);
+    }
+  }
+
   connect(comboRouter, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
           &CRouterSetup::slotSelectRouter);
 
@@ -93,6 +100,34 @@ QString CRouterSetup::getOptions() {
   return "";
 }
 
+quint32 CRouterSetup::calcRouteAsync(const QPointF& p1, const QPointF& p2) {
+  IRouter* router = dynamic_cast<IRouter*>(stackedWidget->currentWidget());
+  if (router) {
+    return router->calcRouteAsync(p1, p2);
+  }
+
+  return 0;
+}
+
+void CRouterSetup::abortRouteAsync(quint32 id) {
+  // the request might belong to a router that is not the current one anymore
+  for (int i = 0; i < stackedWidget->count(); i++) {
+    IRouter* router = dynamic_cast<IRouter*>(stackedWidget->widget(i));
+    if (router != nullptr) {
+      router->abortRouteAsync(id);
+    }
+  }
+}
+
+QString CRouterSetup::getCacheKey() {
+  IRouter* router = dynamic_cast<IRouter*>(stackedWidget->currentWidget());
+  if (router) {
+    return router->getCacheKey();
+  }
+
+  return "";
+}
+
 void CRouterSetup::setRouterTitle(const router_e router, const QString title) {
   comboRouter->setItemText(router, title);
 }
@@ -33,6 +33,12 @@ class CRouterSetup : public QWidget, private Ui::IRouterSetup {
   void calcRoute(const IGisItem::key_t& key);
   int calcRoute(const QPointF& p1, const QPointF& p2, QPolygonF& coords, qreal* costs = nullptr);
   QString getOptions();
+  QString getCacheKey();
+
+  /// @see IRouter::calcRouteAsync()
+  quint32 calcRouteAsync(const QPointF& p1, const QPointF& p2);
+  /// @see IRouter::abortRouteAsync()
+  void abortRouteAsync(quint32 id);
 
   bool hasFastRouting();
 
@@ -40,6 +46,10 @@ class CRouterSetup : public QWidget, private Ui::IRouterSetup {
 
   void setRouterTitle(router_e, QString title);
 
+ signals:
+  /// forwarded IRouter::sigRouteFinished() of all routers
+  void sigRouteFinished(quint32 id, const QPolygonF& coords, const QString& error);
+
  private slots:
   void slotSelectRouter(int i);
 
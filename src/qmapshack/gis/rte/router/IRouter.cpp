@@ -18,6 +18,36 @@
 
 #include "gis/rte/router/IRouter.h"
 
+#include <QtCore>
+
+quint32 IRouter::lastRouteId = 0;
+
 IRouter::IRouter(bool fastRouting, QWidget* parent) : QWidget(parent), fastRouting(fastRouting) {}
 
 IRouter::~IRouter() {}
+
+quint32 IRouter::getNextRouteId() {
+  // 0 is reserved for "no request"
+  if (++lastRouteId == 0) {
+    ++lastRouteId;
+  }
+  return lastRouteId;
+}
+
+quint32 IRouter::calcRouteAsync(const QPointF& p1, const QPointF& p2) {
+  QPolygonF coords;
+  QString error;
+  try {
+    if (calcRoute(p1, p2, coords) < 0) {
+      return 0;
+    }
+  } catch (const QString& msg) {
+    coords.clear();
+    error = msg;
+  }
+
+  // report the result after the caller has registered the id
+  const quint32 id = getNextRouteId();
+  QTimer::singleShot(0, this, [this, id, coords, error]() { emit sigRouteFinished(id, coords, error); });
+  return id;
+}
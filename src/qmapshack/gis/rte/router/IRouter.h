@@ -35,10 +35,57 @@ class IRouter : public QWidget {
 
   virtual QString getOptions() = 0;
 
+  /**
+     @brief Get a key identifying the router's data and options
+
+     Routes calculated with the same key are identical. Thus they can be stored
+     and reused across sessions. The key has to change as soon as the routing
+     data or an option affecting the result changes.
+
+     @return The key or an empty string if the router's results must not be stored.
+   */
+  virtual QString getCacheKey() { return QString(); }
+
+  /**
+     @brief Calculate a route between two points without blocking the GUI
+
+     The result is reported by sigRouteFinished(). The default implementation
+     calls calcRoute() and reports the result via the event loop.
+
+     @param p1  the start point in [rad]
+     @param p2  the end point in [rad]
+     @return The id of the request or 0 if the router can not take the request.
+   */
+  virtual quint32 calcRouteAsync(const QPointF& p1, const QPointF& p2);
+
+  /**
+     @brief Abort a request started by calcRouteAsync()
+
+     The request will still report an empty result via sigRouteFinished().
+
+     @param id  the id as returned by calcRouteAsync()
+   */
+  virtual void abortRouteAsync(quint32 id) {}
+
   virtual void routerSelected() {}
 
+ signals:
+  /**
+     @brief Emitted when a request started by calcRouteAsync() is done
+
+     @param id      the id as returned by calcRouteAsync()
+     @param coords  the route's points in [rad], empty if no route was found
+     @param error   an error message, empty on success or if the request was aborted
+   */
+  void sigRouteFinished(quint32 id, const QPolygonF& coords, const QString& error);
+
+ protected:
+  /// get a new id for an asynchronous request, unique for all routers
+  static quint32 getNextRouteId();
+
  private:
   bool fastRouting;
+  static quint32 lastRouteId;
 };
 
 #endif  // IROUTER_H
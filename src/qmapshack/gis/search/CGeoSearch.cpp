@@ -150,7 +150,7 @@ void CGeoSearch::slotStartSearch() {
   QMS_DELETE(itemStatus);
 
   if (!searchConfig->accumulativeResults) {
-    qDeleteAll(takeChildren());
+    qDeleteAll(takeItems());
   }
 
   QString addr = edit->text();
@@ -693,6 +693,6 @@ void CGeoSearch::slotAccuResults(bool yes) {
 }
 
 void CGeoSearch::slotResetResults() {
-  qDeleteAll(takeChildren());
+  qDeleteAll(takeItems());
   updateDecoration();
 }
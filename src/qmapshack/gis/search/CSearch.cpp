@@ -27,9 +27,6 @@ QMap<QString, searchProperty_e> CSearch::searchPropertyEnumMap;
 QMap<searchProperty_e, QString> CSearch::searchPropertyMeaningMap;
 
 CSearch::CSearch(QString searchstring) : searchText(searchstring) {
-  // Initialisation
-  searchTypeLambdaMap = initSearchTypeLambdaMap();
-
   if (searchstring.simplified().isEmpty()) {
     return;
   }
@@ -196,16 +193,118 @@ CSearch::CSearch(QString searchstring) : searchText(searchstring) {
   if (search.property == eSearchPropertyNoMatch) {
     syntaxError = true;
   }
+  compileQuery();
 }
 
 bool CSearch::getSearchResult(IGisItem* item) {
-  bool passed = true;
-  if (searchTypeLambdaMap.contains(search.searchType)) {
-    const searchValue_t& itemFilterValue = item->getValueByKeyword(search.property);
-    passed = searchTypeLambdaMap.value(search.searchType)(itemFilterValue, search.searchValue);
-    return passed;
+  if (isEmpty()) {
+    return true;  // Empty search shouldn't hide anything
+  }
+  return getSearchResult(item->getValueByKeyword(search.property));
+}
+
+bool CSearch::getSearchResult(const searchValue_t& itemValue) {
+  switch (search.searchType) {
+    case eSearchTypeNone:
+      return true;  // Empty search shouldn't hide anything
+
+    case eSearchTypeEquals:
+      return itemValue.toString().compare(searchString, caseSensitivity) == 0;
+
+    case eSearchTypeSmaller:
+      return isSmaller(itemValue);
+
+    case eSearchTypeBigger:
+      return isBigger(itemValue);
+
+    case eSearchTypeBetween:
+      return isBetween(itemValue);
+
+    case eSearchTypeWith:
+      return itemValue.toString().contains(searchString, caseSensitivity);
+
+    case eSearchTypeWithout: {
+      const QString& str = itemValue.toString();
+      return str.isEmpty() ? false : !str.contains(searchString, caseSensitivity);
+    }
+
+    case eSearchTypeRegEx:
+      // There is no option to make regex caseinsensitive
+      if (caseSensitivity == Qt::CaseInsensitive) {
+        return itemValue.toString().toLower().contains(searchRegExp);
+      } else {
+        return itemValue.toString().contains(searchRegExp);
+      }
+  }
+  return true;
+}
+
+// Everything that does not depend on the item is done once when the search is created
+void CSearch::compileQuery() {
+  searchString = search.searchValue.toString();
+  if (search.searchType == eSearchTypeRegEx) {
+    searchRegExp = QRegExp(caseSensitivity == Qt::CaseInsensitive ? searchString.toLower() : searchString);
+  }
+}
+
+bool CSearch::isSmaller(const searchValue_t& itemValue) {
+  if (itemValue.value1 != NOFLOAT) {
+    if (search.searchValue.value1 != NOFLOAT) {
+      bool adjustSuccess = adjustUnits(itemValue, search.searchValue);
+      if (adjustSuccess == false) {
+        return false;
+      }
+      if (itemValue.value2 == NOFLOAT) {
+        return itemValue.value1 < search.searchValue.value1;
+      } else {
+        return qMax(itemValue.value1, itemValue.value2) < search.searchValue.value1;
+      }
+    } else {
+      syntaxError = true;
+    }
+  }
+  return false;
+}
+
+bool CSearch::isBigger(const searchValue_t& itemValue) {
+  if (itemValue.value1 != NOFLOAT) {
+    if (search.searchValue.value1 != NOFLOAT) {
+      bool adjustSuccess = adjustUnits(itemValue, search.searchValue);
+      if (adjustSuccess == false) {
+        return false;
+      }
+      if (itemValue.value2 == NOFLOAT) {
+        return itemValue.value1 > search.searchValue.value1;
+      } else {
+        return qMin(itemValue.value1, itemValue.value2) > search.searchValue.value1;
+      }
+    } else {
+      syntaxError = true;
+    }
   }
-  return true;  // Empty search shouldn't hide anything
+  return false;
+}
+
+bool CSearch::isBetween(const searchValue_t& itemValue) {
+  const searchValue_t& searchValue = search.searchValue;
+  if (itemValue.value1 != NOFLOAT) {
+    if (searchValue.value1 != NOFLOAT && searchValue.value2 != NOFLOAT) {
+      bool adjustSuccess = adjustUnits(itemValue, search.searchValue);
+      if (adjustSuccess == false) {
+        return false;
+      }
+      if (itemValue.value2 == NOFLOAT) {
+        return itemValue.value1 < qMax(searchValue.value1, searchValue.value2) &&
+               itemValue.value1 > qMin(searchValue.value1, searchValue.value2);
+      } else {
+        return qMax(itemValue.value1, itemValue.value2) < qMax(searchValue.value1, searchValue.value2) &&
+               qMin(itemValue.value1, itemValue.value2) > qMin(searchValue.value1, searchValue.value2);
+      }
+    } else {
+      syntaxError = true;
+    }
+  }
+  return false;
 }
 
 // itemValue is the value returned by a GisItem and thus always has the same unit.
@@ -498,86 +597,3 @@ QMap<searchProperty_e, QString> CSearch::initSearchPropertyMeaningMap() {
 
   return map;
 }
-
-QMap<CSearch::search_type_e, CSearch::fSearch> CSearch::initSearchTypeLambdaMap() {
-  QMap<CSearch::search_type_e, CSearch::fSearch> map;
-  map.insert(eSearchTypeEquals, [](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    return itemValue.toString().compare(searchValue.toString(), CSearch::caseSensitivity) == 0;
-  });
-  map.insert(eSearchTypeSmaller, [this](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    if (itemValue.value1 != NOFLOAT) {
-      if (searchValue.value1 != NOFLOAT) {
-        bool adjustSuccess = adjustUnits(itemValue, searchValue);
-        if (adjustSuccess == false) {
-          return false;
-        }
-        if (itemValue.value2 == NOFLOAT) {
-          return itemValue.value1 < searchValue.value1;
-        } else {
-          return qMax(itemValue.value1, itemValue.value2) < searchValue.value1;
-        }
-      } else {
-        syntaxError = true;
-      }
-    }
-    return false;
-  });
-  map.insert(eSearchTypeBigger, [this](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    if (itemValue.value1 != NOFLOAT) {
-      if (searchValue.value1 != NOFLOAT) {
-        bool adjustSuccess = adjustUnits(itemValue, searchValue);
-        if (adjustSuccess == false) {
-          return false;
-        }
-        if (itemValue.value2 == NOFLOAT) {
-          return itemValue.value1 > searchValue.value1;
-        } else {
-          return qMin(itemValue.value1, itemValue.value2) > searchValue.value1;
-        }
-      } else {
-        syntaxError = true;
-      }
-    }
-    return false;
-  });
-
-  map.insert(eSearchTypeBetween, [this](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    if (itemValue.value1 != NOFLOAT) {
-      if (searchValue.value1 != NOFLOAT && searchValue.value2 != NOFLOAT) {
-        bool adjustSuccess = adjustUnits(itemValue, searchValue);
-        if (adjustSuccess == false) {
-          return false;
-        }
-        if (itemValue.value2 == NOFLOAT) {
-          return itemValue.value1 < qMax(searchValue.value1, searchValue.value2) &&
-                 itemValue.value1 > qMin(searchValue.value1, searchValue.value2);
-        } else {
-          return qMax(itemValue.value1, itemValue.value2) < qMax(searchValue.value1, searchValue.value2) &&
-                 qMin(itemValue.value1, itemValue.value2) > qMin(searchValue.value1, searchValue.value2);
-        }
-      } else {
-        syntaxError = true;
-      }
-    }
-    return false;
-  });
-  map.insert(eSearchTypeWith, [](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    return itemValue.toString().contains(searchValue.toString(), CSearch::caseSensitivity);
-  });
-  map.insert(eSearchTypeWithout, [](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    if (itemValue.toString().isEmpty()) {
-      return false;
-    } else {
-      return !itemValue.toString().contains(searchValue.toString(), CSearch::caseSensitivity);
-    }
-  });
-  map.insert(eSearchTypeRegEx, [](const searchValue_t& itemValue, searchValue_t& searchValue) {
-    if (CSearch::caseSensitivity == Qt::CaseInsensitive)  // There is no option to make regex caseinsensitive
-    {
-      return itemValue.toString().toLower().contains(QRegExp(searchValue.toString().toLower()));
-    } else {
-      return itemValue.toString().contains(QRegExp(searchValue.toString()));
-    }
-  });
-  return map;
-}
@@ -20,6 +20,7 @@
 #define CSEARCH_H
 
 #include <QList>
+#include <QRegExp>
 #include <QString>
 #include <functional>
 
@@ -146,8 +147,25 @@ class CSearch {
     return searchPropertyMeaningMap.value(searchPropertyEnumMap.value(property), tr("No information available"));
   }
 
+  /// the property of an item the search is applied to
+  searchProperty_e getSearchProperty() const { return search.property; }
+
+  /// true if the search will pass all items
+  bool isEmpty() const { return search.searchType == eSearchTypeNone; }
+
   bool getSearchResult(IGisItem* item);
 
+  /**
+     @brief Apply the search to a value of an item
+
+     Use this to apply the search to a value previously queried by
+     IGisItem::getValueByKeyword() with getSearchProperty().
+
+     @param itemValue   the value of the item
+     @return True if the item passes the search.
+   */
+  bool getSearchResult(const searchValue_t& itemValue);
+
   static Qt::CaseSensitivity getCaseSensitivity() { return caseSensitivity; }
   static void setCaseSensitivity(const Qt::CaseSensitivity& value) { caseSensitivity = value; }
 
@@ -167,9 +185,17 @@ class CSearch {
 
   bool adjustUnits(const searchValue_t& itemValue, searchValue_t& searchValue);
   void improveQuery();
+  void compileQuery();
+
+  bool isSmaller(const searchValue_t& itemValue);
+  bool isBigger(const searchValue_t& itemValue);
+  bool isBetween(const searchValue_t& itemValue);
 
   search_t search;
   QString searchText;
+  /// the search value as string, as it's used for all text based comparisons
+  QString searchString;
+  QRegExp searchRegExp;
   bool syntaxError = false;
   bool autoDetectedProperty = false;
 
@@ -184,11 +210,6 @@ class CSearch {
 
   static QMap<searchProperty_e, QString> searchPropertyMeaningMap;
   static QMap<searchProperty_e, QString> initSearchPropertyMeaningMap();
-
-  // First is itemValue, second is searchValue, which is non const to adjust units
-  using fSearch = std::function<bool(const searchValue_t&, searchValue_t&)>;
-  QMap<search_type_e, fSearch> searchTypeLambdaMap;
-  QMap<search_type_e, fSearch> initSearchTypeLambdaMap();
 };
 
 #endif  // CSEARCH_H
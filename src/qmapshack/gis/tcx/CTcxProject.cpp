@@ -58,6 +58,17 @@ CTcxProject::CTcxProject(const QString& filename, const IGisProject* project, ID
   valid = true;
 }
 
+CTcxProject::CTcxProject(const QString& filename)
+    : IGisProject(eTypeTcx, filename, static_cast<CGisListWks*>(nullptr)) {
+  blockUpdateItems(true);
+  try {
+    loadTcx(filename, this);
+  } catch (QString& errormsg) {
+    qWarning() << "Failed to load TCX file:" << errormsg;
+    valid = false;
+  }
+}
+
 void CTcxProject::setup() {
   setIcon(CGisListWks::eColumnIcon, QIcon("://icons/32x32/TcxProject.png"));
   blockUpdateItems(true);
@@ -27,6 +27,8 @@ class CTcxProject : public IGisProject {
   CTcxProject(const QString& filename, CGisListWks* parent);
   CTcxProject(const QString& filename, IDevice* parent);
   CTcxProject(const QString& filename, const IGisProject* project, IDevice* parent);
+  /// load a file into a project without parent, see CGpxProject::CGpxProject(const QString&)
+  explicit CTcxProject(const QString& filename);
   virtual ~CTcxProject() = default;
 
   const QString getFileDialogFilter() const override { return IGisProject::filedialogFilterTCX; }
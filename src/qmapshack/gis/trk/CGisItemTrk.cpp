@@ -38,6 +38,7 @@
 #include "gis/trk/CTrkToRteDialog.h"
 #include "gis/wpt/CGisItemWpt.h"
 #include "helpers/CDraw.h"
+#include "helpers/COccupancyGrid.h"
 #include "helpers/CProgressDialog.h"
 #include "misc.h"
 
@@ -48,6 +49,11 @@
 #define WPT_FOCUS_DIST_IN (50 * 50)
 #define WPT_FOCUS_DIST_OUT (200 * 200)
 
+// number of segments of the screen line grouped into one chunk for hit testing
+#define N_SEGS_CHUNK 64
+// margin of a chunk's bounding rectangle, must not be smaller than the threshold used by isCloseTo()
+#define CHUNK_MARGIN 20
+
 namespace {
 // helper to declutter and draw clusters of track info points
 class cluster {
@@ -243,7 +249,9 @@ CGisItemTrk::CGisItemTrk(CFitStream& stream, IGisProject* project)
 
 CGisItemTrk::~CGisItemTrk() {
   // reset user focus if focused on this track
-  if (key == keyUserFocus) {
+  // The focus is owned by the main thread. Items deleted by worker threads (e.g. projects loaded
+  // by IDevice::loadProjects()) never have it and must not touch it.
+  if ((QThread::currentThread() == qApp->thread()) && (key == keyUserFocus)) {
     keyUserFocus.clear();
   }
 
@@ -1205,7 +1213,30 @@ void CGisItemTrk::findWaypointsCloseBy(CProgressDialog& progress, quint32& curre
 bool CGisItemTrk::isCloseTo(const QPointF& pos) {
   QMutexLocker lock(&mutexItems);
 
-  return GPS_Math_DistPointPolyline(lineSimple, pos) < 20;
+  // Only chunks with a bounding rectangle containing the position can be close
+  // enough. The chunks overlap by one point to cover all segments.
+  const qint32 N = rectsSimple.size();
+  for (qint32 i = 0; i < N; i++) {
+    if (!rectsSimple[i].contains(pos)) {
+      continue;
+    }
+
+    const QPolygonF chunk(lineSimple.mid(i * N_SEGS_CHUNK, N_SEGS_CHUNK + 1));
+    if (GPS_Math_DistPointPolyline(chunk, pos) < 20) {
+      return true;
+    }
+  }
+  return false;
+}
+
+QRectF CGisItemTrk::getScreenArea() const {
+  QMutexLocker lock(&mutexItems);
+
+  QRectF area;
+  for (const QRectF& rect : rectsSimple) {
+    area |= rect;
+  }
+  return area;
 }
 
 bool CGisItemTrk::isWithin(const QRectF& area, selflags_t flags) {
@@ -1562,11 +1593,12 @@ void CGisItemTrk::copySelectedPoints() const {
   new CGisItemTrk(name, idx1, idx2, trk, project);
 }
 
-void CGisItemTrk::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) {
+void CGisItemTrk::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) {
   QMutexLocker lock(&mutexItems);
 
   lineSimple.clear();
   lineFull.clear();
+  rectsSimple.clear();
 
   if (!isVisible(boundingRect, viewport, gis)) {
     return;
@@ -1616,6 +1648,11 @@ void CGisItemTrk::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>
   gis->convertRad2Px(lineSimple);
   gis->convertRad2Px(lineFull);
 
+  for (qint32 i = 0; i < lineSimple.size(); i += N_SEGS_CHUNK) {
+    const QPolygonF chunk(lineSimple.mid(i, N_SEGS_CHUNK + 1));
+    rectsSimple << chunk.boundingRect().adjusted(-CHUNK_MARGIN, -CHUNK_MARGIN, CHUNK_MARGIN, CHUNK_MARGIN);
+  }
+
   // draw the full line first
   if (mode == eModeRange) {
     QList<QPolygonF> lines;
@@ -1731,7 +1768,7 @@ void CGisItemTrk::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>
 }
 
 void CGisItemTrk::drawLimitLabels(limit_type_e type, const QString& label, const QPointF& pos, QPainter& p,
-                                  const QFontMetricsF& fm, QList<QRectF>& blockedAreas) {
+                                  const QFontMetricsF& fm, COccupancyGrid& blockedAreas) {
   const QString& fullLabel = (type == eLimitTypeMin ? tr("min.") : tr("max.")) + " " + label;
   QRectF rect = fm.boundingRect(fullLabel);
   rect.moveBottomLeft(pos.toPoint() + QPoint(10, -10));
@@ -1762,7 +1799,7 @@ void CGisItemTrk::drawLimitLabels(limit_type_e type, const QString& label, const
   CDraw::bubble(p, rect.toRect(), pos.toPoint(), Qt::white, baseWidth, basePos,
                 (key == keyUserFocus) ? CDraw::penBorderRed : CDraw::penBorderGray);
   CDraw::text(fullLabel, p, rect.toRect(), type == eLimitTypeMin ? Qt::darkGreen : Qt::darkRed);
-  blockedAreas << rect;
+  blockedAreas.insert(rect);
 }
 
 void CGisItemTrk::setPen(QPainter& p, QPen& pen, trkact_t act) const {
@@ -2043,7 +2080,7 @@ void CGisItemTrk::drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) {
   drawRange(p, gis);
 }
 
-void CGisItemTrk::drawLabel(QPainter& p, const QPolygonF&, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+void CGisItemTrk::drawLabel(QPainter& p, const QPolygonF&, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                             CGisDraw* gis) {
   if (!keyUserFocus.item.isEmpty() && (key != keyUserFocus)) {
     return;
@@ -2732,6 +2769,12 @@ void CGisItemTrk::checkForInvalidPoints() {
     return;
   }
 
+  // Projects loaded by worker threads, e.g. IDevice::loadProjects(), can't show a dialog. Their items
+  // are restored in the main thread, attached to the device.
+  if (QThread::currentThread() != qApp->thread()) {
+    return;
+  }
+
   if ((cntInvalidPoints != 0) && (cntInvalidPoints < cntVisiblePoints) && !isOnDevice()) {
     CInvalidTrk dlg(*this, CMainWindow::self().getBestWidgetForParent());
     dlg.exec();
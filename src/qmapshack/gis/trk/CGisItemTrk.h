@@ -345,12 +345,13 @@ class CGisItemTrk : public IGisItem, public IGisLine {
      @return True if point is considered close enough
    */
   bool isCloseTo(const QPointF& pos) override;
+  QRectF getScreenArea() const override;
 
   bool isWithin(const QRectF& area, selflags_t flags) override;
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) override;
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) override;
   void drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) override;
-  void drawLabel(QPainter& p, const QPolygonF&, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  void drawLabel(QPainter& p, const QPolygonF&, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                  CGisDraw* gis) override;
   void drawHighlight(QPainter& p) override;
   void drawRange(QPainter& p, CGisDraw* gis);
@@ -686,7 +687,7 @@ class CGisItemTrk : public IGisItem, public IGisLine {
 
   enum limit_type_e { eLimitTypeMin, eLimitTypeMax };
   void drawLimitLabels(limit_type_e type, const QString& label, const QPointF& pos, QPainter& p,
-                       const QFontMetricsF& fm, QList<QRectF>& blockedAreas);
+                       const QFontMetricsF& fm, COccupancyGrid& blockedAreas);
 
   /**
      @brief Tell the point of focus to all plots and the detail dialog
@@ -809,6 +810,8 @@ class CGisItemTrk : public IGisItem, public IGisLine {
   QPolygonF lineSimple;  //< the current track line as screen pixel coordinates
   QPolygonF lineFull;    //< visible and invisible points
 
+  QVector<QRectF> rectsSimple;  //< bounding rectangles of chunks of lineSimple to speed up isCloseTo()
+
   qint32 penWidthFg = 1;   //< inner trackline width
   qint32 penWidthBg = 3;   //< outer trackline width
   qint32 penWidthHi = 11;  //< highlighted trackline width
@@ -31,6 +31,7 @@ const QString CKnownExtension::internalTerrainSlope = "ql:terrainslope";
 
 QHash<QString, CKnownExtension> CKnownExtension::knownExtensions;
 QSet<QString> CKnownExtension::registeredNS;
+QReadWriteLock CKnownExtension::lock(QReadWriteLock::Recursive);
 
 static const int NOORDER = std::numeric_limits<int>::max();
 
@@ -52,6 +53,7 @@ bool CKnownExtension::registerNS(const QString& ns) {
 }
 
 void CKnownExtension::initGarminTPXv1(const IUnit& units, const QString& ns) {
+  QWriteLocker locker(&lock);
   if (!registerNS(ns)) {
     return;
   }
@@ -90,6 +92,7 @@ void CKnownExtension::initGarminTPXv1(const IUnit& units, const QString& ns) {
 }
 
 void CKnownExtension::initMioTPX(const IUnit& units) {
+  QWriteLocker locker(&lock);
   // support for extensions used by MIO Cyclo ver. 4.2 (who needs xml namespaces?!)
   knownExtensions.insert("heartrate",
                          {tr("Heart R.", "extShortName"), tr("Heart Rate", "extLongName"), NOORDER, 0., 300., 1., "bpm",
@@ -114,6 +117,7 @@ void CKnownExtension::initMioTPX(const IUnit& units) {
 }
 
 void CKnownExtension::initClueTrustTPXv1(const IUnit& units, const QString& ns) {
+  QWriteLocker locker(&lock);
   knownExtensions.insert(ns % ":cadence",
                          {tr("Cadence", "extShortName"), tr("Cadence", "extLongName"), 0, 0., 500., 1., "rpm",
                           "://icons/32x32/CSrcCAD.png", true, false, getExtensionValueFunc(ns % ":cadence")});
@@ -152,6 +156,7 @@ void CKnownExtension::initClueTrustTPXv1(const IUnit& units, const QString& ns)
 }
 
 void CKnownExtension::init(const IUnit& units) {
+  QWriteLocker locker(&lock);
   knownExtensions = {
       {internalSlope,
        {tr("Slope", "extShortName"), tr("Slope*"), -1, -90., 90., 1.,
@@ -194,10 +199,14 @@ void CKnownExtension::init(const IUnit& units) {
 const CKnownExtension CKnownExtension::get(const QString& key) {
   CKnownExtension def("", "", NOORDER, -100000., 100000., 1., "", "://icons/32x32/CSrcUnknown.png", false, true,
                       getExtensionValueFunc(key));
+  QReadLocker locker(&lock);
   return knownExtensions.value(key, def);
 }
 
-bool CKnownExtension::isKnown(const QString& key) { return knownExtensions.contains(key); }
+bool CKnownExtension::isKnown(const QString& key) {
+  QReadLocker locker(&lock);
+  return knownExtensions.contains(key);
+}
 
 QString CKnownExtension::getName(const QString& altName) const {
   bool hasNoName = nameShortText.isEmpty();
@@ -19,6 +19,7 @@
 #ifndef CKNOWNEXTENSION_H
 #define CKNOWNEXTENSION_H
 
+#include <QReadWriteLock>
 #include <QSet>
 
 #include "gis/trk/CGisItemTrk.h"
@@ -100,6 +101,8 @@ class CKnownExtension {
 
   static QHash<QString, CKnownExtension> knownExtensions;
   static QSet<QString> registeredNS;
+  /// GPX files register their namespaces while being loaded, possibly by several threads at once
+  static QReadWriteLock lock;
 
   CKnownExtension(QString nameShortText, QString nameLongText, int order, qreal minimum, qreal maximum, qreal factor,
                   QString unit, QString icon, bool known, bool derivedQMS, fTrkPtGetVal valueFunc)
@@ -36,6 +36,7 @@
 #include "gis/wpt/CScrOptWptRadius.h"
 #include "gis/wpt/CSetupIconAndName.h"
 #include "helpers/CDraw.h"
+#include "helpers/COccupancyGrid.h"
 #include "helpers/CSettings.h"
 #include "helpers/CWptIconManager.h"
 #include "mouse/IMouse.h"
@@ -518,6 +519,16 @@ bool CGisItemWpt::isCloseTo(const QPointF& pos) {
   return closeToRadius;
 }
 
+QRectF CGisItemWpt::getScreenArea() const {
+  if (posScreen == NOPOINTF) {
+    return QRectF();
+  }
+
+  // the icon is hit within a manhattan length of 22, the radius within +/- 22
+  const qreal d = (radius == NOFLOAT) ? 22 : qMax(qreal(22), radius + 22);
+  return QRectF(posScreen - QPointF(d, d), QSizeF(2 * d, 2 * d));
+}
+
 bool CGisItemWpt::isWithin(const QRectF& area, selflags_t flags) {
   return (flags & eSelectionWpt) ? area.contains(QPointF(wpt.lon, wpt.lat)) : false;
 }
@@ -541,7 +552,7 @@ void CGisItemWpt::editInitial() {
   squashHistory();
 }
 
-void CGisItemWpt::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) {
+void CGisItemWpt::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) {
   posScreen = QPointF(wpt.lon * DEG_TO_RAD, wpt.lat * DEG_TO_RAD);
 
   if (proximity == NOFLOAT || proximity == 0. ? !isVisible(posScreen, viewport, gis)
@@ -566,7 +577,7 @@ void CGisItemWpt::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>
 
   p.drawPixmap(posScreen - focus, icon);
 
-  blockedAreas << QRectF(posScreen - focus, icon.size());
+  blockedAreas.insert(QRectF(posScreen - focus, icon.size()));
 }
 
 void CGisItemWpt::drawItem(QPainter& p, const QRectF& /*viewport*/, CGisDraw* gis) {
@@ -597,7 +608,7 @@ void CGisItemWpt::drawItem(QPainter& p, const QRectF& /*viewport*/, CGisDraw* gi
   }
 }
 
-void CGisItemWpt::drawLabel(QPainter& p, const QPolygonF& /*viewport*/, QList<QRectF>& blockedAreas,
+void CGisItemWpt::drawLabel(QPainter& p, const QPolygonF& /*viewport*/, COccupancyGrid& blockedAreas,
                             const QFontMetricsF& fm, CGisDraw* /*gis*/) {
   if (flags & eFlagWptBubble) {
     return;
@@ -632,7 +643,7 @@ void CGisItemWpt::drawLabel(QPainter& p, const QPolygonF& /*viewport*/, QList<QR
   }
 
   CDraw::text(wpt.name, p, rect.toRect(), Qt::darkBlue);
-  blockedAreas << rect;
+  blockedAreas.insert(rect);
 }
 
 void CGisItemWpt::drawHighlight(QPainter& p) {
@@ -246,12 +246,13 @@ class CGisItemWpt : public IGisItem {
 
   QPointF getPointCloseBy(const QPoint& point) override;
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CGisDraw* gis) override;
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CGisDraw* gis) override;
   void drawItem(QPainter& p, const QRectF& viewport, CGisDraw* gis) override;
-  void drawLabel(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, const QFontMetricsF& fm,
+  void drawLabel(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, const QFontMetricsF& fm,
                  CGisDraw* gis) override;
   void drawHighlight(QPainter& p) override;
   bool isCloseTo(const QPointF& pos) override;
+  QRectF getScreenArea() const override;
   bool isWithin(const QRectF& area, selflags_t flags) override;
   void mouseMove(const QPointF& pos) override;
   void mouseDragged(const QPoint& start, const QPoint& last, const QPoint& pos);
@@ -25,6 +25,9 @@
 #include <QRectF>
 
 #include "CMainWindow.h"
+
+class COccupancyGrid;
+
 inline void USE_ANTI_ALIASING(QPainter& p, bool useAntiAliasing) {
   p.setRenderHints(QPainter::TextAntialiasing | QPainter::Antialiasing | QPainter::SmoothPixmapTransform,
                    useAntiAliasing);
@@ -104,7 +107,14 @@ class CDraw {
    */
   static QPoint bubble(QPainter& p, const QRect& contentRect, const QPoint& pointerPos, const QColor& background);
 
-  static bool doesOverlap(const QList<QRectF>& blockedAreas, const QRectF& rect);
+  /**
+     @brief Test if a rectangle overlaps with any of the blocked areas
+
+     @param blockedAreas  the grid of already occupied areas
+     @param rect          the rectangle to test
+     @return Return true if the rectangle overlaps.
+   */
+  static bool doesOverlap(const COccupancyGrid& blockedAreas, const QRectF& rect);
 
   /**
      @brief   Creates a new arrow using the brush specified
@@ -0,0 +1,114 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#include "helpers/COccupancyGrid.h"
+
+#include <QtMath>
+#include <algorithm>
+
+COccupancyGrid::COccupancyGrid(const QRectF& area, qreal cellSize) { reset(area, cellSize); }
+
+void COccupancyGrid::reset(const QRectF& area, qreal cellSize) {
+  this->area = area.normalized();
+  this->cellSize = qMax(cellSize, qreal(1.0));
+
+  cols = qBound(1, qCeil(this->area.width() / this->cellSize), 1024);
+  rows = qBound(1, qCeil(this->area.height() / this->cellSize), 1024);
+
+  cells = QVector<QVector<qint32>>(cols * rows);
+  rects.clear();
+}
+
+void COccupancyGrid::clear() {
+  for (QVector<qint32>& cell : cells) {
+    cell.clear();
+  }
+  rects.clear();
+}
+
+void COccupancyGrid::getCells(const QRectF& rect, qint32& x1, qint32& y1, qint32& x2, qint32& y2) const {
+  const QRectF& r = rect.normalized();
+  x1 = qBound(0, qFloor((r.left() - area.left()) / cellSize), cols - 1);
+  x2 = qBound(0, qFloor((r.right() - area.left()) / cellSize), cols - 1);
+  y1 = qBound(0, qFloor((r.top() - area.top()) / cellSize), rows - 1);
+  y2 = qBound(0, qFloor((r.bottom() - area.top()) / cellSize), rows - 1);
+}
+
+qint32 COccupancyGrid::insert(const QRectF& rect) {
+  const qint32 idx = rects.count();
+  rects << rect;
+
+  qint32 x1, y1, x2, y2;
+  getCells(rect, x1, y1, x2, y2);
+  for (qint32 y = y1; y <= y2; y++) {
+    for (qint32 x = x1; x <= x2; x++) {
+      cells[y * cols + x] << idx;
+    }
+  }
+  return idx;
+}
+
+bool COccupancyGrid::insertIfFree(const QRectF& rect) {
+  if (intersects(rect)) {
+    return false;
+  }
+  insert(rect);
+  return true;
+}
+
+qint32 COccupancyGrid::findFirst(const QRectF& rect) const {
+  qint32 result = NOIDX;
+
+  qint32 x1, y1, x2, y2;
+  getCells(rect, x1, y1, x2, y2);
+  for (qint32 y = y1; y <= y2; y++) {
+    for (qint32 x = x1; x <= x2; x++) {
+      // the indices of a cell are sorted. The first hit is the lowest index of this cell.
+      for (qint32 idx : cells[y * cols + x]) {
+        if ((result != NOIDX) && (idx >= result)) {
+          break;
+        }
+        if (rects[idx].intersects(rect)) {
+          result = idx;
+          break;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+void COccupancyGrid::findAll(const QRectF& rect, QVector<qint32>& result) const {
+  result.clear();
+
+  qint32 x1, y1, x2, y2;
+  getCells(rect, x1, y1, x2, y2);
+  for (qint32 y = y1; y <= y2; y++) {
+    for (qint32 x = x1; x <= x2; x++) {
+      for (qint32 idx : cells[y * cols + x]) {
+        if (rects[idx].intersects(rect)) {
+          result << idx;
+        }
+      }
+    }
+  }
+
+  // a rectangle touching several cells is found several times
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+}
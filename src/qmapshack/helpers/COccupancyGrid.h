@@ -0,0 +1,107 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#ifndef COCCUPANCYGRID_H
+#define COCCUPANCYGRID_H
+
+#include <QRectF>
+#include <QVector>
+
+#include "units/IUnit.h"
+
+/**
+   @brief A uniform screen grid to find overlapping rectangles
+
+   Labels and icons are de-cluttered by testing each new rectangle against all
+   rectangles placed so far. To avoid a test against every placed rectangle the
+   screen area is divided into square cells. Each cell holds the index of all
+   rectangles touching it. A query only has to test the rectangles registered in
+   the cells covered by the query rectangle.
+
+   Rectangles outside the grid's area are registered in the border cells. Thus
+   the result is always correct, only slower for rectangles far off the area.
+ */
+class COccupancyGrid {
+ public:
+  /**
+     @brief Create a grid
+
+     @param area      the screen area covered by the grid in [px]
+     @param cellSize  the edge length of a cell in [px]
+   */
+  COccupancyGrid(const QRectF& area = QRectF(), qreal cellSize = 64);
+  virtual ~COccupancyGrid() = default;
+
+  /// remove all rectangles and setup the grid for a new area
+  void reset(const QRectF& area, qreal cellSize = 64);
+  /// remove all rectangles but keep the grid
+  void clear();
+
+  /**
+     @brief Add a rectangle to the grid
+
+     @param rect  the rectangle in [px]
+     @return The index of the rectangle. Indices are given in ascending order starting with 0.
+   */
+  qint32 insert(const QRectF& rect);
+
+  /**
+     @brief Add a rectangle only if it does not overlap with any other rectangle
+
+     @param rect  the rectangle in [px]
+     @return Return true if the rectangle has been added.
+   */
+  bool insertIfFree(const QRectF& rect);
+
+  /// test if the rectangle overlaps with any of the registered rectangles
+  bool intersects(const QRectF& rect) const { return findFirst(rect) != NOIDX; }
+
+  /**
+     @brief Find the oldest rectangle overlapping with the query
+
+     @param rect  the query rectangle in [px]
+     @return The lowest index of all overlapping rectangles or NOIDX.
+   */
+  qint32 findFirst(const QRectF& rect) const;
+
+  /**
+     @brief Find all rectangles overlapping with the query
+
+     @param rect    the query rectangle in [px]
+     @param result  the indices of the rectangles in ascending order
+   */
+  void findAll(const QRectF& rect, QVector<qint32>& result) const;
+
+  const QRectF& rect(qint32 idx) const { return rects[idx]; }
+  qint32 count() const { return rects.count(); }
+
+ private:
+  void getCells(const QRectF& rect, qint32& x1, qint32& y1, qint32& x2, qint32& y2) const;
+
+  QRectF area;
+  qreal cellSize = 64;
+  qint32 cols = 1;
+  qint32 rows = 1;
+
+  /// indices of rectangles touching a cell, row by row
+  QVector<QVector<qint32>> cells;
+  /// all registered rectangles in order of insertion
+  QVector<QRectF> rects;
+};
+
+#endif  // COCCUPANCYGRID_H
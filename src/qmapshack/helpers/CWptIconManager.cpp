@@ -56,6 +56,7 @@ QPixmap CWptIconManager::createGrayscale(QString path) {
 }
 
 void CWptIconManager::init() {
+  mutex.lock();
   wptIcons.clear();
 
   wptIcons["Default"] = icon_t(wptDefault, 16, 16);
@@ -157,6 +158,7 @@ void CWptIconManager::init() {
   wptIcons["Lodge"] = icon_t("://icons/poi/SJJB/png/accommodation_shelter.n.32.png", 16, 16);
   wptIcons["Railway"] = icon_t("://icons/poi/SJJB/png/transport_train_station.n.32.png", 16, 16);
   wptIcons["Parking, Pay"] = icon_t("://icons/poi/SJJB/png/transport_parking_car_paid.n.32.png", 16, 16);
+  mutex.unlock();
 
   setWptIconByName("Traditional Cache", "://icons/geocaching/icons/traditional.png");
   setWptIconByName("Multi-cache", "://icons/geocaching/icons/multi.png");
@@ -199,6 +201,7 @@ void CWptIconManager::init() {
 
 void CWptIconManager::setWptIconByName(const QString& name, const QString& filename) {
   QPixmap icon(filename);
+  QMutexLocker lock(&mutex);
   wptIcons[name] = icon_t(filename, icon.width() >> 1, icon.height() >> 1);
 }
 
@@ -209,6 +212,7 @@ void CWptIconManager::setWptIconByName(const QString& name, const QPixmap& icon)
   QString filename = dirIcon.filePath(name + ".png");
 
   icon.save(filename);
+  QMutexLocker lock(&mutex);
   wptIcons[name] = icon_t(filename, icon.width() >> 1, icon.height() >> 1);
 }
 
@@ -227,12 +231,18 @@ QPixmap CWptIconManager::getWptIconByName(const QString& name, QPointF& focus, Q
   QPixmap icon;
   QString path;
 
-  if (wptIcons.contains(name)) {
-    focus = wptIcons[name].focus;
-    path = wptIcons[name].path;
-  } else {
-    focus = wptIcons["Default"].focus;
-    path = wptIcons["Default"].path;
+  {
+    // use const access only, the non-const operator[] might detach or insert
+    QMutexLocker lock(&mutex);
+    const QMap<QString, icon_t>& icons = wptIcons;
+    auto entry = icons.constFind(name);
+    if (entry == icons.constEnd()) {
+      entry = icons.constFind("Default");
+    }
+    if (entry != icons.constEnd()) {
+      focus = entry->focus;
+      path = entry->path;
+    }
   }
 
   if (path.isEmpty()) {
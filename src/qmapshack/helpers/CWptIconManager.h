@@ -23,6 +23,7 @@
 #include <QFont>
 #include <QMap>
 #include <QMenu>
+#include <QMutex>
 #include <QObject>
 #include <QPoint>
 #include <QString>
@@ -43,6 +44,17 @@ class CWptIconManager : public QObject {
   };
 
   void init();
+  /**
+     @brief Get the icon of a waypoint symbol
+
+     This is thread safe. Items created by worker threads (e.g. loading projects from a device)
+     call it, too.
+
+     @param name   the symbol's name
+     @param focus  returns the icon's focus point
+     @param src    returns the icon's source file if not nullptr
+     @return The icon scaled to 22 pixel max.
+   */
   QPixmap getWptIconByName(const QString& name, QPointF& focus, QString* src = nullptr);
   QString selectWptIcon(QWidget* parent);
 
@@ -67,6 +79,8 @@ class CWptIconManager : public QObject {
 
   QFont lastFont;
 
+  /// guards wptIcons as it is read by worker threads, too. It is only changed by the main thread.
+  QMutex mutex;
   QMap<QString, icon_t> wptIcons;
 
   QMap<qint32, QString> mapNumberedBullets;
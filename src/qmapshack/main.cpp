@@ -22,11 +22,19 @@
 
 #include "CMainWindow.h"
 #include "CSingleInstanceProxy.h"
+#include "print/CTiledMapExport.h"
 #include "setup/CAppOpts.h"
 #include "setup/IAppSetup.h"
 #include "version.h"
 
 int main(int argc, char** argv) {
+  // the headless mode must not depend on a display
+  for (int i = 1; i < argc; i++) {
+    if (qstrcmp(argv[i], "--export-view") == 0 || qstrncmp(argv[i], "--export-view=", 14) == 0) {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+  }
+
   QApplication app(argc, argv);
 
   QCoreApplication::setApplicationName("QMapShack");
@@ -41,6 +49,11 @@ int main(int argc, char** argv) {
   // setup default proxy
   QNetworkProxyFactory::setUseSystemConfiguration(true);
 
+  // headless mode: render a view into an image file and exit
+  if (!qlOpts->exportView.isEmpty()) {
+    return CTiledMapExport::execCommandLine();
+  }
+
   // make sure this is the one and only instance on the system
   CSingleInstanceProxy s(qlOpts->arguments);
 
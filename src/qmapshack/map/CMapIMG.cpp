@@ -20,6 +20,7 @@
 
 #include <QPainterPath>
 #include <QtWidgets>
+#include <algorithm>
 
 #include "CMainWindow.h"
 #include "canvas/CCanvas.h"
@@ -104,15 +105,7 @@ static inline QImage img2line(const QImage& img, int width) {
   return newImage;
 }
 
-static inline bool isCluttered(QVector<QRectF>& rectPois, const QRectF& rect) {
-  for (const QRectF& rectPoi : rectPois) {
-    if (rect.intersects(rectPoi)) {
-      return true;
-    }
-  }
-  rectPois << rect;
-  return false;
-}
+static inline bool isCluttered(COccupancyGrid& rectPois, const QRectF& rect) { return !rectPois.insertIfFree(rect); }
 
 CMapIMG::CMapIMG(const QString& filename, CMapDraw* parent)
     : IMap(eFeatVisibility | eFeatVectorItems | eFeatTypFile, parent),
@@ -1141,7 +1134,6 @@ void CMapIMG::draw(IDrawContext::buffer_t& buf) /* override */
   qreal v2 = qMin(buf.ref4.y(), buf.ref3.y());
 
   QRectF viewport(u1, v1, u2 - u1, v2 - v1);
-  QVector<QRectF> rectPois;
 
   polygons.clear();
   polylines.clear();
@@ -1160,6 +1152,10 @@ void CMapIMG::draw(IDrawContext::buffer_t& buf) /* override */
   p.save();
   p.translate(-pp);
 
+  // the buffer's area in screen coordinates
+  const QRectF area(pp, buf.image.size());
+  COccupancyGrid rectPois(area);
+
   if (map->needsRedraw()) {
     p.restore();
     return;
@@ -1207,6 +1203,7 @@ void CMapIMG::draw(IDrawContext::buffer_t& buf) /* override */
     p.restore();
     return;
   }
+  placeLabels(area);
   drawLabels(p, labels);
 
   p.restore();
@@ -1787,16 +1784,6 @@ void CMapIMG::collectText(const CGarminPolygon& item, const QPolygonF& line, con
   textpaths << tp;
 }
 
-bool CMapIMG::intersectsWithExistingLabel(const QRect& rect) const {
-  for (const strlbl_t& label : labels) {
-    if (label.rect.intersects(rect)) {
-      return true;
-    }
-  }
-
-  return false;
-}
-
 void CMapIMG::addLabel(const CGarminPoint& pt, const QRect& rect, CGarminTyp::label_type_e type) {
   QString str;
   if (pt.hasLabel()) {
@@ -1809,9 +1796,44 @@ void CMapIMG::addLabel(const CGarminPoint& pt, const QRect& rect, CGarminTyp::la
   strlbl.str = str;
   strlbl.rect = rect;
   strlbl.type = type;
+
+  // large labels are placed first, small labels last
+  switch (type) {
+    case CGarminTyp::eLarge:
+      strlbl.priority = 3 << 16;
+      break;
+
+    case CGarminTyp::eSmall:
+      strlbl.priority = 1 << 16;
+      break;
+
+    default:
+      strlbl.priority = 2 << 16;
+  }
+
+  // city types 0x0100..0x11ff are ordered by size, the lower the type the larger the city
+  if ((pt.type >= 0x0100) && (pt.type < 0x1200)) {
+    strlbl.priority += 0x1200 - pt.type;
+  }
+}
+
+void CMapIMG::placeLabels(const QRectF& area) {
+  // keep the order of drawing for labels of same priority
+  std::stable_sort(labels.begin(), labels.end(),
+                   [](const strlbl_t& l1, const strlbl_t& l2) { return l1.priority > l2.priority; });
+
+  COccupancyGrid grid(area);
+  QVector<strlbl_t> placed;
+  placed.reserve(labels.size());
+  for (const strlbl_t& label : qAsConst(labels)) {
+    if (grid.insertIfFree(label.rect)) {
+      placed << label;
+    }
+  }
+  labels.swap(placed);
 }
 
-void CMapIMG::drawPoints(QPainter& p, pointtype_t& pts, QVector<QRectF>& rectPois) {
+void CMapIMG::drawPoints(QPainter& p, pointtype_t& pts, COccupancyGrid& rectPois) {
   pointtype_t::iterator pt = pts.begin();
   while (pt != pts.end()) {
     //        if((pt->type > 0x1600) && (zoomFactor > CResources::self().getZoomLevelThresholdPois()))
@@ -1851,16 +1873,14 @@ void CMapIMG::drawPoints(QPainter& p, pointtype_t& pts, QVector<QRectF>& rectPoi
       rect.adjust(0, 0, 4, 4);
       rect.moveCenter(pt->pos.toPoint());
 
-      // if no intersection was found, add label to list
-      if (!intersectsWithExistingLabel(rect)) {
-        addLabel(*pt, rect, CGarminTyp::eStandard);
-      }
+      // collisions are resolved by placeLabels()
+      addLabel(*pt, rect, CGarminTyp::eStandard);
     }
     ++pt;
   }
 }
 
-void CMapIMG::drawPois(QPainter& p, pointtype_t& pts, QVector<QRectF>& rectPois) {
+void CMapIMG::drawPois(QPainter& p, pointtype_t& pts, COccupancyGrid& rectPois) {
   CGarminTyp::label_type_e labelType = CGarminTyp::eStandard;
 
   for (CGarminPoint& pt : pts) {
@@ -1893,10 +1913,8 @@ void CMapIMG::drawPois(QPainter& p, pointtype_t& pts, QVector<QRectF>& rectPois)
       rect.adjust(0, 0, 4, 4);
       rect.moveCenter(pt.pos.toPoint());
 
-      // if no intersection was found, add label to list
-      if (!intersectsWithExistingLabel(rect)) {
-        addLabel(pt, rect, labelType);
-      }
+      // collisions are resolved by placeLabels()
+      addLabel(pt, rect, labelType);
     }
   }
 }
@@ -21,6 +21,7 @@
 
 #include <QMap>
 
+#include "helpers/COccupancyGrid.h"
 #include "map/IMap.h"
 #include "map/garmin/CGarminPoint.h"
 #include "map/garmin/CGarminPolygon.h"
@@ -151,6 +152,8 @@ class CMapIMG : public IMap {
     QRect rect;
     QString str;
     CGarminTyp::label_type_e type = CGarminTyp::eStandard;
+    /// labels with higher priority are placed first
+    qint32 priority = 0;
   };
 
   quint8 scale2bits(const QPointF& scale);
@@ -164,12 +167,12 @@ class CMapIMG : public IMap {
   void loadSubDiv(CFileExt& file, const subdiv_desc_t& subdiv, IGarminStrTbl* strtbl, const QByteArray& rgndata,
                   bool fast, const QRectF& viewport, polytype_t& polylines, polytype_t& polygons, pointtype_t& points,
                   pointtype_t& pois);
-  bool intersectsWithExistingLabel(const QRect& rect) const;
   void addLabel(const CGarminPoint& pt, const QRect& rect, CGarminTyp::label_type_e type);
+  void placeLabels(const QRectF& area);
   void drawPolygons(QPainter& p, polytype_t& lines);
   void drawPolylines(QPainter& p, polytype_t& lines, const QPointF& scale);
-  void drawPoints(QPainter& p, pointtype_t& pts, QVector<QRectF>& rectPois);
-  void drawPois(QPainter& p, pointtype_t& pts, QVector<QRectF>& rectPois);
+  void drawPoints(QPainter& p, pointtype_t& pts, COccupancyGrid& rectPois);
+  void drawPois(QPainter& p, pointtype_t& pts, COccupancyGrid& rectPois);
   void drawLabels(QPainter& p, const QVector<strlbl_t>& lbls);
   void drawText(QPainter& p);
 
@@ -64,6 +64,7 @@ void CMouseEditArea::slotCopyToOrig() {
 
 void CMouseEditArea::slotCopyToNew() {
   canvas->reportStatus(key.item, "");
+  finishRouting();
 
   if (points.size() < 3) {
     return;
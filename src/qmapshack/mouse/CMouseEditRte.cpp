@@ -71,6 +71,7 @@ void CMouseEditRte::slotCopyToOrig() {
 
 void CMouseEditRte::slotCopyToNew() {
   canvas->reportStatus(key.item, "");
+  finishRouting();
 
   if (points.size() < 2) {
     return;
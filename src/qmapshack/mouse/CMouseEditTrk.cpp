@@ -84,6 +84,7 @@ void CMouseEditTrk::slotCopyToOrig() {
 
 void CMouseEditTrk::slotCopyToNew() {
   canvas->reportStatus(key.item, "");
+  finishRouting();
 
   if (points.size() < 2) {
     return;
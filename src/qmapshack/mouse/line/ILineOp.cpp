@@ -25,7 +25,6 @@
 #include "gis/CGisDraw.h"
 #include "gis/CGisWorkspace.h"
 #include "gis/GeoMath.h"
-#include "gis/rte/router/CRouterSetup.h"
 #include "mouse/line/IMouseEditLine.h"
 
 struct segment_t {
@@ -316,21 +315,9 @@ void ILineOp::showRoutingErrorMessage(const QString& msg) const {
 }
 
 void ILineOp::tryRouting(IGisLine::point_t& pt1, IGisLine::point_t& pt2) const {
-  QPolygonF subs;
-
-  try {
-    if (CRouterSetup::self().calcRoute(pt1.coord, pt2.coord, subs) >= 0) {
-      pt1.subpts.clear();
-      for (const QPointF& sub : qAsConst(subs)) {
-        pt1.subpts << IGisLine::subpt_t(sub);
-      }
-    }
-    showRoutingErrorMessage(QString());
-  } catch (const QString& msg) {
-    showRoutingErrorMessage(msg);
-  }
-  // that is a workaround for canvas loosing mouse tracking caused by CProgressDialog being modal:
-  canvas->setMouseTracking(true);
+  // the segment is drawn as straight line until the route arrives
+  pt1.subpts.clear();
+  parentHandler->startRouting(pt1.coord, pt2.coord);
 }
 
 void ILineOp::finalizeOperation(qint32 idx) {
@@ -339,7 +326,6 @@ void ILineOp::finalizeOperation(qint32 idx) {
   }
 
   if (parentHandler->useAutoRouting()) {
-    CCanvasCursorLock cursorLock(Qt::WaitCursor, __func__);
     if (idx > 0) {
       tryRouting(points[idx - 1], points[idx]);
     }
@@ -27,6 +27,7 @@
 #include "gis/GeoMath.h"
 #include "gis/IGisLine.h"
 #include "gis/rte/router/CRouterOptimization.h"
+#include "gis/rte/router/CRouterSetup.h"
 #include "gis/trk/CGisItemTrk.h"
 #include "helpers/CDraw.h"
 #include "helpers/CSettings.h"
@@ -62,6 +63,10 @@ IMouseEditLine::IMouseEditLine(const IGisItem::key_t& key, IGisLine& src, bool e
 }
 
 IMouseEditLine::~IMouseEditLine() {
+  if (idRouting != 0) {
+    CRouterSetup::self().abortRouteAsync(idRouting);
+  }
+
   canvas->reportStatus("IMouseEditLine", "");
   canvas->reportStatus(key.item, "");
   canvas->reportStatus("Optimization", "");
@@ -104,6 +109,8 @@ void IMouseEditLine::commonSetup() {
   connect(scrOptEditLine->toolUndo, &QPushButton::clicked, this, &IMouseEditLine::slotUndo);
   connect(scrOptEditLine->toolRedo, &QPushButton::clicked, this, &IMouseEditLine::slotRedo);
 
+  connect(&CRouterSetup::self(), &CRouterSetup::sigRouteFinished, this, &IMouseEditLine::slotRouteFinished);
+
   SETTINGS;
   int mode = cfg.value("Route/drawMode", 0).toInt();
   switch (mode) {
@@ -364,6 +371,8 @@ void IMouseEditLine::slotAbortEx(bool showMB) {
 }
 
 void IMouseEditLine::slotCopyToOrig() {
+  finishRouting();
+
   QMutexLocker lock(&IGisItem::mutexItems);
 
   IGisLine* line = getGisLine();
@@ -435,6 +444,122 @@ void IMouseEditLine::slotRedo() {
   updateStatus();
 }
 
+void IMouseEditLine::startRouting(const QPointF& coord1, const QPointF& coord2) {
+  segmentsToRoute << segment_t{coord1, coord2};
+  startNextRouting();
+}
+
+void IMouseEditLine::startNextRouting() {
+  // drop all requests that have become obsolete
+  auto isObsolete = [this](const segment_t& segment) { return findSegment(points, segment) == NOIDX; };
+  segmentsToRoute.erase(std::remove_if(segmentsToRoute.begin(), segmentsToRoute.end(), isObsolete),
+                        segmentsToRoute.end());
+
+  if (idRouting != 0) {
+    // The next request is started as soon as the running one has finished.
+    if (!isObsolete(segmentRouting)) {
+      return;
+    }
+    // The result of an aborted request is ignored. Do not wait for it.
+    CRouterSetup::self().abortRouteAsync(idRouting);
+    idRouting = 0;
+  }
+
+  if (segmentsToRoute.isEmpty()) {
+    return;
+  }
+
+  segmentRouting = segmentsToRoute.takeFirst();
+  idRouting = CRouterSetup::self().calcRouteAsync(segmentRouting.coord1, segmentRouting.coord2);
+  if (idRouting == 0) {
+    // the router is not able to take requests, keep all segments as straight lines
+    segmentsToRoute.clear();
+  }
+}
+
+void IMouseEditLine::finishRouting() {
+  if (idRouting != 0) {
+    // replace the running request by a blocking one
+    CRouterSetup::self().abortRouteAsync(idRouting);
+    idRouting = 0;
+    segmentsToRoute.prepend(segmentRouting);
+  }
+
+  const QList<segment_t> segments = segmentsToRoute;
+  segmentsToRoute.clear();
+
+  for (const segment_t& segment : segments) {
+    if (findSegment(points, segment) == NOIDX) {
+      continue;
+    }
+
+    QPolygonF coords;
+    try {
+      CRouterSetup::self().calcRoute(segment.coord1, segment.coord2, coords);
+    } catch (const QString& msg) {
+      coords.clear();
+      if (lineOp != nullptr) {
+        lineOp->showRoutingErrorMessage(msg);
+      }
+    }
+
+    if (!coords.isEmpty()) {
+      applyRoute(points, segment, coords);
+      if (idxHistory != NOIDX) {
+        applyRoute(history[idxHistory], segment, coords);
+      }
+    }
+  }
+}
+
+void IMouseEditLine::slotRouteFinished(quint32 id, const QPolygonF& coords, const QString& error) {
+  if (id == 0 || id != idRouting) {
+    return;
+  }
+  idRouting = 0;
+
+  if (findSegment(points, segmentRouting) != NOIDX) {
+    if (lineOp != nullptr) {
+      lineOp->showRoutingErrorMessage(error);
+    }
+
+    if (!coords.isEmpty()) {
+      applyRoute(points, segmentRouting, coords);
+      // the history entry of the current state has been stored with a straight segment
+      if (idxHistory != NOIDX) {
+        applyRoute(history[idxHistory], segmentRouting, coords);
+      }
+
+      canvas->slotTriggerCompleteUpdate(CCanvas::eRedrawMouse);
+      updateStatus();
+    }
+  }
+
+  startNextRouting();
+}
+
+qint32 IMouseEditLine::findSegment(const SGisLine& line, const segment_t& segment) {
+  for (int i = 0; i < line.size() - 1; i++) {
+    if (line[i].coord == segment.coord1 && line[i + 1].coord == segment.coord2) {
+      return i;
+    }
+  }
+  return NOIDX;
+}
+
+void IMouseEditLine::applyRoute(SGisLine& line, const segment_t& segment, const QPolygonF& coords) {
+  const qint32 idx = findSegment(line, segment);
+  if (idx == NOIDX) {
+    return;
+  }
+
+  IGisLine::point_t& pt = line[idx];
+  pt.subpts.clear();
+  for (const QPointF& sub : coords) {
+    pt.subpts << IGisLine::subpt_t(sub);
+  }
+}
+
 void IMouseEditLine::updateStatus() {
   if (!enableStatus || points.isEmpty()) {
     canvas->reportStatus("IMouseEditLine", QString());
@@ -76,6 +76,25 @@ class IMouseEditLine : public IMouse {
   void storeToHistory(const SGisLine& line);
   void restoreFromHistory(SGisLine& line);
 
+  /**
+     @brief Queue the segment between two points for routing
+
+     The route is calculated asynchronously. Until it is done the segment is drawn
+     as straight line. Requests for segments that do not exist anymore, e.g. because
+     a point has been moved again, are dropped.
+
+     @param coord1  the start point of the segment in [rad]
+     @param coord2  the end point of the segment in [rad]
+   */
+  void startRouting(const QPointF& coord1, const QPointF& coord2);
+  /**
+     @brief Calculate all queued and running routing requests in a blocking way
+
+     Call this before the line is stored. Otherwise segments waiting for their
+     route are stored as straight lines.
+   */
+  void finishRouting();
+
   virtual void updateStatus();
 
  protected slots:
@@ -111,6 +130,9 @@ class IMouseEditLine : public IMouse {
   void slotUndo();
   void slotRedo();
 
+ private slots:
+  void slotRouteFinished(quint32 id, const QPolygonF& coords, const QString& error);
+
  protected:
   virtual void drawLine(const QPolygonF& l, const QColor color, int width, QPainter& p);
   /**
@@ -145,6 +167,17 @@ class IMouseEditLine : public IMouse {
   void commonSetup();
   void changeCursor();
 
+  struct segment_t {
+    QPointF coord1;
+    QPointF coord2;
+  };
+
+  /// start the next queued routing request if none is running
+  void startNextRouting();
+  /// @return The index of the segment's start point in line or NOIDX
+  static qint32 findSegment(const SGisLine& line, const segment_t& segment);
+  static void applyRoute(SGisLine& line, const segment_t& segment, const QPolygonF& coords);
+
   QPolygonF pixelLine;
   QPolygonF pixelPts;
   QPolygonF pixelSubs;
@@ -157,6 +190,13 @@ class IMouseEditLine : public IMouse {
   QString type;
 
   CRouterOptimization optimizer;
+
+  /// segments waiting for routing
+  QList<segment_t> segmentsToRoute;
+  /// the segment currently routed
+  segment_t segmentRouting;
+  /// the id of the running routing request, 0 if there is none
+  quint32 idRouting = 0;
 };
 
 #endif  // IMOUSEEDITLINE_H
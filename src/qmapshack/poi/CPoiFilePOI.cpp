@@ -32,6 +32,17 @@
 #include "poi/IPoiFile.h"
 #include "poi/IPoiItem.h"
 
+// the number of cells around the viewport loaded in advance
+#define PREFETCH_CELLS 1
+// the maximum number of POIs kept in memory
+#define MAX_CACHED_POIS 250000
+// the maximum number of POIs with full tag data kept in memory
+#define MAX_CACHED_DETAILS 100
+// groups up to this size are hovered with full tag data, it is the number of POIs the context menu offers to add
+#define MAX_HOVER_DETAILS 5
+// SQLite limits the number of parameters of a statement
+#define MAX_QUERY_KEYS 500
+
 CPoiFilePOI::CPoiFilePOI(const QString& filename, CPoiDraw* parent)
     : IPoiFile(parent), filename(filename), loadTimer(new QTimer(this)) {
   // Set true if the file could be open and loaded successfully
@@ -43,6 +54,13 @@ CPoiFilePOI::CPoiFilePOI(const QString& filename, CPoiDraw* parent)
   loadTimer->setInterval(500);
   connect(loadTimer, &QTimer::timeout, poi, &CPoiDraw::emitSigCanvasUpdate);
 
+  // SQLite has to be queried sequentially anyway
+  threadPool.setMaxThreadCount(1);
+
+  // the cost of a cell is the number of it's POIs
+  cellsCache.setMaxCost(MAX_CACHED_POIS);
+  detailsCache.setMaxCost(MAX_CACHED_DETAILS);
+
   // Open database here so it belongs to the right thread
   if (!QSqlDatabase::contains(filename + "_bbox")) {
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", filename + "_bbox");
@@ -71,6 +89,8 @@ CPoiFilePOI::CPoiFilePOI(const QString& filename, CPoiDraw* parent)
   QSqlDatabase::removeDatabase(filename + "_bbox");
 }
 
+CPoiFilePOI::~CPoiFilePOI() { threadPool.waitForDone(); }
+
 void CPoiFilePOI::draw(IDrawContext::buffer_t& buf) {
   // !!!! NOTE !!!!
   // This is running in it's own thread, not the main thread.
@@ -108,49 +128,49 @@ void CPoiFilePOI::draw(IDrawContext::buffer_t& buf) {
     xMax = 180 * DEG_TO_RAD;
   }
 
+  // the cells in view
+  const QRect cellsView(QPoint(qFloor(xMin * RAD_TO_DEG * 10), qFloor(yMin * RAD_TO_DEG * 10)),
+                        QPoint(qCeil(xMax * RAD_TO_DEG * 10) - 1, qCeil(yMax * RAD_TO_DEG * 10) - 1));
+
   // draw POI
   QMutexLocker lock(&mutex);
+  const QList<quint64>& categories = getActivatedCategories();
+  // Missing cells are loaded in the background. They are drawn with the redraw triggered by the loader.
+  requestCells(cellsView.adjusted(-PREFETCH_CELLS, -PREFETCH_CELLS, PREFETCH_CELLS, PREFETCH_CELLS), categories);
+
   displayedPois.clear();
+  gridPois.reset(QRectF(pp, buf.image.size()), IPoiFile::iconSize().width() * 2);
   QRectF freeSpaceRect(QPointF(), IPoiFile::iconSize() * 2);
   // Find POIs in view
-  const QList<quint64>& keys = categoryActivated.keys();
-  for (quint64 categoryID : keys) {
-    if (categoryActivated[categoryID] != Qt::Checked) {
-      continue;
-    }
-    for (int minLonM10 = qFloor(xMin * RAD_TO_DEG * 10); minLonM10 < qCeil(xMax * RAD_TO_DEG * 10); minLonM10++) {
-      for (int minLatM10 = qFloor(yMin * RAD_TO_DEG * 10); minLatM10 < qCeil(yMax * RAD_TO_DEG * 10); minLatM10++) {
-        if (!loadedPoisByArea.contains(categoryID) || !loadedPoisByArea[categoryID].contains(minLonM10) ||
-            !loadedPoisByArea[categoryID][minLonM10].contains(minLatM10)) {
-          loadPOIsFromFile(categoryID, minLonM10, minLatM10);
-        }
+  for (quint64 categoryID : categories) {
+    for (int minLonM10 = cellsView.left(); minLonM10 <= cellsView.right(); minLonM10++) {
+      for (int minLatM10 = cellsView.top(); minLatM10 <= cellsView.bottom(); minLatM10++) {
         if (poi->needsRedraw()) {
           return;
         }
-        for (quint64 poiToDrawID : qAsConst(loadedPoisByArea)[categoryID][minLonM10][minLatM10]) {
-          const CPoiItemPOI& poiToDraw = loadedPois[poiToDrawID];
-          QPointF pt = poiToDraw.getCoordinates();
+        const QVector<poiRecord_t>* records = cellsCache.object({categoryID, minLonM10, minLatM10});
+        if (records == nullptr) {
+          continue;
+        }
+        for (const poiRecord_t& poiToDraw : *records) {
+          QPointF pt = poiToDraw.coordinates;
           poi->convertRad2Px(pt);
 
           freeSpaceRect.moveCenter(pt);
 
-          bool foundIntersection = false;
-          for (poiGroup_t& poiGroup : displayedPois) {
-            if (poiGroup.iconLocation.intersects(freeSpaceRect)) {
-              foundIntersection = true;
-              poiGroup.pois.insert(poiToDrawID);
-              break;
-            }
-          }
-
-          if (!foundIntersection) {
+          // join the first group close by
+          const qint32 idx = gridPois.findFirst(freeSpaceRect);
+          if (idx != NOIDX) {
+            displayedPois[idx].pois.insert(poiToDraw.key, poiToDraw);
+          } else {
             poiGroup_t poiGroup;
             QRectF iconRect(QPointF(), IPoiFile::iconSize());
             iconRect.moveCenter(pt);
             poiGroup.iconLocation = iconRect;
-            poiGroup.iconCenter = poiToDraw.getCoordinates();
-            poiGroup.pois.insert(poiToDrawID);
+            poiGroup.iconCenter = poiToDraw.coordinates;
+            poiGroup.pois.insert(poiToDraw.key, poiToDraw);
             displayedPois.append(poiGroup);
+            gridPois.insert(iconRect);
           }
         }
       }
@@ -158,12 +178,9 @@ void CPoiFilePOI::draw(IDrawContext::buffer_t& buf) {
   }
 
   // Draw Icons
+  QFontMetricsF fm(CMainWindow::self().getMapFont());
   for (const poiGroup_t& poiGroup : qAsConst(displayedPois)) {
-    QFontMetricsF fm(CMainWindow::self().getMapFont());
-
-    QPixmap icon;
-    getPoiIcon(icon, poiGroup);
-    icon = icon.scaled(IPoiFile::iconSize(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    const QPixmap& icon = getPoiIcon(poiGroup);
 
     const QRectF& iconLocation = poiGroup.iconLocation;
 
@@ -179,7 +196,7 @@ void CPoiFilePOI::draw(IDrawContext::buffer_t& buf) {
       CDraw::text(text, p, labelRect.toRect(), Qt::darkBlue);
     } else if (CMainWindow::self().isPoiText()) {
       // Draw Name
-      const QString& name = loadedPois[*poiGroup.pois.begin()].getName();
+      const QString& name = getName(*poiGroup.pois.begin());
       QRectF rect = fm.boundingRect(name);
       rect.adjust(-2, -2, 2, 2);
 
@@ -220,8 +237,19 @@ bool CPoiFilePOI::findPoiCloseBy(const QPoint& px, QSet<IPoiItem>& poiItems, QLi
 
   poiGroup_t poiGroup;
   if (getPoiGroupCloseBy(px, poiGroup)) {
-    for (quint64 key : qAsConst(poiGroup.pois)) {
-      poiItems.insert(loadedPois[key].toPoi());
+    // This is called on every mouse move. Only small groups are worth to query the tag data. Their
+    // details fit into the cache. Larger groups are served from memory.
+    if (poiGroup.pois.count() <= MAX_HOVER_DETAILS) {
+      for (const CPoiItemPOI& item : loadDetails(poiGroup.pois.values())) {
+        poiItems.insert(item.toPoi());
+      }
+    } else {
+      for (const poiRecord_t& record : qAsConst(poiGroup.pois)) {
+        IPoiItem poi;
+        poi.name = getName(record);
+        poi.pos = record.coordinates;
+        poiItems.insert(poi);
+      }
     }
     posPoiHighlight.append(poiGroup.iconCenter);
     return true;
@@ -238,36 +266,67 @@ void CPoiFilePOI::findPoisIn(const QRectF& degRect, QSet<IPoiItem>& pois, QList<
   // Treat highlighting and POIs seperately, as highlighting only applies to items in the current view
 
   // Find POIs
-  QSet<quint64> copiedItems;  // Some Items may appear in multiple categories. We only want to copy those once.
-  const QList<quint64>& keys = categoryActivated.keys();
-  for (quint64 categoryID : keys) {
-    if (categoryActivated[categoryID] != Qt::Checked) {
-      continue;
-    }
-    for (int minLonM10 = qFloor(degRect.left() * 10); minLonM10 <= qFloor(degRect.right() * 10); minLonM10++) {
-      for (int minLatM10 = qFloor(degRect.bottom() * 10); minLatM10 <= qFloor(degRect.top() * 10); minLatM10++) {
-        // Imagine the user moves the screen in an l-shape while updating the selection rectangle. It is possible that
-        // some tiles are not laded then
-        if (!loadedPoisByArea.contains(categoryID) || !loadedPoisByArea[categoryID].contains(minLonM10) ||
-            !loadedPoisByArea[categoryID][minLonM10].contains(minLatM10)) {
-          loadPOIsFromFile(categoryID, minLonM10, minLatM10);
-        }
-        for (quint64 poiFoundID : qAsConst(loadedPoisByArea)[categoryID][minLonM10][minLatM10]) {
-          const CPoiItemPOI& poiItemFound = loadedPois[poiFoundID];
-          if (!copiedItems.contains(poiItemFound.getKey())) {
-            // Maybe look through the whole code of selecting items from a map to avoid this conversion
-            if (degRect.contains(poiItemFound.getCoordinates() * RAD_TO_DEG)) {
-              pois.insert(poiItemFound.toPoi());
-              copiedItems.insert(poiItemFound.getKey());
-            }
-          }
+  const QRect cells(QPoint(qFloor(degRect.left() * 10), qFloor(degRect.bottom() * 10)),
+                    QPoint(qFloor(degRect.right() * 10), qFloor(degRect.top() * 10)));
+  const QList<quint64>& categories = getActivatedCategories();
+
+  // Take the cached cells of the area first. Storing missing cells below might drop them from the cache.
+  // The records are implicitly shared, thus this is cheap.
+  cells_t poisArea;
+  for (quint64 categoryID : categories) {
+    for (int minLonM10 = cells.left(); minLonM10 <= cells.right(); minLonM10++) {
+      for (int minLatM10 = cells.top(); minLatM10 <= cells.bottom(); minLatM10++) {
+        const cell_key_t key{categoryID, minLonM10, minLatM10};
+        const QVector<poiRecord_t>* records = cellsCache.object(key);
+        if (records != nullptr) {
+          poisArea[key] = *records;
         }
       }
     }
   }
 
-  // Find Highlights
-  for (const poiGroup_t& poiGroup : qAsConst(displayedPois)) {
+  // Imagine the user moves the screen in an l-shape while updating the selection rectangle. It is possible that
+  // some tiles are not loaded then. Load them right now. A large area might not fit into the cache. Use the
+  // query's result then.
+  const QRect& cellsMissing = getMissingCells(cells, categories);
+  if (!cellsMissing.isEmpty()) {
+    const cells_t& poisMissing = queryPOIs(cellsMissing, categories);
+    if (isActivated) {
+      storeCells(cellsMissing, categories, poisMissing);
+    }
+    for (auto cell = poisMissing.constBegin(); cell != poisMissing.constEnd(); ++cell) {
+      if (!poisArea.contains(cell.key())) {
+        poisArea.insert(cell.key(), cell.value());
+      }
+    }
+  }
+
+  // Some Items may appear in multiple categories. We only want to copy those once.
+  QHash<quint64, poiRecord_t> poisFound;
+  for (const QVector<poiRecord_t>& records : qAsConst(poisArea)) {
+    for (const poiRecord_t& record : records) {
+      // Maybe look through the whole code of selecting items from a map to avoid this conversion
+      if (!poisFound.contains(record.key) && degRect.contains(record.coordinates * RAD_TO_DEG)) {
+        poisFound.insert(record.key, record);
+      }
+    }
+  }
+
+  for (const CPoiItemPOI& item : loadDetails(poisFound.values())) {
+    pois.insert(item.toPoi());
+  }
+
+  // Find Highlights. Only the groups with an icon close to the area have to be tested.
+  QPolygonF area({degRect.topLeft(), degRect.topRight(), degRect.bottomRight(), degRect.bottomLeft()});
+  for (QPointF& pt : area) {
+    pt *= DEG_TO_RAD;
+  }
+  poi->convertRad2Px(area);
+
+  QVector<qint32> groups;
+  gridPois.findAll(area.boundingRect().adjusted(-1, -1, 1, 1), groups);
+  for (qint32 idx : groups) {
+    const poiGroup_t& poiGroup = displayedPois[idx];
     if (degRect.contains(poiGroup.iconCenter * RAD_TO_DEG)) {
       posPoiHighlight.append(poiGroup.iconCenter);
     }
@@ -284,12 +343,12 @@ bool CPoiFilePOI::getToolTip(const QPoint& px, QString& str) const {
   bool success = getPoiGroupCloseBy(px, poiGroup);
   if (success) {
     if (poiGroup.pois.count() == 1) {
-      const CPoiItemPOI& poiFound = loadedPois[*poiGroup.pois.begin()];
-      const QString& name = poiFound.getName(false);
-      if (!name.isEmpty()) {
-        str += "<b>" + name + "</b><br>\n";
+      const poiRecord_t& record = *poiGroup.pois.begin();
+      const CPoiItemPOI& poiFound = loadDetails({record}).value(record.key);
+      if (!record.name.isEmpty()) {
+        str += "<b>" + record.name + "</b><br>\n";
       }
-      str += tr("Category: ") + "<b>" + poiFound.getCategory() + "</b><br>\n";
+      str += tr("Category: ") + "<b>" + categoryNames.value(record.categoryID) + "</b><br>\n";
       str += poiFound.getDesc();
       str += "<br>\n";
       const QList<IGisItem::link_t>& links = poiFound.getLinks();
@@ -309,8 +368,8 @@ bool CPoiFilePOI::getToolTip(const QPoint& px, QString& str) const {
       str += "<i>" + tr("Zoom in to see more details.") + "</i>";
       if (poiGroup.pois.count() <= 10) {
         str += "<br>\n" + tr("POIs at this point:");
-        for (quint64 poiID : qAsConst(poiGroup.pois)) {
-          str += "<br>\n<b>" + loadedPois[poiID].getName() + "</b>";
+        for (const poiRecord_t& record : qAsConst(poiGroup.pois)) {
+          str += "<br>\n<b>" + getName(record) + "</b>";
         }
       }
     }
@@ -370,39 +429,49 @@ void CPoiFilePOI::slotCheckedStateChanged(QTreeWidgetItem* item) {
   loadTimer->start();
 }
 
-void CPoiFilePOI::getPoiIcon(QPixmap& icon, const CPoiFilePOI::poiGroup_t& poiGroup) {
-  if (poiGroup.pois.count() > 1) {
-    icon = QPixmap("://icons/poi/SJJB/png/poi_point_of_interest.n.32.png");
-  } else {
-    getPoiIcon(icon, loadedPois[*poiGroup.pois.begin()]);
+const QPixmap& CPoiFilePOI::getPoiIcon(const CPoiFilePOI::poiGroup_t& poiGroup) {
+  if (iconsScaledSize != IPoiFile::iconSize()) {
+    iconsScaled.clear();
+    iconsScaledSize = IPoiFile::iconSize();
   }
-}
 
-void CPoiFilePOI::getPoiIcon(QPixmap& icon, const CPoiItemPOI& poi, const QString& definingTag) {
-  if (!definingTag.isEmpty() && tagMap.contains(definingTag)) {
-    icon = tagMap[definingTag].getIcon(poi.getRawData());
-    return;
+  const QPixmap* source = poiGroup.pois.count() > 1 ? nullptr : poiGroup.pois.begin()->icon;
+  auto icon = iconsScaled.find(source);
+  if (icon == iconsScaled.end()) {
+    const QPixmap& pixmap =
+        source == nullptr ? QPixmap("://icons/poi/SJJB/png/poi_point_of_interest.n.32.png") : *source;
+    icon = iconsScaled.insert(source, pixmap.scaled(iconsScaledSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
   }
-  for (const QString& tag : poi.getRawData()) {
-    if (tagMap.contains(tag)) {
-      icon = tagMap[tag].getIcon(poi.getRawData());
-      return;
+  return *icon;
+}
+
+const QString& CPoiFilePOI::getName(const poiRecord_t& record) const {
+  if (record.name.isEmpty()) {
+    const auto& categoryName = categoryNames.constFind(record.categoryID);
+    if (categoryName != categoryNames.constEnd()) {
+      return *categoryName;
     }
   }
-  icon = QPixmap("://icons/poi/SJJB/png/poi_point_of_interest.n.32.png");
+  return record.name;
 }
 
-bool CPoiFilePOI::overlapsWithIcon(const QRectF& rect) const {
-  for (const poiGroup_t& poiGroup : displayedPois) {
-    if (poiGroup.iconLocation.intersects(rect)) {
-      return true;
+QMap<QString, CPoiIconCategory>::const_iterator CPoiFilePOI::findIconCategory(const QStringList& data) {
+  for (const QString& tag : data) {
+    const auto& iconCategory = tagMap.constFind(tag);
+    if (iconCategory != tagMap.constEnd()) {
+      return iconCategory;
     }
   }
-  return false;
+  return tagMap.constEnd();
 }
 
+bool CPoiFilePOI::overlapsWithIcon(const QRectF& rect) const { return gridPois.intersects(rect); }
+
 bool CPoiFilePOI::getPoiGroupCloseBy(const QPoint& px, CPoiFilePOI::poiGroup_t& poiItem) const {
-  for (const poiGroup_t& poiGroup : displayedPois) {
+  QVector<qint32> groups;
+  gridPois.findAll(QRectF(px - QPointF(1, 1), QSizeF(2, 2)), groups);
+  for (qint32 idx : groups) {
+    const poiGroup_t& poiGroup = displayedPois[idx];
     if (poiGroup.iconLocation.contains(px)) {
       poiItem = poiGroup;
       return true;
@@ -411,73 +480,222 @@ bool CPoiFilePOI::getPoiGroupCloseBy(const QPoint& px, CPoiFilePOI::poiGroup_t&
   return false;
 }
 
-void CPoiFilePOI::loadPOIsFromFile(quint64 categoryID, int minLonM10, int minLatM10) {
-  QMutexLocker lock(&mutex);
+QList<quint64> CPoiFilePOI::getActivatedCategories() const {
+  QList<quint64> categories;
+  for (auto category = categoryActivated.constBegin(); category != categoryActivated.constEnd(); ++category) {
+    if (category.value() == Qt::Checked) {
+      categories << category.key();
+    }
+  }
+  return categories;
+}
 
-  // check if query is within bounds
+bool CPoiFilePOI::isLoaded(quint64 categoryID, int minLonM10, int minLatM10) const {
   if (!bbox.intersects({minLonM10 / 10.0, minLatM10 / 10.0, 0.1, 0.1})) {
+    return true;
+  }
+  return cellsCache.contains({categoryID, minLonM10, minLatM10});
+}
+
+QRect CPoiFilePOI::getMissingCells(const QRect& cells, const QList<quint64>& categories) const {
+  QRect cellsMissing;
+  for (quint64 categoryID : categories) {
+    for (int minLonM10 = cells.left(); minLonM10 <= cells.right(); minLonM10++) {
+      for (int minLatM10 = cells.top(); minLatM10 <= cells.bottom(); minLatM10++) {
+        if (!isLoaded(categoryID, minLonM10, minLatM10)) {
+          cellsMissing |= QRect(minLonM10, minLatM10, 1, 1);
+        }
+      }
+    }
+  }
+  return cellsMissing;
+}
+
+void CPoiFilePOI::requestCells(const QRect& cells, const QList<quint64>& categories) {
+  QMutexLocker lock(&mutex);
+  // The redraw triggered by a running request will ask for all cells still missing.
+  if (loading) {
+    return;
+  }
+
+  const QRect& cellsMissing = getMissingCells(cells, categories);
+  if (cellsMissing.isEmpty()) {
+    return;
+  }
+
+  // The cells of the last request are missing again. They do not fit into the cache.
+  if (cellsMissing == cellsRequested && categories == categoriesRequested) {
+    return;
+  }
+  cellsRequested = cellsMissing;
+  categoriesRequested = categories;
+
+  loading = true;
+  threadPool.start([this, cellsMissing, categories]() {
+    loadPOIsFromFile(cellsMissing, categories);
+    {
+      QMutexLocker lock(&mutex);
+      loading = false;
+    }
+    poi->emitSigCanvasUpdate();
+  });
+}
+
+void CPoiFilePOI::loadPOIsFromFile(const QRect& cells, const QList<quint64>& categories) {
+  if (cells.isEmpty() || categories.isEmpty()) {
     return;
   }
+  const cells_t& pois = queryPOIs(cells, categories);
+  // do not mark the cells as loaded if the file can't be read anymore
+  QMutexLocker lock(&mutex);
+  if (isActivated) {
+    storeCells(cells, categories, pois);
+  }
+}
+
+CPoiFilePOI::cells_t CPoiFilePOI::queryPOIs(const QRect& cells, const QList<quint64>& categories) {
+  // the POIs found by category and cell
+  cells_t pois;
 
-  // Open Database here so it is owned by the right thread
-  if (!QSqlDatabase::contains(filename)) {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", filename);
+  // This is called from the loader thread and the main thread. Use a connection per thread.
+  const QString& connection = QString("%1_%2").arg(filename).arg(quintptr(QThread::currentThreadId()));
+  {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
     db.setDatabaseName(filename);
     if (!db.open()) {
       qDebug() << "failed to open database" << db.lastError();
+      QMutexLocker lock(&mutex);
       isActivated = false;
-      return;
+    } else {
+      const QStringList placeholders(QVector<QString>(categories.count(), "?").toList());
+
+      // poi_index is a R-tree. Query all categories of the area at once.
+      QSqlQuery query(db);
+      query.setForwardOnly(true);
+      query.prepare(
+          "SELECT main.poi_index.maxLat, main.poi_index.maxLon, main.poi_index.minLat, main.poi_index.minLon, "
+          "main.poi_data.data, main.poi_data.id, main.poi_category_map.category "
+          "FROM main.poi_index "
+          "JOIN main.poi_category_map ON main.poi_category_map.id = main.poi_index.id "
+          "JOIN main.poi_data ON main.poi_data.id = main.poi_index.id "
+          "WHERE main.poi_index.maxLat<? "
+          "AND main.poi_index.minLat>=? "
+          "AND main.poi_index.maxLon<? "
+          "AND main.poi_index.minLon>=? "
+          "AND main.poi_category_map.category IN (" +
+          placeholders.join(",") + ")");
+      query.addBindValue(QString::number((cells.bottom() + 1) / 10., 'f'));
+      query.addBindValue(QString::number(cells.top() / 10., 'f'));
+      query.addBindValue(QString::number((cells.right() + 1) / 10., 'f'));
+      query.addBindValue(QString::number(cells.left() / 10., 'f'));
+      for (quint64 categoryID : categories) {
+        query.addBindValue(categoryID);
+      }
+      if (!query.exec()) {
+        qDebug() << "failed to query POIs" << query.lastError();
+      }
+
+      while (query.next()) {
+        const qreal minLon = query.value(eSqlColumnPoiMinLon).toDouble();
+        const qreal minLat = query.value(eSqlColumnPoiMinLat).toDouble();
+
+        poiRecord_t record;
+        record.key = query.value(eSqlColumnPoiId).toUInt();
+        record.categoryID = query.value(eSqlColumnPoiCategory).toUInt();
+        record.coordinates = QPointF((query.value(eSqlColumnPoiMaxLon).toDouble() + minLon) / 2 * DEG_TO_RAD,
+                                     (query.value(eSqlColumnPoiMaxLat).toDouble() + minLat) / 2 * DEG_TO_RAD);
+
+        // Only the name and the icon are kept. The tag data is loaded again if needed.
+        const QStringList& data = query.value(eSqlColumnPoiData).toString().split("\r");
+        record.name = CPoiItemPOI(data, record.coordinates, record.key, "", "").getName(false);
+        const auto& iconCategory = findIconCategory(data);
+        if (iconCategory != tagMap.constEnd()) {
+          record.icon = &iconCategory->getIcon(data);
+        }
+
+        pois[{record.categoryID, qFloor(minLon * 10), qFloor(minLat * 10)}].append(record);
+      }
     }
   }
+  QSqlDatabase::removeDatabase(connection);
 
-  QSqlQuery query(QSqlDatabase::database(filename));
-  query.prepare(
-      "SELECT main.poi_index.maxLat, main.poi_index.maxLon, main.poi_index.minLat, main.poi_index.minLon, "
-      "main.poi_data.data, main.poi_data.id "
-      "FROM main.poi_data, main.poi_index "
-      "WHERE main.poi_data.id IN "
-      "("
-      "    SELECT main.poi_category_map.id "
-      "    FROM main.poi_category_map "
-      "    WHERE main.poi_category_map.id IN "
-      "    ( "
-      "        SELECT main.poi_index.id "
-      "        FROM main.poi_index "
-      "        WHERE main.poi_index.maxLat<:maxLat "
-      "        AND main.poi_index.minLat>=:minLat "
-      "        AND main.poi_index.maxLon<:maxLon "
-      "        AND main.poi_index.minLon>=:minLon "
-      "    ) "
-      "    AND main.poi_category_map.category=:categoryID "
-      ") "
-      "AND main.poi_data.id = main.poi_index.id");
-  query.bindValue(":maxLat", QString::number((minLatM10 + 1) / 10., 'f'));
-  query.bindValue(":minLat", QString::number(minLatM10 / 10., 'f'));
-  query.bindValue(":maxLon", QString::number((minLonM10 + 1) / 10., 'f'));
-  query.bindValue(":minLon", QString::number(minLonM10 / 10., 'f'));
-  query.bindValue(":categoryID", categoryID);
-  query.exec();
-  while (query.next()) {
-    quint64 key = query.value(eSqlColumnPoiId).toUInt();
-    const QStringList& data = query.value(eSqlColumnPoiData).toString().split("\r");
-    QString garminIcon;
-    for (const QString& tag : data) {
-      if (tagMap.contains(tag)) {
-        garminIcon = tagMap[tag].getGarminSym();
-        break;
+  return pois;
+}
+
+void CPoiFilePOI::storeCells(const QRect& cells, const QList<quint64>& categories, const cells_t& pois) {
+  QMutexLocker lock(&mutex);
+  for (quint64 categoryID : categories) {
+    for (int minLonM10 = cells.left(); minLonM10 <= cells.right(); minLonM10++) {
+      for (int minLatM10 = cells.top(); minLatM10 <= cells.bottom(); minLatM10++) {
+        if (isLoaded(categoryID, minLonM10, minLatM10)) {
+          continue;
+        }
+
+        // Empty cells are stored, too. Else they would be queried again and again.
+        const cell_key_t key{categoryID, minLonM10, minLatM10};
+        QVector<poiRecord_t>* records = new QVector<poiRecord_t>(pois.value(key));
+        cellsCache.insert(key, records, records->count() + 1);
       }
     }
-    loadedPoisByArea[categoryID][minLonM10][minLatM10].append(key);
-    // TODO: this overwrites a POI if it already was loaded. The difference between those will be the category. Some
-    // better handling should be done
-    loadedPois[key] = CPoiItemPOI(
-        data,
-        QPointF((query.value(eSqlColumnPoiMaxLon).toDouble() + query.value(eSqlColumnPoiMinLon).toDouble()) / 2 *
-                    DEG_TO_RAD,
-                (query.value(eSqlColumnPoiMaxLat).toDouble() + query.value(eSqlColumnPoiMinLat).toDouble()) / 2 *
-                    DEG_TO_RAD),
-        key, categoryNames[categoryID], garminIcon);
-  }
-  // Close database, as this method is called from mutiple threads.
-  QSqlDatabase::removeDatabase(filename);
+  }
+}
+
+QMap<quint64, CPoiItemPOI> CPoiFilePOI::loadDetails(const QList<poiRecord_t>& records) const {
+  QMap<quint64, CPoiItemPOI> items;
+
+  QHash<quint64, poiRecord_t> recordsMissing;
+  for (const poiRecord_t& record : records) {
+    const CPoiItemPOI* item = detailsCache.object(record.key);
+    if (item != nullptr) {
+      items[record.key] = *item;
+    } else {
+      recordsMissing[record.key] = record;
+    }
+  }
+
+  if (recordsMissing.isEmpty()) {
+    return items;
+  }
+
+  const QString& connection = QString("%1_%2").arg(filename).arg(quintptr(QThread::currentThreadId()));
+  {
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+    db.setDatabaseName(filename);
+    if (!db.open()) {
+      qDebug() << "failed to open database" << db.lastError();
+    } else {
+      const QList<quint64>& keys = recordsMissing.keys();
+      for (int i = 0; i < keys.count(); i += MAX_QUERY_KEYS) {
+        const QList<quint64>& keysQuery = keys.mid(i, MAX_QUERY_KEYS);
+        const QStringList placeholders(QVector<QString>(keysQuery.count(), "?").toList());
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        query.prepare("SELECT main.poi_data.id, main.poi_data.data FROM main.poi_data WHERE main.poi_data.id IN (" +
+                      placeholders.join(",") + ")");
+        for (quint64 key : keysQuery) {
+          query.addBindValue(key);
+        }
+        if (!query.exec()) {
+          qDebug() << "failed to query POI data" << query.lastError();
+          break;
+        }
+
+        while (query.next()) {
+          const poiRecord_t& record = recordsMissing.value(query.value(eSqlColumnDataId).toUInt());
+          const QStringList& data = query.value(eSqlColumnDataData).toString().split("\r");
+          const auto& iconCategory = findIconCategory(data);
+          const QString& garminIcon = iconCategory != tagMap.constEnd() ? iconCategory->getGarminSym() : "";
+
+          const CPoiItemPOI item(data, record.coordinates, record.key, categoryNames.value(record.categoryID),
+                                 garminIcon);
+          items[record.key] = item;
+          detailsCache.insert(record.key, new CPoiItemPOI(item));
+        }
+      }
+    }
+  }
+  QSqlDatabase::removeDatabase(connection);
+
+  return items;
 }
@@ -20,10 +20,13 @@
 #ifndef CPOIFILEPOI_H
 #define CPOIFILEPOI_H
 
+#include <QCache>
 #include <QCoreApplication>
 #include <QMutex>
+#include <QThreadPool>
 #include <QTimer>
 
+#include "helpers/COccupancyGrid.h"
 #include "poi/CPoiIconCategory.h"
 #include "poi/CPoiItemPOI.h"
 #include "poi/IPoiFile.h"
@@ -32,12 +35,20 @@ class CPoiFilePOI : public IPoiFile {
   Q_DECLARE_TR_FUNCTIONS(CPoiFilePOI)
  public:
   CPoiFilePOI(const QString& filename, CPoiDraw* parent);
-  virtual ~CPoiFilePOI() = default;
+  virtual ~CPoiFilePOI();
 
   void addTreeWidgetItems(QTreeWidget* widget) override;
-  // category, minLon multiplied by 10, minLat multiplied by 10. POIs are loaded in squares of degrees (should be fine
-  // enough to not hang the system)
-  void loadPOIsFromFile(quint64 categoryID, int minLonM10, int minLatM10);
+  /**
+     @brief Load the POIs of all given categories in an area with a single query
+
+     The area is given in cells of 0.1° x 0.1°. The cell coordinates are the cell's
+     minimum longitude and latitude multiplied by 10. Cells already loaded are not
+     touched. The database is only locked to store the result.
+
+     @param cells       the area in cells
+     @param categories  the categories to load
+   */
+  void loadPOIsFromFile(const QRect& cells, const QList<quint64>& categories);
 
   void draw(IDrawContext::buffer_t& buf) override;
 
@@ -51,16 +62,45 @@ class CPoiFilePOI : public IPoiFile {
 
   static void init() { tagMap = initTagMap(); }
 
+  /// a cell of 0.1° x 0.1° of a single category
+  struct cell_key_t {
+    bool operator==(const cell_key_t& other) const {
+      return categoryID == other.categoryID && minLonM10 == other.minLonM10 && minLatM10 == other.minLatM10;
+    }
+
+    quint64 categoryID;
+    qint32 minLonM10;
+    qint32 minLatM10;
+  };
+
  public slots:
   void slotCheckedStateChanged(QTreeWidgetItem* item) override;
 
  private:
+  /**
+     @brief The part of a POI needed to draw it
+
+     The full tag data is only loaded on demand by loadDetails().
+   */
+  struct poiRecord_t {
+    /// in radians
+    QPointF coordinates;
+    quint64 key = 0;
+    /// the category's name is taken from categoryNames
+    quint64 categoryID = 0;
+    QString name;
+    /// points into tagMap, nullptr for the default icon
+    const QPixmap* icon = nullptr;
+  };
+
+  using cells_t = QHash<cell_key_t, QVector<poiRecord_t> >;
+
   struct poiGroup_t {
     /// Area covered by the icon in pixels
     QRectF iconLocation;
     /// Location of the center of the icon in rad
     QPointF iconCenter;
-    QSet<quint64> pois;
+    QHash<quint64, poiRecord_t> pois;
   };
 
   enum SqlColumnPoi_e {
@@ -69,30 +109,75 @@ class CPoiFilePOI : public IPoiFile {
     eSqlColumnPoiMinLat,
     eSqlColumnPoiMinLon,
     eSqlColumnPoiData,
-    eSqlColumnPoiId
+    eSqlColumnPoiId,
+    eSqlColumnPoiCategory
   };
+  enum SqlColumnData_e { eSqlColumnDataId, eSqlColumnDataData };
   enum SqlColumnCategory_e { eSqlColumnCategoryId, eSqlColumnCategoryName, eSqlColumnCategoryParent };
 
-  void getPoiIcon(QPixmap& icon, const poiGroup_t& poiGroup);
-  void getPoiIcon(QPixmap& icon, const CPoiItemPOI& poi, const QString& definingTag = "");
+  /// get the icon of a group scaled to the current icon size
+  const QPixmap& getPoiIcon(const poiGroup_t& poiGroup);
+  /// get the name of the POI or the name of it's category if the POI has no name
+  const QString& getName(const poiRecord_t& record) const;
+  /// get the icon category matching the first possible tag
+  static QMap<QString, CPoiIconCategory>::const_iterator findIconCategory(const QStringList& data);
   bool overlapsWithIcon(const QRectF& rect) const;
   bool getPoiGroupCloseBy(const QPoint& px, poiGroup_t& poiItem) const;
 
+  QList<quint64> getActivatedCategories() const;
+  /// Cells outside the file's bounding box are always loaded
+  bool isLoaded(quint64 categoryID, int minLonM10, int minLatM10) const;
+  /// get the bounding rectangle of all cells not loaded yet
+  QRect getMissingCells(const QRect& cells, const QList<quint64>& categories) const;
+  /// start loading the missing cells in the loader thread, a redraw is triggered when done
+  void requestCells(const QRect& cells, const QList<quint64>& categories);
+  /// query the POIs of all given categories in an area, the database is not locked. Deactivates the file if it
+  /// can't be opened.
+  cells_t queryPOIs(const QRect& cells, const QList<quint64>& categories);
+  /// add the query result to the cache, cells loaded by another call in the meantime are kept
+  void storeCells(const QRect& cells, const QList<quint64>& categories, const cells_t& pois);
+  /**
+     @brief Load the full tag data of POIs
+
+     The mutex has to be locked by the caller.
+
+     @param records  the POIs to load
+     @return A map of POI keys and the POI items found in the file.
+   */
+  QMap<quint64, CPoiItemPOI> loadDetails(const QList<poiRecord_t>& records) const;
+
   mutable QRecursiveMutex mutex;
   QString filename;
   QTimer* loadTimer;
 
   QMap<quint64, Qt::CheckState> categoryActivated;
   QMap<quint64, QString> categoryNames;
-  // category, minLon multiplied by 10, minLat multiplied by 10. POIs are loaded in squares of degrees (should be fine
-  // enough to not hang the system)
-  QMap<quint64, QMap<int, QMap<int, QList<quint64> > > > loadedPoisByArea;
-  QMap<quint64, CPoiItemPOI> loadedPois;
+  /// the POIs loaded by category and cell, the least recently used cells are dropped if full
+  QCache<cell_key_t, QVector<poiRecord_t> > cellsCache;
+  /// the full data of the POIs shown in tool tips lately
+  mutable QCache<quint64, CPoiItemPOI> detailsCache;
   QList<poiGroup_t> displayedPois;
+  /// the icon locations of displayedPois with the same indices
+  COccupancyGrid gridPois;
+  /// the icons scaled to iconsScaledSize by their source in tagMap, nullptr for the default icon
+  QHash<const QPixmap*, QPixmap> iconsScaled;
+  QSize iconsScaledSize;
   QRectF bbox;
 
+  /// the loader thread
+  QThreadPool threadPool;
+  /// true while the loader thread is busy
+  bool loading = false;
+  /// the last request of the loader thread, if the same cells are missing again they do not fit into the cache
+  QRect cellsRequested;
+  QList<quint64> categoriesRequested;
+
   static QMap<QString, CPoiIconCategory> tagMap;
   static QMap<QString, CPoiIconCategory> initTagMap();
 };
 
+inline uint qHash(const CPoiFilePOI::cell_key_t& key, uint seed = 0) {
+  return qHash(qMakePair(key.categoryID, qMakePair(key.minLonM10, key.minLatM10)), seed);
+}
+
 #endif  // CPOIFILEPOI_H
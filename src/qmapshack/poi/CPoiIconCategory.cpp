@@ -17,10 +17,11 @@
 **********************************************************************************************/
 #include "poi/CPoiIconCategory.h"
 
-QPixmap CPoiIconCategory::getIcon(const QStringList& additionalTags) const {
+const QPixmap& CPoiIconCategory::getIcon(const QStringList& additionalTags) const {
   for (const QString& tag : additionalTags) {
-    if (subCategories.contains(tag)) {
-      return subCategories[tag];
+    const auto& subCategory = subCategories.constFind(tag);
+    if (subCategory != subCategories.constEnd()) {
+      return *subCategory;
     }
   }
   return baseIcon;
@@ -27,6 +27,9 @@
 #include "helpers/CDraw.h"
 #include "helpers/CProgressDialog.h"
 #include "helpers/CSettings.h"
+#include "print/CTiledMapExport.h"
+
+#define TILE_SIZE 512
 
 CPrintDialog::CPrintDialog(type_e type, const QRectF& area, CCanvas* source)
     : QDialog(&CMainWindow::self()), type(type), rectSelArea(area) {
@@ -227,28 +230,15 @@ void CPrintDialog::slotPrint() {
 }
 
 void CPrintDialog::slotSave() {
-  QPointF pt1 = rectSelArea.topLeft();
-  QPointF pt2 = rectSelArea.bottomRight();
-
-  canvas->convertRad2Px(pt1);
-  canvas->convertRad2Px(pt2);
-
-  QRectF rect(pt1, pt2);
-  QImage img(rect.size().toSize(), QImage::Format_ARGB32);
-
-  QPainter p(&img);
-  USE_ANTI_ALIASING(p, true);
-
-  canvas->print(p, rect, rectSelArea.center());
-
   SETTINGS;
   QString path = cfg.value("Paths/lastImagePath", "./").toString();
 
   QString filterPNG = "PNG Image (*.png)";
   QString filterJPG = "JPEG Image (*.jpg)";
+  QString filterTIF = "TIFF Image (*.tif)";
   QString filter = filterPNG;
-  QString filename =
-      QFileDialog::getSaveFileName(this, tr("Save map..."), path, filterPNG + ";; " + filterJPG, &filter);
+  QString filename = QFileDialog::getSaveFileName(this, tr("Save map..."), path,
+                                                  filterPNG + ";; " + filterJPG + ";; " + filterTIF, &filter);
   if (filename.isEmpty()) {
     return;
   }
@@ -258,6 +248,8 @@ void CPrintDialog::slotSave() {
     expectedSuffix = "png";
   } else if (filter == filterJPG) {
     expectedSuffix = "jpg";
+  } else if (filter == filterTIF) {
+    expectedSuffix = "tif";
   }
 
   QFileInfo fi(filename);
@@ -265,7 +257,32 @@ void CPrintDialog::slotSave() {
     filename += "." + expectedSuffix;
   }
 
-  img.save(filename);
+  // clone canvas by a temporary configuration file
+  QTemporaryFile temp;
+  temp.open();
+  temp.close();
+
+  QSettings view(temp.fileName(), QSettings::IniFormat);
+  view.clear();
+  canvas->saveConfig(view);
+
+  QString error;
+  {
+    CCanvasCursorLock cursorLock(Qt::WaitCursor, __func__);
+    CTiledMapExport exporter(view, TILE_SIZE, QThread::idealThreadCount());
+    exporter.setArea(rectSelArea);
+
+    PROGRESS_SETUP(tr("Saving map tiles."), 0, 100, this);
+    auto progressTiles = [&progress](int n, int N) {
+      progress.setValue(n * 100 / N);
+      return !progress.wasCanceled();
+    };
+
+    if (!exporter.exportToFile(filename, progressTiles, error)) {
+      QMessageBox::warning(this, tr("Save map..."), error, QMessageBox::Ok);
+      return;
+    }
+  }
 
   cfg.setValue("Paths/lastImagePath", fi.absolutePath());
 
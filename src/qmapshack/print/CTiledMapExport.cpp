@@ -0,0 +1,305 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#include "print/CTiledMapExport.h"
+
+#include <gdal_priv.h>
+
+#include <QtWidgets>
+#include <iostream>
+
+#include "CMainWindow.h"
+#include "canvas/CCanvas.h"
+#include "gis/CGisWorkspace.h"
+#include "helpers/CDraw.h"
+#include "helpers/CSettings.h"
+#include "setup/CAppOpts.h"
+
+// the bottom right area of the image the overlays (e.g. the scale) are drawn into
+#define OVERLAY_WIDTH 512
+#define OVERLAY_HEIGHT 128
+
+CTiledMapExport::CTiledMapExport(QSettings& view, int tileSize, int threads) {
+  // GDAL wants tiles of a multiple of 16
+  this->tileSize = qMax(64, (tileSize + 15) & ~15);
+
+  threads = qMax(1, threads);
+  for (int i = 0; i < threads; i++) {
+    CCanvas* canvas = new CCanvas(nullptr, QString("export%1").arg(i));
+    canvas->loadConfig(view);
+    canvas->allowShowTrackOverlays(false);
+    canvases << canvas;
+  }
+}
+
+CTiledMapExport::~CTiledMapExport() { qDeleteAll(canvases); }
+
+void CTiledMapExport::setArea(const QRectF& area) {
+  QPointF pt1 = area.topLeft();
+  QPointF pt2 = area.bottomRight();
+
+  // The pixel coordinates are only valid after the draw context has seen the point of
+  // focus. Starting a tile is the only way to do that.
+  focus = area.center();
+  CCanvas* canvas = canvases.first();
+  canvas->printTileStart(QSize(tileSize, tileSize), focus);
+  canvas->convertRad2Px(pt1);
+  canvas->convertRad2Px(pt2);
+
+  const QPointF center(tileSize >> 1, tileSize >> 1);
+  const QRectF rect(pt1, pt2);
+  offset = rect.topLeft() - center;
+  size = rect.size().toSize();
+}
+
+void CTiledMapExport::setArea(const QSize& size) {
+  focus = canvases.first()->getFocus();
+  offset = QPointF(-size.width() / 2.0, -size.height() / 2.0);
+  this->size = size;
+}
+
+bool CTiledMapExport::exportToFile(const QString& filename, const fProgress& progress, QString& error) {
+  if (size.isEmpty()) {
+    error = tr("The area to export is empty.");
+    return false;
+  }
+
+  const QString& suffix = QFileInfo(filename).suffix().toLower();
+  QString driverCopy;
+  if (suffix == "png") {
+    driverCopy = "PNG";
+  } else if (suffix == "jpg" || suffix == "jpeg") {
+    driverCopy = "JPEG";
+  } else if (suffix != "tif" && suffix != "tiff") {
+    error = tr("Unknown image format: %1").arg(suffix);
+    return false;
+  }
+
+  // JPEG has no alpha channel. The tiles are drawn on white background instead.
+  const bool hasAlpha = driverCopy != "JPEG";
+  const int nBands = hasAlpha ? 4 : 3;
+
+  // formats other than TIFF are created as copy from a temporary TIFF
+  const QString& filenameTiff = driverCopy.isEmpty() ? filename : filename + ".tmp.tif";
+
+  const QByteArray blockSize = QByteArray::number(tileSize);
+  const QByteArray blockXSize = "BLOCKXSIZE=" + blockSize;
+  const QByteArray blockYSize = "BLOCKYSIZE=" + blockSize;
+  const char* cargs[] = {"TILED=YES",
+                         "COMPRESS=LZW",
+                         "BIGTIFF=IF_SAFER",
+                         "PHOTOMETRIC=RGB",
+                         blockXSize.constData(),
+                         blockYSize.constData(),
+                         hasAlpha ? "ALPHA=YES" : nullptr,
+                         nullptr};
+
+  GDALDriver* driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+  GDALDataset* dataset =
+      driver->Create(filenameTiff.toUtf8(), size.width(), size.height(), nBands, GDT_Byte, (char**)cargs);
+  if (dataset == nullptr) {
+    error = tr("Failed to create file: %1").arg(filenameTiff);
+    return false;
+  }
+
+  // calculate the center of each tile in [rad]
+  const int nx = (size.width() + tileSize - 1) / tileSize;
+  const int ny = (size.height() + tileSize - 1) / tileSize;
+
+  CCanvas* canvas = canvases.first();
+  const QSize sizeTile(tileSize, tileSize);
+  canvas->printTileStart(sizeTile, focus);
+
+  QPointF pxFocus = focus;
+  canvas->convertRad2Px(pxFocus);
+
+  QList<QPoint> tiles;
+  QList<QPointF> centers;
+  for (int y = 0; y < ny; y++) {
+    for (int x = 0; x < nx; x++) {
+      const QPoint tile(x * tileSize, y * tileSize);
+      QPointF center = pxFocus + offset + tile + QPointF(tileSize >> 1, tileSize >> 1);
+      canvas->convertPx2Rad(center);
+
+      tiles << tile;
+      centers << center;
+    }
+  }
+
+  // The overlays can span several tiles. They are drawn once onto the assembled image.
+  const QRect rectOverlay = QRect(size.width() - OVERLAY_WIDTH, size.height() - OVERLAY_HEIGHT, OVERLAY_WIDTH,
+                                  OVERLAY_HEIGHT) &
+                            QRect(QPoint(0, 0), size);
+  QPointF centerOverlay =
+      pxFocus + offset + rectOverlay.topLeft() + QPointF(rectOverlay.width() / 2.0, rectOverlay.height() / 2.0);
+  canvas->convertPx2Rad(centerOverlay);
+
+  // Render batches of tiles. First all canvas objects start their threads. Then the
+  // result of each canvas is collected and written to the file.
+  bool success = true;
+  const int N = tiles.count();
+  for (int i = 0; success && (i < N); i += canvases.count()) {
+    const int n = qMin(canvases.count(), N - i);
+    for (int j = 0; j < n; j++) {
+      canvases[j]->printTileStart(sizeTile, centers[i + j]);
+    }
+
+    for (int j = 0; success && (j < n); j++) {
+      const QPoint& tile = tiles[i + j];
+
+      QImage img(sizeTile, hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+      img.fill(hasAlpha ? Qt::transparent : Qt::white);
+
+      QPainter p(&img);
+      USE_ANTI_ALIASING(p, true);
+      canvases[j]->printTileFinish(p, sizeTile, centers[i + j]);
+      p.end();
+
+      success = writeTile(dataset, tile, img, error);
+    }
+
+    if (success && progress && !progress(i + n, N)) {
+      error = tr("Export aborted.");
+      success = false;
+    }
+  }
+
+  if (success) {
+    success = drawOverlays(dataset, rectOverlay, centerOverlay, error);
+  }
+
+  dataset->FlushCache();
+
+  if (success && !driverCopy.isEmpty()) {
+    GDALDriver* driverOut = GetGDALDriverManager()->GetDriverByName(driverCopy.toLatin1());
+    GDALDataset* copy = nullptr;
+    if (driverOut != nullptr) {
+      copy = driverOut->CreateCopy(filename.toUtf8(), dataset, FALSE, nullptr, nullptr, nullptr);
+    }
+    if (copy == nullptr) {
+      error = tr("Failed to create file: %1").arg(filename);
+      success = false;
+    }
+    GDALClose(copy);
+  }
+
+  GDALClose(dataset);
+
+  if (!driverCopy.isEmpty()) {
+    QFile::remove(filenameTiff);
+  }
+
+  return success;
+}
+
+bool CTiledMapExport::writeTile(GDALDataset* dataset, const QPoint& pos, const QImage& img, QString& error) {
+  // edge tiles are cropped to the image size
+  const int w = qMin(tileSize, size.width() - pos.x());
+  const int h = qMin(tileSize, size.height() - pos.y());
+
+  const int nBands = dataset->GetRasterCount();
+  const QImage& tile = img.convertToFormat(nBands == 4 ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+
+  CPLErr res = dataset->RasterIO(GF_Write, pos.x(), pos.y(), w, h, (void*)tile.constBits(), w, h, GDT_Byte,
+                                 nBands, nullptr, nBands, tile.bytesPerLine(), 1);
+  if (res != CE_None) {
+    error = tr("Failed to write tile at %1, %2.").arg(pos.x()).arg(pos.y());
+    return false;
+  }
+  return true;
+}
+
+bool CTiledMapExport::drawOverlays(GDALDataset* dataset, const QRect& rect, const QPointF& center, QString& error) {
+  const int nBands = dataset->GetRasterCount();
+  QImage img(rect.size(), nBands == 4 ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+
+  CPLErr res = dataset->RasterIO(GF_Read, rect.x(), rect.y(), rect.width(), rect.height(), img.bits(), rect.width(),
+                                 rect.height(), GDT_Byte, nBands, nullptr, nBands, img.bytesPerLine(), 1);
+  if (res == CE_None) {
+    QPainter p(&img);
+    USE_ANTI_ALIASING(p, true);
+    canvases.first()->printOverlays(p, rect.size(), center);
+    p.end();
+
+    res = dataset->RasterIO(GF_Write, rect.x(), rect.y(), rect.width(), rect.height(), (void*)img.constBits(),
+                            rect.width(), rect.height(), GDT_Byte, nBands, nullptr, nBands, img.bytesPerLine(), 1);
+  }
+
+  if (res != CE_None) {
+    error = tr("Failed to draw the scale at %1, %2.").arg(rect.x()).arg(rect.y());
+    return false;
+  }
+  return true;
+}
+
+int CTiledMapExport::execCommandLine() {
+  if (!QFile::exists(qlOpts->exportView)) {
+    std::cerr << tr("View file does not exist: %1").arg(qlOpts->exportView).toUtf8().constData() << std::endl;
+    return -1;
+  }
+
+  // The main window and the canvas objects store their state on destruction. A temporary
+  // copy of the configuration keeps the user's configuration untouched. The workspace is
+  // neither restored nor saved.
+  QTemporaryFile tempConfig(QDir::temp().filePath("qmapshack-export-XXXXXX.conf"));
+  if (!tempConfig.open()) {
+    std::cerr << tr("Failed to create temporary configuration.").toUtf8().constData() << std::endl;
+    return -1;
+  }
+  tempConfig.close();
+  {
+    SETTINGS;
+    QSettings copy(tempConfig.fileName(), QSettings::IniFormat);
+    const QStringList& keys = cfg.allKeys();
+    for (const QString& key : keys) {
+      copy.setValue(key, cfg.value(key));
+    }
+    copy.setValue("Database/saveOnExit", false);
+  }
+
+  CAppOpts* opts = qlOpts;
+  qlOpts = new CAppOpts(opts->debug, opts->logfile, opts->nosplash, tempConfig.fileName(), opts->arguments,
+                        opts->exportView, opts->exportFile, opts->exportSize, opts->exportTileSize,
+                        opts->exportThreads);
+  delete opts;
+
+  CMainWindow w;
+
+  // GIS data is taken from the files given as positional arguments
+  for (const QString& filename : qlOpts->arguments) {
+    CGisWorkspace::self().loadGisProject(filename);
+  }
+
+  QSettings view(qlOpts->exportView, QSettings::IniFormat);
+  CTiledMapExport exporter(view, qlOpts->exportTileSize, qlOpts->exportThreads);
+  exporter.setArea(qlOpts->exportSize);
+
+  auto progress = [](int n, int N) {
+    std::cout << tr("\rRendered %1 of %2 tiles").arg(n).arg(N).toUtf8().constData() << std::flush;
+    return true;
+  };
+
+  QString error;
+  if (!exporter.exportToFile(qlOpts->exportFile, progress, error)) {
+    std::cerr << std::endl << error.toUtf8().constData() << std::endl;
+    return -1;
+  }
+
+  std::cout << std::endl;
+  return 0;
+}
@@ -0,0 +1,116 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#ifndef CTILEDMAPEXPORT_H
+#define CTILEDMAPEXPORT_H
+
+#include <QCoreApplication>
+#include <QImage>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <functional>
+
+class CCanvas;
+class GDALDataset;
+class QSettings;
+
+/**
+   @brief Render a large map area tile by tile into an image file
+
+   Instead of resizing the draw contexts to the full area, like CCanvas::print()
+   does, the area is split into fixed size tiles. Each tile is rendered by one of
+   several cloned canvas objects. As every canvas has it's own draw context threads
+   the tiles of one batch are rendered in parallel. The finished tiles are written
+   into a tiled (Big)TIFF via GDAL. Thus the memory footprint is independent of the
+   exported area. Other formats (PNG, JPEG) are created as a copy of that TIFF.
+ */
+class CTiledMapExport {
+  Q_DECLARE_TR_FUNCTIONS(CTiledMapExport)
+ public:
+  /// progress callback with number of finished and total tiles, return false to abort
+  using fProgress = std::function<bool(int, int)>;
+
+  /**
+     @brief Setup the exporter from a view configuration
+
+     @param view      the view as stored by CCanvas::saveConfig()
+     @param tileSize  the tile edge length in [px], will be aligned to a multiple of 16
+     @param threads   the number of tiles rendered in parallel
+   */
+  CTiledMapExport(QSettings& view, int tileSize, int threads);
+  virtual ~CTiledMapExport();
+
+  /**
+     @brief Export an area given by it's corners
+
+     @param area  the top left and bottom right corner in [rad]
+   */
+  void setArea(const QRectF& area);
+
+  /**
+     @brief Export an area of given pixel size centered at the view's point of focus
+
+     @param size  the size in [px]
+   */
+  void setArea(const QSize& size);
+
+  /// the size of the exported image in [px]
+  const QSize& getSize() const { return size; }
+
+  /**
+     @brief Render all tiles and write them to file
+
+     The format is derived from the file's suffix. Supported are *.tif, *.png and *.jpg
+
+     @param filename  the target file
+     @param progress  an optional progress callback
+     @param error     set to a message if the export fails
+     @return Return true on success.
+   */
+  bool exportToFile(const QString& filename, const fProgress& progress, QString& error);
+
+  /**
+     @brief Run the export as configured by the command line options
+
+     This is the headless mode of QMapShack. The main window is created but not
+     shown. It runs on a temporary copy of the user's configuration and without
+     the workspace. Thus it can run next to an instance with a GUI.
+
+     @return The application's exit code.
+   */
+  static int execCommandLine();
+
+ private:
+  bool writeTile(GDALDataset* dataset, const QPoint& pos, const QImage& img, QString& error);
+  /// draw the overlays onto the area of the dataset, centered at center [rad]
+  bool drawOverlays(GDALDataset* dataset, const QRect& rect, const QPointF& center, QString& error);
+
+  QList<CCanvas*> canvases;
+
+  int tileSize;
+
+  /// the point of focus all tile centers are derived from in [rad]
+  QPointF focus;
+  /// the offset of the top left corner relative to the focus in [px]
+  QPointF offset;
+  /// the size of the exported image in [px]
+  QSize size;
+};
+
+#endif  // CTILEDMAPEXPORT_H
@@ -231,6 +231,16 @@ quint64 CQmsDb::store(IGisItem& item) {
   pixmap.save(&buffer, "PNG");
   buffer.seek(0);
 
+  // The item and it's entry in the spatial index are written in one transaction.
+  // Thus a failure can't leave an item without or with an outdated index entry.
+  const bool transaction = db.transaction();
+  auto rollback = [&]() {
+    if (transaction) {
+      db.rollback();
+    }
+    return 0;
+  };
+
   QSqlQuery query(db);
   // item is unknown to database -> create item in database
   query.prepare(
@@ -244,12 +254,21 @@ quint64 CQmsDb::store(IGisItem& item) {
   query.bindValue(":comment", item.getInfo(IGisItem::eFeatureShowName | IGisItem::eFeatureShowFullText));
   query.bindValue(":data", data);
   query.bindValue(":hash", item.getHash());
-  QUERY_EXEC(return 0);
+  QUERY_EXEC(return rollback());
 
   query.prepare("SELECT last_insert_rowid() from items");
-  QUERY_EXEC(return 0);
+  QUERY_EXEC(return rollback());
   query.next();
   quint64 idItem = query.value(0).toULongLong();
 
+  if (!updateSpatialIndex(query, idItem, item)) {
+    return rollback();
+  }
+
+  if (transaction && !db.commit()) {
+    qWarning() << "Failed to commit transaction:" << db.lastError();
+    return rollback();
+  }
+
   return idItem;
 }
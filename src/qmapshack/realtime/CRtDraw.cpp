@@ -21,12 +21,63 @@
 #include "helpers/CDraw.h"
 #include "realtime/CRtWorkspace.h"
 
+// above this number of changed areas in view the buffer is redrawn completely
+#define MAX_DIRTY_RECTS 256
+
 CRtDraw::CRtDraw(CCanvas* parent) : IDrawContext("rt", CCanvas::eRedrawRt, parent) {
-  connect(&CRtWorkspace::self(), &CRtWorkspace::sigChanged, this, &CRtDraw::emitSigCanvasUpdate);
+  connect(&CRtWorkspace::self(), &CRtWorkspace::sigChanged, this, &CRtDraw::slotChanged);
+  connect(&CRtWorkspace::self(), &CRtWorkspace::sigChangedArea, this, &CRtDraw::slotChangedArea);
 }
 
 void CRtDraw::draw(QPainter& p, const QRect& rect) { CRtWorkspace::self().fastDraw(p, rect, this); }
 
+void CRtDraw::slotChanged() {
+  mutex.lock();
+  dirtyAll = true;
+  mutex.unlock();
+
+  emitSigCanvasUpdate();
+}
+
+void CRtDraw::slotChangedArea(const QVector<QRectF>& areas) {
+  if (areas.isEmpty()) {
+    return;
+  }
+
+  mutex.lock();
+  dirtyAreas += areas;
+  mutex.unlock();
+
+  emitSigCanvasUpdate();
+}
+
+bool CRtDraw::getDirtyRegion(const QVector<QRectF>& areas, const QPointF& pp, const QSize& size,
+                             QRegion& region) const {
+  const QRect rectBuffer(QPoint(0, 0), size);
+  QVector<QRect> rects;
+  for (const QRectF& area : areas) {
+    QPointF pt1 = area.topLeft();
+    QPointF pt2 = area.bottomRight();
+    convertRad2Px(pt1);
+    convertRad2Px(pt2);
+
+    QRect rect = QRectF(pt1 - pp, pt2 - pp).normalized().toAlignedRect();
+    rect.adjust(-DIRTY_MARGIN, -DIRTY_MARGIN, DIRTY_MARGIN, DIRTY_MARGIN);
+    rect &= rectBuffer;
+    if (rect.isEmpty()) {
+      continue;
+    }
+
+    rects << rect;
+    if (rects.count() > MAX_DIRTY_RECTS) {
+      return false;
+    }
+  }
+
+  region.setRects(rects.constData(), rects.count());
+  return true;
+}
+
 void CRtDraw::drawt(buffer_t& currentBuffer) {
   QPointF pt1 = currentBuffer.ref1;
   QPointF pt2 = currentBuffer.ref2;
@@ -39,8 +90,45 @@ void CRtDraw::drawt(buffer_t& currentBuffer) {
   QPolygonF viewport;
   viewport << pt1 << pt2 << pt3 << pt4;
 
+  mutex.lock();
+  const bool all = dirtyAll;
+  QVector<QRectF> areas;
+  areas.swap(dirtyAreas);
+  dirtyAll = false;
+  mutex.unlock();
+
+  // A partial redraw starts with a copy of the buffer drawn last. That is only possible if
+  // that buffer shows the same view. If the thread has been looping on the current buffer
+  // it's content is lost already.
+  const buffer_t* templateBuffer = lastBuffer;
+  lastBuffer = &currentBuffer;
+
+  QRegion region;
+  const bool partial = !all && !areas.isEmpty() && (templateBuffer != nullptr) && (templateBuffer != &currentBuffer) &&
+                       (templateBuffer->image.size() == currentBuffer.image.size()) &&
+                       (templateBuffer->zoomFactor == currentBuffer.zoomFactor) &&
+                       (templateBuffer->scale == currentBuffer.scale) && (templateBuffer->ref1 == currentBuffer.ref1) &&
+                       (templateBuffer->ref3 == currentBuffer.ref3) &&
+                       getDirtyRegion(areas, pp, currentBuffer.image.size(), region);
+
   QPainter p(&currentBuffer.image);
   USE_ANTI_ALIASING(p, true);
+
+  if (partial) {
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    p.drawImage(0, 0, templateBuffer->image);
+    for (const QRect& rect : region) {
+      p.fillRect(rect, Qt::transparent);
+    }
+    p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    if (region.isEmpty()) {
+      // none of the changes is visible
+      return;
+    }
+    p.setClipRegion(region);
+  }
+
   p.translate(-pp);
 
   CRtWorkspace::self().draw(p, viewport, this);
@@ -19,11 +19,14 @@
 #ifndef CRTDRAW_H
 #define CRTDRAW_H
 
+#include <QRegion>
+
 #include "canvas/IDrawContext.h"
 
 class CCanvas;
 
 class CRtDraw : public IDrawContext {
+  Q_OBJECT
  public:
   CRtDraw(CCanvas* parent);
   virtual ~CRtDraw() = default;
@@ -31,8 +34,36 @@ class CRtDraw : public IDrawContext {
   using IDrawContext::draw;
   void draw(QPainter& p, const QRect& rect);
 
+  /// the margin in [px] around a changed position that is redrawn, large enough for an icon and it's label
+  static constexpr int DIRTY_MARGIN = 48;
+
  protected:
   void drawt(buffer_t& currentBuffer) override;
+
+ private slots:
+  /// everything has changed, the next redraw has to cover the complete buffer
+  void slotChanged();
+  /// some items have changed, the next redraw can be limited to the given areas in [rad]
+  void slotChangedArea(const QVector<QRectF>& areas);
+
+ private:
+  /**
+     @brief Get the region of the buffer covered by the changed areas
+
+     @param areas   the changed areas in [rad]
+     @param pp      the buffer's top left corner in [px]
+     @param size    the buffer's size in [px]
+     @param region  the region in buffer coordinates
+     @return Return false if the changes are too many for a partial redraw.
+   */
+  bool getDirtyRegion(const QVector<QRectF>& areas, const QPointF& pp, const QSize& size, QRegion& region) const;
+
+  /// set true by every change that is not limited to some areas
+  bool dirtyAll = true;
+  /// the changed areas in [rad] since the last redraw
+  QVector<QRectF> dirtyAreas;
+  /// the buffer drawn last, only accessed by the thread
+  const buffer_t* lastBuffer = nullptr;
 };
 
 #endif  // CRTDRAW_H
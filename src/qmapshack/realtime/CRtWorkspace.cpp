@@ -20,6 +20,7 @@
 
 #include <QtWidgets>
 
+#include "helpers/COccupancyGrid.h"
 #include "helpers/CSettings.h"
 #include "realtime/CRtDraw.h"
 #include "realtime/CRtSelectSource.h"
@@ -51,6 +52,7 @@ CRtWorkspace::CRtWorkspace(QWidget* parent) : QWidget(parent) {
     IRtSource* source = IRtSource::create(cfg.value("type", IRtSource::eTypeNone).toInt(), treeWidget);
     if (source != nullptr) {
       connect(source, &IRtSource::sigChanged, this, &CRtWorkspace::sigChanged);
+      connect(source, &IRtSource::sigChangedArea, this, &CRtWorkspace::sigChangedArea);
       source->loadSettings(cfg);
     }
 
@@ -89,7 +91,11 @@ CRtWorkspace::~CRtWorkspace() {
 
 void CRtWorkspace::draw(QPainter& p, const QPolygonF& viewport, CRtDraw* rt) const {
   QMutexLocker lock(&IRtSource::mutex);
-  QList<QRectF> blockedAreas;
+
+  // the viewport in screen coordinates to setup the grid of blocked areas
+  QPolygonF area = viewport;
+  rt->convertRad2Px(area);
+  COccupancyGrid blockedAreas(area.boundingRect());
 
   const int N = treeWidget->topLevelItemCount();
   for (int n = 0; n < N; n++) {
@@ -120,6 +126,7 @@ void CRtWorkspace::addSource(IRtSource* source) {
   treeWidget->insertTopLevelItem(treeWidget->topLevelItemCount(), source);
   source->registerWithTreeWidget();
   connect(source, &IRtSource::sigChanged, this, &CRtWorkspace::sigChanged);
+  connect(source, &IRtSource::sigChangedArea, this, &CRtWorkspace::sigChangedArea);
   emit sigChanged();
 }
 
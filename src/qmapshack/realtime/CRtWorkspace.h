@@ -78,6 +78,7 @@ class CRtWorkspace : public QWidget, private Ui::IRtWorkspace {
 
  signals:
   void sigChanged();
+  void sigChangedArea(const QVector<QRectF>& areas);
 
  private slots:
   void slotItemChanged(QTreeWidgetItem* item, int column);
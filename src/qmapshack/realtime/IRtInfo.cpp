@@ -74,7 +74,7 @@ void IRtInfo::slotToTrack() {
   new CGisItemTrk(data, prj);
 }
 
-void IRtInfo::draw(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) {
+void IRtInfo::draw(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) {
   if (record != nullptr) {
     record->draw(p, viewport, blockedAreas, rt);
   }
@@ -33,7 +33,7 @@ class IRtInfo : public QWidget {
   IRtInfo(IRtSource* source, QWidget* parent);
   virtual ~IRtInfo() = default;
 
-  virtual void draw(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt);
+  virtual void draw(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt);
 
  protected slots:
   void slotSetFilename();
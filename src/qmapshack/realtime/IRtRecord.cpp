@@ -22,57 +22,208 @@
 
 #include "realtime/CRtDraw.h"
 
-IRtRecord::IRtRecord(QObject* parent) : QObject(parent) {}
+#define INDEX_MAGIC "QMSRecordIndex"
+#define INDEX_VERSION 2
+// the time in [ms] data is kept in the write buffers
+#define FLUSH_INTERVAL 5000
+
+IRtRecord::IRtRecord(QObject* parent) : QObject(parent) {
+  timerFlush = new QTimer(this);
+  timerFlush->setSingleShot(true);
+  timerFlush->setInterval(FLUSH_INTERVAL);
+  connect(timerFlush, &QTimer::timeout, this, &IRtRecord::slotFlush);
+}
+
+IRtRecord::~IRtRecord() { closeFiles(); }
 
 bool IRtRecord::setFile(const QString& fn) {
-  track.clear();
+  closeFiles();
+  index.clear();
+  line.clear();
   filename = fn;
 
-  if (QFile::exists(filename)) {
-    return readFile(filename);
+  if (QFile::exists(filename) && !readFile(filename)) {
+    return false;
   }
-  return true;
+  return openFiles();
 }
 
 bool IRtRecord::readFile(const QString& filename) {
-  QFile file(filename);
-  if (!file.open(QIODevice::ReadOnly)) {
+  QFile fileRecord(filename);
+  if (!fileRecord.open(QIODevice::ReadOnly)) {
     error = tr("Failed to open record for reading.");
     return false;
   }
 
-  QDataStream stream(&file);
+  // Continue with the last entry of the index. It is read again to find the end of it. If it
+  // does not match the index, the index is stale and the record is read from the start to rebuild it.
+  quint64 pos = 0;
+  if (loadIndex(fileRecord.size()) && !index.isEmpty()) {
+    const index_t last = index.takeLast();
+    line.removeLast();
+
+    if (fileRecord.seek(last.offset) && (getEntrySize(fileRecord) == last.size)) {
+      pos = last.offset;
+    } else {
+      qWarning() << "Record index does not fit to record. Rebuild index of" << filename;
+      index.clear();
+      line.clear();
+    }
+  } else {
+    index.clear();
+    line.clear();
+  }
+  const qint32 countIndex = index.count();
+
+  fileRecord.seek(pos);
+  QDataStream stream(&fileRecord);
   stream.setVersion(QDataStream::Qt_5_2);
   stream.setByteOrder(QDataStream::LittleEndian);
 
+  bool success = true;
   while (!stream.atEnd()) {
-    quint64 size = stream.device()->pos();
+    quint64 offset = stream.device()->pos();
 
     quint16 crc;
     QByteArray data;
     stream >> crc >> data;
 
+    // Only data behind a validated position is truncated. Thus a stale index can't destroy valid entries.
     if ((qChecksum(data.data(), data.size()) != crc) || (stream.status() != QDataStream::Ok)) {
       error = tr("Failed to read entry. Truncate record to last valid entry.");
-      file.close();
-      QFile::resize(filename, size);
-      return false;
+      fileRecord.close();
+      QFile::resize(filename, offset);
+      success = false;
+      break;
     }
 
-    readEntry(data);
+    CTrackData::trkpt_t trkpt;
+    readEntry(data, trkpt);
+    const quint32 size = quint32(stream.device()->pos() - offset);
+    addToIndex({offset, size, trkpt.time.toMSecsSinceEpoch(), trkpt.lon, trkpt.lat, trkpt.ele});
   }
 
-  file.close();
+  // entries have been added or the index was not valid at all
+  if ((index.count() != countIndex + 1) || (countIndex == 0)) {
+    saveIndex();
+  }
+  return success;
+}
+
+bool IRtRecord::loadIndex(quint64 sizeRecord) {
+  QFile fileIdx(filename + ".idx");
+  if (!fileIdx.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream stream(&fileIdx);
+  stream.setVersion(QDataStream::Qt_5_2);
+  stream.setByteOrder(QDataStream::LittleEndian);
+
+  QByteArray magic;
+  qint32 version = 0;
+  stream >> magic >> version;
+  if (magic != INDEX_MAGIC || version != INDEX_VERSION) {
+    return false;
+  }
+
+  while (!stream.atEnd()) {
+    index_t entry;
+    stream >> entry.offset >> entry.size >> entry.time >> entry.lon >> entry.lat >> entry.ele;
+    if (stream.status() != QDataStream::Ok) {
+      // a partially flushed entry at the end
+      break;
+    }
+
+    // The index does not fit to the record if the entries do not follow each other without gaps
+    // or exceed the record.
+    const quint64 offset = index.isEmpty() ? 0 : index.last().offset + index.last().size;
+    if ((entry.offset != offset) || (entry.size == 0) || (entry.offset + entry.size > sizeRecord)) {
+      return false;
+    }
+    addToIndex(entry);
+  }
   return true;
 }
 
-bool IRtRecord::writeEntry(const QByteArray& data) {
-  QFile file(filename);
+quint32 IRtRecord::getEntrySize(QFile& fileRecord) {
+  const qint64 offset = fileRecord.pos();
+
+  QDataStream stream(&fileRecord);
+  stream.setVersion(QDataStream::Qt_5_2);
+  stream.setByteOrder(QDataStream::LittleEndian);
+
+  quint16 crc;
+  QByteArray data;
+  stream >> crc >> data;
+  if ((qChecksum(data.data(), data.size()) != crc) || (stream.status() != QDataStream::Ok)) {
+    return 0;
+  }
+  return quint32(fileRecord.pos() - offset);
+}
+
+bool IRtRecord::saveIndex() {
+  QSaveFile fileIdx(filename + ".idx");
+  if (!fileIdx.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+
+  QDataStream stream(&fileIdx);
+  stream.setVersion(QDataStream::Qt_5_2);
+  stream.setByteOrder(QDataStream::LittleEndian);
+
+  stream << QByteArray(INDEX_MAGIC) << qint32(INDEX_VERSION);
+  for (const index_t& entry : qAsConst(index)) {
+    stream << entry.offset << entry.size << entry.time << entry.lon << entry.lat << entry.ele;
+  }
+  return fileIdx.commit();
+}
+
+bool IRtRecord::openFiles() {
+  file.setFileName(filename);
   if (!file.open(QIODevice::Append)) {
     error = tr("Failed to open record for writing.");
     return false;
   }
 
+  // the index has been written completely by readFile() or is created here
+  if (!QFile::exists(filename + ".idx")) {
+    saveIndex();
+  }
+
+  fileIndex.setFileName(filename + ".idx");
+  if (!fileIndex.open(QIODevice::Append)) {
+    error = tr("Failed to open record index for writing.");
+    file.close();
+    return false;
+  }
+  return true;
+}
+
+void IRtRecord::closeFiles() {
+  timerFlush->stop();
+  file.close();
+  fileIndex.close();
+}
+
+void IRtRecord::slotFlush() {
+  file.flush();
+  fileIndex.flush();
+}
+
+void IRtRecord::addToIndex(const index_t& entry) {
+  index << entry;
+  line << QPointF(entry.lon * DEG_TO_RAD, entry.lat * DEG_TO_RAD);
+}
+
+bool IRtRecord::writeEntry(const QByteArray& data, const CTrackData::trkpt_t& trkpt) {
+  if (!file.isOpen() || !fileIndex.isOpen()) {
+    error = tr("Failed to open record for writing.");
+    return false;
+  }
+
+  index_t entry = {quint64(file.pos()), 0, trkpt.time.toMSecsSinceEpoch(), trkpt.lon, trkpt.lat, trkpt.ele};
+
   QDataStream stream(&file);
   stream.setVersion(QDataStream::Qt_5_2);
   stream.setByteOrder(QDataStream::LittleEndian);
@@ -82,39 +233,88 @@ bool IRtRecord::writeEntry(const QByteArray& data) {
 
   if (stream.status() != QDataStream::Ok) {
     error = tr("Failed to write entry.");
-    file.close();
     return false;
   }
+  entry.size = quint32(quint64(file.pos()) - entry.offset);
 
-  file.close();
+  QDataStream streamIndex(&fileIndex);
+  streamIndex.setVersion(QDataStream::Qt_5_2);
+  streamIndex.setByteOrder(QDataStream::LittleEndian);
+  streamIndex << entry.offset << entry.size << entry.time << entry.lon << entry.lat << entry.ele;
+  addToIndex(entry);
+
+  if (!timerFlush->isActive()) {
+    timerFlush->start();
+  }
   return true;
 }
 
-bool IRtRecord::readEntry(QByteArray& data) {
+bool IRtRecord::readEntry(QByteArray& data, CTrackData::trkpt_t& trkpt) {
   QDataStream stream(&data, QIODevice::ReadOnly);
   stream.setVersion(QDataStream::Qt_5_2);
   stream.setByteOrder(QDataStream::LittleEndian);
 
   quint8 version;
   stream >> version;
-
-  CTrackData::trkpt_t trkpt;
   stream >> trkpt;
-  track << trkpt;
-  return true;
+  return stream.status() == QDataStream::Ok;
 }
 
-void IRtRecord::reset() {
-  track.clear();
-  QFile::resize(filename, 0);
+qint32 IRtRecord::findEntry(const QDateTime& time) const {
+  auto entry = std::lower_bound(index.constBegin(), index.constEnd(), time.toMSecsSinceEpoch(),
+                                [](const index_t& item, qint64 msecs) { return item.time < msecs; });
+  return entry - index.constBegin();
 }
 
-void IRtRecord::draw(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) {
-  QPolygonF tmp;
-  for (const CTrackData::trkpt_t& trkpt : qAsConst(track)) {
-    tmp << QPointF(trkpt.lon * DEG_TO_RAD, trkpt.lat * DEG_TO_RAD);
+QVector<CTrackData::trkpt_t> IRtRecord::getTrack(const QDateTime& from, const QDateTime& to) {
+  QVector<CTrackData::trkpt_t> track;
+
+  const qint32 first = from.isValid() ? findEntry(from) : 0;
+  const qint32 last = to.isValid() ? findEntry(to.addMSecs(1)) : index.count();
+  if (first >= last) {
+    return track;
+  }
+
+  file.flush();
+  QFile fileRead(filename);
+  if (!fileRead.open(QIODevice::ReadOnly) || !fileRead.seek(index[first].offset)) {
+    error = tr("Failed to open record for reading.");
+    return track;
   }
 
+  QDataStream stream(&fileRead);
+  stream.setVersion(QDataStream::Qt_5_2);
+  stream.setByteOrder(QDataStream::LittleEndian);
+
+  track.reserve(last - first);
+  for (qint32 i = first; i < last; i++) {
+    quint16 crc;
+    QByteArray data;
+    stream >> crc >> data;
+    if ((qChecksum(data.data(), data.size()) != crc) || (stream.status() != QDataStream::Ok)) {
+      error = tr("Failed to read entry.");
+      break;
+    }
+
+    CTrackData::trkpt_t trkpt;
+    if (readEntry(data, trkpt)) {
+      track << trkpt;
+    }
+  }
+  return track;
+}
+
+void IRtRecord::reset() {
+  closeFiles();
+  index.clear();
+  line.clear();
+  QFile::resize(filename, 0);
+  QFile::remove(filename + ".idx");
+  openFiles();
+}
+
+void IRtRecord::draw(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) {
+  QPolygonF tmp = line;
   rt->convertRad2Px(tmp);
   p.setPen(QPen(Qt::black, 3));
   p.drawPolyline(tmp);
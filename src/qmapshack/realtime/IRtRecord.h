@@ -22,17 +22,28 @@
 #include <QDataStream>
 #include <QFile>
 #include <QObject>
+#include <QPolygonF>
 
 #include "gis/trk/CTrackData.h"
 
+class COccupancyGrid;
 class CRtDraw;
 class QPainter;
+class QTimer;
 
+/**
+   @brief Base class for all realtime records
+
+   The record file is kept open while recording. The entries are buffered and flushed
+   periodically. For each entry the file offset, the size, the timestamp and the position are
+   stored in an index file next to the record ("*.rec.idx"). Thus an existing record
+   can be opened without parsing it and any time span can be read directly.
+ */
 class IRtRecord : public QObject {
   Q_OBJECT
  public:
   IRtRecord(QObject* parent);
-  virtual ~IRtRecord() = default;
+  virtual ~IRtRecord();
 
   /**
      @brief Set record file size to 0.
@@ -41,7 +52,9 @@ class IRtRecord : public QObject {
   /**
      @brief Set file name to record into
 
-     If the file exists this will read the file and append new data.
+     If the file exists the entries are taken from the index. Only entries not covered
+     by the index are read from the record. Without a valid index the record is read
+     once to rebuild it. New data is appended.
 
      @param fn  the filename as string
 
@@ -58,12 +71,34 @@ class IRtRecord : public QObject {
 
      @param p             the paint device
      @param viewport      the visible viewport
-     @param blockedAreas  a list of blocked areas
+     @param blockedAreas  the grid of blocked areas
      @param rt            the draw context
    */
-  virtual void draw(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt);
+  virtual void draw(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt);
+
+  /// get the number of entries in the record
+  qint32 getCount() const { return index.count(); }
+
+  /**
+     @brief Find the first entry not older than a given time
+
+     The entries are expected to be recorded in chronological order.
+
+     @param time  the timestamp to seek
+     @return The index of the entry. If all entries are older the number of entries is returned.
+   */
+  qint32 findEntry(const QDateTime& time) const;
 
-  virtual const QVector<CTrackData::trkpt_t>& getTrack() const { return track; }
+  /**
+     @brief Read the track points of a time span from the record
+
+     Only the entries of the time span are read from file.
+
+     @param from  the start of the time span, an invalid timestamp for the first entry
+     @param to    the end of the time span, an invalid timestamp for the last entry
+     @return The track points.
+   */
+  QVector<CTrackData::trkpt_t> getTrack(const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime());
 
  protected:
   /**
@@ -71,39 +106,75 @@ class IRtRecord : public QObject {
 
      A crc16 is calculated and stored together with the byte array into the file.
 
-     @param data  the byte array to store
+     @param data   the byte array to store
+     @param trkpt  the track point stored in the data, used for the index
 
      @return Return true on success.
    */
-  virtual bool writeEntry(const QByteArray& data);
+  virtual bool writeEntry(const QByteArray& data, const CTrackData::trkpt_t& trkpt);
 
   /**
-     @brief A block data has been read and needs further processing
+     @brief A block of data has been read and needs further processing
 
-     If a filename is set and the file exists, the data entries in the file are read
-     one by one and passed to this API. If the method returns with false the file will
-     be truncated to the last valid entry.
+     This is called for entries not covered by the index when opening the record and
+     for all entries requested by getTrack(). If the method returns with false while
+     opening the record the file will be truncated to the last valid entry.
 
-     @param data  the byte array with the data entry.
+     @param data   the byte array with the data entry.
+     @param trkpt  the track point stored in the entry
 
      @return Return true on success.
    */
-  virtual bool readEntry(QByteArray& data);
+  virtual bool readEntry(QByteArray& data, CTrackData::trkpt_t& trkpt);
 
- protected:
-  QVector<CTrackData::trkpt_t> track;
+ private slots:
+  void slotFlush();
 
  private:
+  struct index_t {
+    /// the offset of the entry in the record file
+    quint64 offset;
+    /// the size of the entry in the record file, used to check if the index fits to the record
+    quint32 size;
+    /// the entry's timestamp in [ms] since epoch
+    qint64 time;
+    qreal lon;
+    qreal lat;
+    qreal ele;
+  };
+
   /**
      @brief Reads file content entry by entry and tests for the checksum
 
+     Reading starts after the last entry of the index.
+
      @param filename  the file name to open and read.
 
      @return Return true on success.
    */
   virtual bool readFile(const QString& filename);
+  /// load the index file, return false if it does not fit to the record
+  bool loadIndex(quint64 sizeRecord);
+  /// read the entry at the current position of the file and return its size, 0 if it is not valid
+  static quint32 getEntrySize(QFile& fileRecord);
+  /// write the complete index to file
+  bool saveIndex();
+  /// open the record and the index for appending
+  bool openFiles();
+  void closeFiles();
+  void addToIndex(const index_t& entry);
 
   QString filename;
+  /// the record file opened for appending
+  QFile file;
+  /// the index file opened for appending
+  QFile fileIndex;
+  /// flush both files a while after the first unflushed write
+  QTimer* timerFlush;
+
+  QVector<index_t> index;
+  /// all positions of the index in [rad]
+  QPolygonF line;
 
   QString error;
 };
@@ -23,8 +23,11 @@
 #include <QDebug>
 #include <QMutex>
 #include <QObject>
+#include <QRectF>
 #include <QTreeWidgetItem>
+#include <QVector>
 
+class COccupancyGrid;
 class CRtDraw;
 class QSettings;
 
@@ -73,7 +76,7 @@ class IRtSource : public QObject, public QTreeWidgetItem {
    */
   virtual QString getDescription() const = 0;
 
-  virtual void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) = 0;
+  virtual void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) = 0;
 
   virtual void fastDraw(QPainter& p, const QRectF& viewport, CRtDraw* rt) = 0;
 
@@ -127,6 +130,14 @@ class IRtSource : public QObject, public QTreeWidgetItem {
 
  signals:
   void sigChanged();
+  /**
+     @brief Only some items of the source have changed
+
+     Other than sigChanged() this allows the draw context to redraw the given areas only.
+
+     @param areas   the bounding boxes of the changed items before and after the change in [rad]
+   */
+  void sigChangedArea(const QVector<QRectF>& areas);
 };
 
 Q_DECLARE_METATYPE(IRtSource*)
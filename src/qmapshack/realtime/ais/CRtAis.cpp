@@ -23,12 +23,22 @@
 #include <QtWidgets>
 
 #include "helpers/CDraw.h"
+#include "helpers/COccupancyGrid.h"
 #include "realtime/CRtDraw.h"
 #include "realtime/ais/CRtAisInfo.h"
 
+// the edge length of a spatial index cell in [°]
+#define CELL_SIZE 0.25
+// ships without position report for that time in [s] are removed
+#define MAX_AGE 900
+
 const QString CRtAis::strIcon("://icons/48x48/ActShip.png");
 
-CRtAis::CRtAis(QTreeWidget* parent) : IRtSource(eTypeAis, true, parent) {
+CRtAis::CRtAis(QTreeWidget* parent)
+    : IRtSource(eTypeAis, true, parent),
+      iconShip("://icons/16x16/Ship.png"),
+      iconAid("://icons/16x16/Aid.png"),
+      glyphsShip(360) {
   setIcon(eColumnIcon, QIcon(strIcon));
   setText(eColumnName, "AIS");
   setCheckState(eColumnCheckBox, Qt::Checked);
@@ -88,64 +98,126 @@ bool CRtAis::getShowNames() const {
   return showNames;
 }
 
-CRtAis::ship_t& CRtAis::getShipByMmsi(const QString& mmsi) {
+CRtAis::ship_t& CRtAis::getShipByMmsi(quint32 mmsi) {
   QMutexLocker lock(&IRtSource::mutex);
-  if (!ships.contains(mmsi)) {
-    ship_t ship;
-    ship.mmsi = mmsi;
-    ships[mmsi] = ship;
+  auto ship = ships.find(mmsi);
+  if (ship == ships.end()) {
+    ship = ships.insert(mmsi, ship_t());
+    ship->mmsi = QString::number(mmsi);
   }
 
-  return ships[mmsi];
+  return *ship;
+}
+
+bool CRtAis::hasShip(quint32 mmsi) const {
+  QMutexLocker lock(&IRtSource::mutex);
+  return ships.contains(mmsi);
+}
+
+CRtAis::ship_t& CRtAis::updateShipPosition(quint32 mmsi, qreal longitude, qreal latitude) {
+  QMutexLocker lock(&IRtSource::mutex);
+  ship_t& ship = getShipByMmsi(mmsi);
+
+  const QPointF pos(longitude, latitude);
+  const quint64 cell = getCellKey(pos);
+  if (ship.pos == NOPOINTF) {
+    shipsByCell[cell].insert(mmsi);
+  } else {
+    const quint64 cellOld = getCellKey(ship.pos);
+    if (cellOld != cell) {
+      shipsByCell[cellOld].remove(mmsi);
+      if (shipsByCell[cellOld].isEmpty()) {
+        shipsByCell.remove(cellOld);
+      }
+      shipsByCell[cell].insert(mmsi);
+    }
+  }
+
+  ship.longitude = longitude;
+  ship.latitude = latitude;
+  ship.pos = pos;
+  ship.timePosition = QDateTime::currentSecsSinceEpoch();
+  return ship;
+}
+
+quint64 CRtAis::getCellKey(const QPointF& pos) {
+  const quint32 x = qFloor(pos.x() / CELL_SIZE);
+  const quint32 y = qFloor(pos.y() / CELL_SIZE);
+  return (quint64(x) << 32) | y;
+}
+
+void CRtAis::removeExpiredShips() {
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+  if (now == timeExpired) {
+    return;
+  }
+  timeExpired = now;
+
+  for (auto ship = ships.begin(); ship != ships.end();) {
+    if (ship->aid || (ship->timePosition + MAX_AGE) >= now) {
+      ++ship;
+      continue;
+    }
+
+    if (ship->pos != NOPOINTF) {
+      const quint64 cell = getCellKey(ship->pos);
+      shipsByCell[cell].remove(ship.key());
+      if (shipsByCell[cell].isEmpty()) {
+        shipsByCell.remove(cell);
+      }
+    }
+    ship = ships.erase(ship);
+  }
 }
 
-bool CRtAis::hasShip(const QString& key) { return ships.contains(key); }
+const QImage& CRtAis::getShipGlyph(qreal heading) {
+  QImage& glyph = glyphsShip[qRound(heading) % 360];
+  if (glyph.isNull()) {
+    // large enough for all angles
+    const int size = qCeil(M_SQRT2 * qMax(iconShip.width(), iconShip.height()));
+    glyph = QImage(size, size, QImage::Format_ARGB32_Premultiplied);
+    glyph.fill(Qt::transparent);
+
+    QPainter p(&glyph);
+    USE_ANTI_ALIASING(p, true);
+    p.translate(size / 2.0, size / 2.0);
+    p.rotate(qRound(heading) % 360);
+    p.drawImage(QPointF(-iconShip.width() / 2.0, -iconShip.height() / 2.0), iconShip);
+  }
+  return glyph;
+}
 
-void CRtAis::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) {
+void CRtAis::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) {
   if (checkState(eColumnCheckBox) != Qt::Checked) {
     return;
   }
 
+  removeExpiredShips();
+
   QPolygonF tmp2 = viewport;
   rt->convertRad2Px(tmp2);
+  const QRectF& rectView = tmp2.boundingRect();
 
-  QFontMetrics fm(p.font());
+  gridShips.reset(rectView, 32);
+  shipsDrawn.clear();
 
-  p.setPen(Qt::yellow);
-  p.setBrush(Qt::yellow);
-  QPixmap iconShip("://icons/16x16/Ship.png");
-  QPixmap iconAid("://icons/16x16/Aid.png");
-  QRect rectIconShip = iconShip.rect();
-  rectIconShip.moveCenter(QPoint(0, 0));
-  QRect rectIconAid = iconAid.rect();
-  rectIconAid.moveCenter(QPoint(0, 0));
-
-  QDateTime now = QDateTime::currentDateTime();
-
-  const QStringList& keys = ships.keys();
-  for (const QString& key : keys) {
-    ship_t& ship = ships[key];
-
-    if (!ship.aid) {
-      QDateTime lim = QDateTime::fromTime_t(ship.timePosition).addSecs(900);
-      if (lim < now) {
-        ships.remove(key);
-        continue;
-      }
-    }
+  QFontMetrics fm(p.font());
 
+  auto drawShip = [&](quint32 mmsi, ship_t& ship) {
     ship.point = ship.pos * DEG_TO_RAD;
     rt->convertRad2Px(ship.point);
 
-    if (!tmp2.boundingRect().contains(ship.point)) {
-      continue;
+    if (!rectView.contains(ship.point)) {
+      return;
     }
 
-    p.save();
-    p.translate(ship.point);
-    p.rotate(ship.heading);
-    p.drawPixmap(ship.heading >= 0 ? rectIconShip : rectIconAid, ship.heading >= 0 ? iconShip : iconAid);
-    p.restore();
+    const QImage& icon = ship.heading >= 0 ? getShipGlyph(ship.heading) : iconAid;
+    QRectF rectIcon(QPointF(), icon.size());
+    rectIcon.moveCenter(ship.point);
+    p.drawImage(rectIcon.topLeft(), icon);
+
+    gridShips.insert(QRectF(ship.point - QPointF(20, 20), QSizeF(40, 40)));
+    shipsDrawn << mmsi;
 
     if (showNames) {
       QString name = ship.name.isEmpty() ? ship.mmsi.isEmpty() ? tr("unkn.") : ship.mmsi : ship.name;
@@ -154,9 +226,35 @@ void CRtAis::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blo
       rectLabel.adjust(-1, -1, 1, 1);
       if (!CDraw::doesOverlap(blockedAreas, rectLabel)) {
         CDraw::text(name, p, rectLabel.center(), Qt::darkBlue);
-        blockedAreas << rectLabel;
+        blockedAreas.insert(rectLabel);
+      }
+    }
+  };
+
+  // Use the spatial index to find the ships in view. If the view covers more cells
+  // than there are cells with ships, all ships are tested.
+  const QRectF& rectViewRad = viewport.boundingRect();
+  const qint32 x1 = qFloor(rectViewRad.left() * RAD_TO_DEG / CELL_SIZE);
+  const qint32 x2 = qFloor(rectViewRad.right() * RAD_TO_DEG / CELL_SIZE);
+  const qint32 y1 = qFloor(rectViewRad.top() * RAD_TO_DEG / CELL_SIZE);
+  const qint32 y2 = qFloor(rectViewRad.bottom() * RAD_TO_DEG / CELL_SIZE);
+
+  if (qint64(x2 - x1 + 1) * (y2 - y1 + 1) < shipsByCell.count()) {
+    for (qint32 x = x1; x <= x2; x++) {
+      for (qint32 y = y1; y <= y2; y++) {
+        const auto& cell = shipsByCell.constFind(getCellKey(QPointF(x + 0.5, y + 0.5) * CELL_SIZE));
+        if (cell == shipsByCell.constEnd()) {
+          continue;
+        }
+        for (quint32 mmsi : *cell) {
+          drawShip(mmsi, ships[mmsi]);
+        }
       }
     }
+  } else {
+    for (auto ship = ships.begin(); ship != ships.end(); ++ship) {
+      drawShip(ship.key(), *ship);
+    }
   }
 
   if (info != nullptr) {
@@ -165,10 +263,11 @@ void CRtAis::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blo
 }
 
 void CRtAis::fastDraw(QPainter& p, const QRectF& viewport, CRtDraw* rt) {
-  if (!keyFocus.isEmpty() && ships.contains(keyFocus)) {
+  const auto& shipFocus = ships.constFind(mmsiFocus);
+  if (shipFocus != ships.constEnd()) {
     p.save();
 
-    const ship_t& ship = ships[keyFocus];
+    const ship_t& ship = *shipFocus;
     p.setPen(Qt::red);
     p.setBrush(Qt::NoBrush);
     p.drawEllipse(ship.point, 10, 10);
@@ -224,12 +323,13 @@ void CRtAis::mouseMove(const QPointF& pos) {
 
   QMutexLocker lock(&IRtSource::mutex);
 
-  keyFocus.clear();
-  const QStringList& keys = ships.keys();
-  for (const QString& key : keys) {
-    const ship_t& ship = ships[key];
-    if ((ship.point - pos).manhattanLength() < 20) {
-      keyFocus = key;
+  mmsiFocus = 0;
+  QVector<qint32> hits;
+  gridShips.findAll(QRectF(pos - QPointF(1, 1), QSizeF(2, 2)), hits);
+  for (qint32 idx : hits) {
+    const auto& ship = ships.constFind(shipsDrawn[idx]);
+    if ((ship != ships.constEnd()) && ((ship->point - pos).manhattanLength() < 20)) {
+      mmsiFocus = ship.key();
       break;
     }
   }
@@ -20,8 +20,10 @@
 #define CRTAIS_H
 
 #include <QDateTime>
+#include <QImage>
 #include <QPointer>
 
+#include "helpers/COccupancyGrid.h"
 #include "realtime/IRtSource.h"
 #include "units/IUnit.h"
 
@@ -81,10 +83,31 @@ class CRtAis : public IRtSource {
    */
   bool getShowNames() const;
 
-  ship_t& getShipByMmsi(const QString& key);
-  bool hasShip(const QString& key);
+  /**
+     @brief Get a ship by it's MMSI
+
+     A new ship is created if there is none. The reference is only valid as long
+     as IRtSource::mutex is locked.
+
+     @param mmsi  the ship's MMSI
+     @return A reference to the ship.
+   */
+  ship_t& getShipByMmsi(quint32 mmsi);
+  bool hasShip(quint32 mmsi) const;
+  /**
+     @brief Set the position of a ship and register it with the spatial index
+
+     A new ship is created if there is none. The reference is only valid as long
+     as IRtSource::mutex is locked.
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) override;
+     @param mmsi       the ship's MMSI
+     @param longitude  the longitude in [°]
+     @param latitude   the latitude in [°]
+     @return A reference to the ship.
+   */
+  ship_t& updateShipPosition(quint32 mmsi, qreal longitude, qreal latitude);
+
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) override;
   void fastDraw(QPainter& p, const QRectF& viewport, CRtDraw* rt) override;
   void mouseMove(const QPointF& pos) override;
   static const QString strIcon;
@@ -97,11 +120,30 @@ class CRtAis : public IRtSource {
   void slotSetShowNames(bool yes);
 
  private:
+  /// get the key of the spatial index cell containing the position in [°]
+  static quint64 getCellKey(const QPointF& pos);
+  /// remove all ships without a position report for a while, at most once per second
+  void removeExpiredShips();
+  /// get the ship icon rotated by the heading in [°]
+  const QImage& getShipGlyph(qreal heading);
+
   QPointer<CRtAisInfo> info;
-  QMap<QString, ship_t> ships;
+  QHash<quint32, ship_t> ships;
+  /// the MMSI of all ships with a position by cells of the spatial index
+  QHash<quint64, QSet<quint32> > shipsByCell;
   bool showNames = true;
+  qint64 timeExpired = 0;
+
+  /// the area covered by each ship drawn last, the indices are the same as for shipsDrawn
+  COccupancyGrid gridShips;
+  QVector<quint32> shipsDrawn;
+
+  QImage iconShip;
+  QImage iconAid;
+  /// the ship icon rotated in steps of 1°, created when needed
+  QVector<QImage> glyphsShip;
 
-  QString keyFocus;
+  quint32 mmsiFocus = 0;
 };
 
 #endif  // CRTAIS_H
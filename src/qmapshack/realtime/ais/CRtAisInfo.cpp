@@ -25,6 +25,9 @@
 #include "realtime/ais/CRtAis.h"
 #include "realtime/ais/CRtAisRecord.h"
 
+// lines longer than that are garbage, the NMEA limit is 82 characters
+#define MAX_LINE_LENGTH 1024
+
 CRtAisInfo::CRtAisInfo(CRtAis& source, QWidget* parent) : IRtInfo(&source, parent) {
   setupUi(this);
   connect(toolHelp, &QToolButton::clicked, this, &CRtAisInfo::slotHelp);
@@ -51,7 +54,8 @@ CRtAisInfo::CRtAisInfo(CRtAis& source, QWidget* parent) : IRtInfo(&source, paren
 
   labelStatus->setText("-");
 
-  nmeaDict["VDM"] = [&](const QStringList& t) { nmeaVDM(t); };
+  // the stream has to be parsed in sequence
+  threadPool.setMaxThreadCount(1);
 
   aisDict[positionReportClassA] = [&](const QByteArray& t) { aisClassAcommon(t); };
   aisDict[positionReportClassAassignedScheduled] = [&](const QByteArray& t) { aisClassAcommon(t); };
@@ -63,7 +67,10 @@ CRtAisInfo::CRtAisInfo(CRtAis& source, QWidget* parent) : IRtInfo(&source, paren
   aisDict[staticDataReport] = [&](const QByteArray& t) { aisStatic(t); };
 }
 
-CRtAisInfo::~CRtAisInfo() { socket->disconnect(); }
+CRtAisInfo::~CRtAisInfo() {
+  socket->disconnect();
+  threadPool.waitForDone();
+}
 
 void CRtAisInfo::loadSettings(QSettings& cfg) {
   lineHost->setText(cfg.value("host", "").toString());
@@ -103,6 +110,12 @@ void CRtAisInfo::slotConnect(bool yes) {
   labelStatus->setText("-");
 
   if (yes) {
+    // drop all incomplete data of the last connection
+    threadPool.start([this]() {
+      buffer.clear();
+      fragments.clear();
+    });
+
     lineHost->setEnabled(false);
     spinPort->setEnabled(false);
     socket->connectToHost(lineHost->text(), spinPort->value());
@@ -138,21 +151,8 @@ void CRtAisInfo::slotError(QAbstractSocket::SocketError /*socketError*/) {
 }
 
 void CRtAisInfo::slotReadyRead() {
-  while (socket->canReadLine()) {
-    QString line = socket->readLine();
-    line = line.simplified();
-    if (!verifyLine(line)) {
-      continue;
-    }
-    line.chop(3);
-
-    int start = line.indexOf("!");
-    if (start < 0) {
-      continue;
-    }
-    const QStringList& tokens = line.mid(start + 1).split(',');
-    nmeaDict.value(tokens[0].mid(2), nmeaDefault)(tokens);
-  }
+  const QByteArray& data = socket->readAll();
+  threadPool.start([this, data]() { parse(data); });
 }
 
 void CRtAisInfo::slotUpdate() {
@@ -161,11 +161,18 @@ void CRtAisInfo::slotUpdate() {
 
   checkShowNames->setChecked(_source->getShowNames());
   labelNumberOfShips->setText(QString::number(_source->getNumberOfShips()));
+
+  // the ships are updated by the parser thread, use a copy
+  QMutexLocker lock(&IRtSource::mutex);
   labelTimestamp->setText(lastTimestamp.toString());
 
+  const quint32 mmsi = lineKey->text().toUInt();
+  const bool hasShip = _source->hasShip(mmsi);
+  const CRtAis::ship_t ship = hasShip ? _source->getShipByMmsi(mmsi) : CRtAis::ship_t();
+  lock.unlock();
+
   if (!record.isNull() && toolRecord->isChecked()) {
-    if (_source->hasShip(lineKey->text())) {
-      const CRtAis::ship_t& ship = _source->getShipByMmsi(lineKey->text());
+    if (hasShip) {
       if (!_record->writeEntry(ship)) {
         QMessageBox::critical(this, tr("Error..."), record->getError(), QMessageBox::Ok);
         toolPause->setChecked(true);
@@ -191,61 +198,132 @@ void CRtAisInfo::autoConnect(int msec) {
   }
 }
 
-bool CRtAisInfo::verifyLine(const QString& line) {
+void CRtAisInfo::parse(const QByteArray& data) {
+  buffer += data;
+
+  QList<QByteArray> messages;
+  int start = 0;
+  int end = 0;
+  while ((end = buffer.indexOf('\n', start)) >= 0) {
+    parseLine(buffer.constData() + start, end - start, messages);
+    start = end + 1;
+  }
+  buffer.remove(0, start);
+  if (buffer.size() > MAX_LINE_LENGTH) {
+    buffer.clear();
+  }
+
+  if (messages.isEmpty()) {
+    return;
+  }
+
+  // Apply all messages at once. This will also trigger a single redraw only.
+  {
+    QMutexLocker lock(&IRtSource::mutex);
+    for (const QByteArray& message : qAsConst(messages)) {
+      aisDict.value(message[0], aisDefault)(message);
+    }
+  }
+  emit sigChanged();
+}
+
+void CRtAisInfo::parseLine(const char* line, int size, QList<QByteArray>& messages) {
+  // the sentence starts with '!' and is terminated by the checksum "*hh"
+  const char* start = static_cast<const char*>(memchr(line, '!', size));
+  if (start == nullptr) {
+    return;
+  }
+  size -= start - line + 1;
+  line = start + 1;
+
+  // trim white space and control characters like '\r'
+  while (size > 0 && quint8(line[size - 1]) <= ' ') {
+    size--;
+  }
+  if (size < 3 || line[size - 3] != '*') {
+    return;
+  }
+
   quint8 cs = 0;
-  const QByteArray& data = line.toLatin1();
+  for (int i = 0; i < size - 3; i++) {
+    cs ^= line[i];
+  }
+  bool ok = false;
+  if (QByteArray::fromRawData(line + size - 2, 2).toUInt(&ok, 16) != cs || !ok) {
+    return;
+  }
+  size -= 3;
+
+  // split the sentence into fields: "AIVDM,fragments,fragment number,message ID,channel,payload,fill bits"
+  const char* fields[7];
+  int sizes[7];
+  int n = 0;
+  const char* field = line;
+  const char* const end = line + size;
+  while (n < 7) {
+    const char* next = static_cast<const char*>(memchr(field, ',', end - field));
+    fields[n] = field;
+    sizes[n] = (next == nullptr ? end : next) - field;
+    n++;
+    if (next == nullptr) {
+      break;
+    }
+    field = next + 1;
+  }
 
-  for (int i = 1; i < data.size() - 3; i++) {
-    cs ^= data[i];
+  if (n < 6 || sizes[0] != 5 || memcmp(fields[0] + 2, "VDM", 3) != 0) {
+    return;
   }
 
-  return line.rightRef(2).toInt(0, 16) == cs;
+  const int fragmentCount = QByteArray::fromRawData(fields[1], sizes[1]).toInt();
+  const int fragmentNumber = QByteArray::fromRawData(fields[2], sizes[2]).toInt();
+  const int fragmentId = QByteArray::fromRawData(fields[3], sizes[3]).toInt();
+  const quint8 channel = sizes[4] > 0 ? fields[4][0] : 0;
+
+  nmeaVDM(fragmentCount, fragmentNumber, (channel << 8) | (fragmentId & 0xFF), fields[5], sizes[5], messages);
 }
 
-void CRtAisInfo::nmeaVDM(const QStringList& tokens) {
-  const int fragments = tokens[1].toInt();
-  const int fragmentNumber = tokens[2].toInt();
-  const int fragmentId = tokens[3].toInt();
-  const QByteArray& payload = tokens[5].toLatin1();
+void CRtAisInfo::nmeaVDM(int fragmentCount, int fragmentNumber, quint16 fragmentKey, const char* payload, int size,
+                         QList<QByteArray>& messages) {
+  if (size == 0) {
+    return;
+  }
 
   // AIS data is based on 6bit blocks and is encoded to ASCII characters 48 through 119 in the payload field in VDM
   // sentence. Note that characters 88 through 95 are not used. Looping through all bytes from the payload, subtracting
   // 48 to recover the 6bit blocks. For any characters over 40 we have to subtract another 8 since 88 through 95 are not
   // used. Keep in mind that the bytes (8bit) in the byte array after this are representing a 6bit block
-  QByteArray data(payload.size(), 0);
-  for (int i = 0; i < payload.size(); i++) {
+  QByteArray data(size, Qt::Uninitialized);
+  for (int i = 0; i < size; i++) {
     quint8 c = payload[i] - asciiTo6bitLower;
     if (c > asciiTo6BitGapMarker) c -= asciiTo6bitUpper;
     data[i] = c;
   }
 
-  // VDM sentence is limited by NMEA max sentece length of 82 charaters, which effectively also limits AIS payload. Some
-  // AIS messages are longer than the limit, so then the data is split into multiple VDM sentences. Using fields from
-  // VDM to detect and assemble the data.
-  if (fragments > fragmentNumber) {
-    // qWarning() << "Received fragment";
-    if (fragmentNumber == 1) {
-      assembler.clear();
-    } else if (fragmentNumber != lastFragment + 1 || fragmentId != lastFragmentId) {
-      qWarning() << "Fragment number " << fragmentNumber << " is not after fragment " << lastFragment
-                 << " or fragment id " << fragmentId << " not same as " << lastFragmentId;
-      assembler.clear();
-      lastFragment = 0;
-      return;
-    }
-    assembler.append(data);
-    lastFragment = fragmentNumber;
-    lastFragmentId = fragmentId;
+  if (fragmentCount <= 1) {
+    messages << data;
     return;
-  } else if (fragments == 1) {
-    assembler.clear();
-    lastFragment = 0;
   }
 
-  assembler.append(data);
+  // VDM sentence is limited by NMEA max sentece length of 82 charaters, which effectively also limits AIS payload. Some
+  // AIS messages are longer than the limit, so then the data is split into multiple VDM sentences. Fragments of
+  // different messages can be interleaved. They are told apart by channel and sequential message ID.
+  fragments_t& assembler = fragments[fragmentKey];
+  if (fragmentNumber == 1) {
+    assembler.data = data;
+  } else if (fragmentNumber == assembler.next) {
+    assembler.data += data;
+  } else {
+    qWarning() << "Fragment number " << fragmentNumber << " is not after fragment " << assembler.next - 1;
+    fragments.remove(fragmentKey);
+    return;
+  }
+  assembler.next = fragmentNumber + 1;
 
-  const int type = assembler[0];
-  aisDict.value(type, aisDefault)(assembler);
+  if (fragmentNumber == fragmentCount) {
+    messages << assembler.data;
+    fragments.remove(fragmentKey);
+  }
 }
 
 void CRtAisInfo::aisClassAcommon(const QByteArray& data) {
@@ -263,17 +341,11 @@ void CRtAisInfo::aisClassAcommon(const QByteArray& data) {
   ais.heading = get6bitInt(data, 128, 9);
   ais.second = get6bitInt(data, 137, 6);
 
-  CRtAis::ship_t& ship = _source->getShipByMmsi(QString::number(ais.mmsi));
-  ship.longitude = ais.lon / 600000.0;
-  ship.latitude = ais.lat / 600000.0;
+  CRtAis::ship_t& ship = _source->updateShipPosition(ais.mmsi, ais.lon / 600000.0, ais.lat / 600000.0);
   ship.heading = ais.heading > 360 ? ais.course > 3600 ? -1 : ais.course / 10.0 : ais.heading;
   ship.velocity = ais.speed / 10.0;
-  ship.pos = QPointF(ship.longitude, ship.latitude);
-  ship.timePosition = QDateTime::currentSecsSinceEpoch();
   lastTimestamp = QDateTime::currentDateTime();
 
-  emit sigChanged();
-
   // qWarning() << "A, MMSI:" << ship->mmsi << ", Lat: " << ship->latitude << ", Lon: " << ship->longitude;
 }
 
@@ -302,9 +374,8 @@ void CRtAisInfo::aisStaticAndVoyage(const QByteArray& data) {
   getString(data, ais.destination, 302, 120);
   ais.dte = get6bitInt(data, 422, 1);
 
-  QString mmsi = QString::number(ais.mmsi);
-  if (_source->hasShip(mmsi)) {
-    CRtAis::ship_t& ship = _source->getShipByMmsi(mmsi);
+  if (_source->hasShip(ais.mmsi)) {
+    CRtAis::ship_t& ship = _source->getShipByMmsi(ais.mmsi);
     ship.imo = QString::number(ais.imo);
     ship.callsign = ais.callsign;
     ship.name = ais.shipName;
@@ -315,8 +386,6 @@ void CRtAisInfo::aisStaticAndVoyage(const QByteArray& data) {
 
     lastTimestamp = QDateTime::currentDateTime();
 
-    emit sigChanged();
-
     // qWarning() << "A, MMSI: " << ais.mmsi << ", IMO: " << ais.imo << ", name: " << ais.shipName;
   }
 }
@@ -336,13 +405,9 @@ void CRtAisInfo::aisClassBcommon(const QByteArray& data) {
   ais.heading = get6bitInt(data, 124, 9);
   ais.second = get6bitInt(data, 133, 6);
 
-  CRtAis::ship_t& ship = _source->getShipByMmsi(QString::number(ais.mmsi));
-  ship.longitude = ais.lon / 600000.0;
-  ship.latitude = ais.lat / 600000.0;
+  CRtAis::ship_t& ship = _source->updateShipPosition(ais.mmsi, ais.lon / 600000.0, ais.lat / 600000.0);
   ship.heading = ais.heading > 360 ? ais.course > 3600 ? -1 : ais.course / 10.0 : ais.heading;
   ship.velocity = ais.speed / 10.0;
-  ship.pos = QPointF(ship.longitude, ship.latitude);
-  ship.timePosition = QDateTime::currentSecsSinceEpoch();
 
   // Type 19 have extended data
   if (ais.type == extendedClassBequipmentPositionReport) {
@@ -362,8 +427,6 @@ void CRtAisInfo::aisClassBcommon(const QByteArray& data) {
 
   lastTimestamp = QDateTime::currentDateTime();
 
-  emit sigChanged();
-
   // qWarning() << "B, MMSI:" << ship->mmsi << ", Lat: " << ship->latitude << ", Lon: " << ship->longitude;
 }
 
@@ -384,11 +447,7 @@ void CRtAisInfo::aisAidToNavigation(const QByteArray& data) {
   ais.dimToPort = get6bitInt(data, 237, 6);
   ais.dimToStarboard = get6bitInt(data, 243, 6);
 
-  CRtAis::ship_t& ship = _source->getShipByMmsi(QString::number(ais.mmsi));
-  ship.longitude = ais.lon / 600000.0;
-  ship.latitude = ais.lat / 600000.0;
-  ship.pos = QPointF(ship.longitude, ship.latitude);
-  ship.timePosition = QDateTime::currentSecsSinceEpoch();
+  CRtAis::ship_t& ship = _source->updateShipPosition(ais.mmsi, ais.lon / 600000.0, ais.lat / 600000.0);
   ship.name = ais.name;
   ship.aid = true;
   ship.heading = -1;
@@ -398,8 +457,6 @@ void CRtAisInfo::aisAidToNavigation(const QByteArray& data) {
   ship.type = aidTypeMap.value(ais.aidType, tr("Unknown"));
 
   lastTimestamp = QDateTime::currentDateTime();
-
-  emit sigChanged();
 }
 
 void CRtAisInfo::aisStatic(const QByteArray& data) {
@@ -414,15 +471,12 @@ void CRtAisInfo::aisStatic(const QByteArray& data) {
   if (part == 0) {
     getString(data, ais.shipName, 40, 120);
 
-    QString mmsi = QString::number(ais.mmsi);
-    if (_source->hasShip(mmsi)) {
-      CRtAis::ship_t& ship = _source->getShipByMmsi(mmsi);
+    if (_source->hasShip(ais.mmsi)) {
+      CRtAis::ship_t& ship = _source->getShipByMmsi(ais.mmsi);
       ship.name = ais.shipName;
 
       lastTimestamp = QDateTime::currentDateTime();
 
-      emit sigChanged();
-
       // qWarning() << "BA, MMSI: " << ais.mmsi << ", name: " << ais.shipName;
     }
   } else if (part == 1) {
@@ -433,9 +487,8 @@ void CRtAisInfo::aisStatic(const QByteArray& data) {
     ais.dimToPort = get6bitInt(data, 150, 6);
     ais.dimToStarboard = get6bitInt(data, 156, 6);
 
-    QString mmsi = QString::number(ais.mmsi);
-    if (_source->hasShip(mmsi)) {
-      CRtAis::ship_t& ship = _source->getShipByMmsi(mmsi);
+    if (_source->hasShip(ais.mmsi)) {
+      CRtAis::ship_t& ship = _source->getShipByMmsi(ais.mmsi);
       ship.callsign = ais.callsign;
       ship.width = ais.dimToPort + ais.dimToStarboard;
       ship.length = ais.dimToBow + ais.dimToStern;
@@ -443,8 +496,6 @@ void CRtAisInfo::aisStatic(const QByteArray& data) {
 
       lastTimestamp = QDateTime::currentDateTime();
 
-      emit sigChanged();
-
       // qWarning() << "BB, MMSI: " << ais.mmsi << ", callsign: " << ais.shipName;
     }
   }
@@ -21,6 +21,7 @@
 
 #include <QPointer>
 #include <QTcpSocket>
+#include <QThreadPool>
 
 #include "realtime/IRtInfo.h"
 #include "ui_IRtAisInfo.h"
@@ -54,12 +55,26 @@ class CRtAisInfo : public IRtInfo, private Ui::IRtAisInfo {
   void startRecord(const QString& filename) override;
   void fillTrackData(CTrackData& data) override;
 
-  bool verifyLine(const QString& line);
   void disconnectFromHost();
   void autoConnect(int msec);
 
-  using fNmeaHandler = std::function<void(const QStringList&)>;
-  fNmeaHandler nmeaDefault = [&](const QStringList& t) { qDebug() << t[0] << "unknown"; };
+  /**
+     @brief Parse a chunk of the NMEA stream
+
+     This is running in the parser thread. Incomplete lines are kept until the next
+     chunk arrives. All AIS messages found in the chunk are applied to the ships at once.
+
+     @param data  the data as read from the socket
+   */
+  void parse(const QByteArray& data);
+  /**
+     @brief Parse a single NMEA sentence
+
+     @param line      the sentence without line feed
+     @param size      the length of the sentence
+     @param messages  complete AIS messages are appended as 6bit blocks
+   */
+  void parseLine(const char* line, int size, QList<QByteArray>& messages);
 
   using fAisHandler = std::function<void(const QByteArray&)>;
   fAisHandler aisDefault = [&](const QByteArray& t) { qDebug() << QString::number(t[0]) << "unknown"; };
@@ -256,7 +271,8 @@ class CRtAisInfo : public IRtInfo, private Ui::IRtAisInfo {
   static constexpr quint8 asciiTo6BitGapMarker = 40;
   static constexpr quint8 asciiTo6bitUpper = 8;
 
-  void nmeaVDM(const QStringList& tokens);
+  void nmeaVDM(int fragmentCount, int fragmentNumber, quint16 fragmentKey, const char* payload, int size,
+               QList<QByteArray>& messages);
 
   void aisClassAcommon(const QByteArray& data);
   void aisStaticAndVoyage(const QByteArray& data);
@@ -267,14 +283,22 @@ class CRtAisInfo : public IRtInfo, private Ui::IRtAisInfo {
   QTcpSocket* socket;
   QTimer* timer;
 
-  QHash<QString, fNmeaHandler> nmeaDict;
   QHash<quint8, fAisHandler> aisDict;
 
   QDateTime lastTimestamp;
 
-  QByteArray assembler;
-  quint8 lastFragment = 0;
-  quint8 lastFragmentId = 0;
+  /// the parser thread
+  QThreadPool threadPool;
+
+  /// the data of the last chunk not terminated by a line feed yet
+  QByteArray buffer;
+
+  struct fragments_t {
+    QByteArray data;
+    int next = 0;
+  };
+  /// the messages split into several sentences by channel and sequential message ID
+  QHash<quint16, fragments_t> fragments;
 };
 
 #endif  // CRTAISINFO_H
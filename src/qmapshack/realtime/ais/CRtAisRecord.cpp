@@ -36,7 +36,6 @@ bool CRtAisRecord::writeEntry(const CRtAis::ship_t& ship) {
   trkpt.time = QDateTime::fromTime_t(ship.timePosition);
 
   stream << trkpt;
-  track << trkpt;
 
-  return writeEntry(data);
+  return writeEntry(data, trkpt);
 }
@@ -78,7 +78,7 @@ QString CRtGpsTether::getDescription() const {
       "Get position via NMEA over TCP/IP.");
 }
 
-void CRtGpsTether::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) {
+void CRtGpsTether::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) {
   if (info.isNull()) {
     return;
   }
@@ -39,7 +39,7 @@ class CRtGpsTether : public IRtSource {
   void loadSettings(QSettings& cfg) override;
   void saveSettings(QSettings& cfg) const override;
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) override;
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) override;
 
   void fastDraw(QPainter& p, const QRectF& viewport, CRtDraw* rt) override;
 
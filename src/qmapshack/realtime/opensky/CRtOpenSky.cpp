@@ -18,7 +18,6 @@
 
 #include "realtime/opensky/CRtOpenSky.h"
 
-#include <QJsonDocument>
 #include <QtNetwork>
 #include <QtWidgets>
 
@@ -26,9 +25,16 @@
 #include "realtime/CRtDraw.h"
 #include "realtime/opensky/CRtOpenSkyInfo.h"
 
+// the number of values of a state vector up to the position source
+#define MIN_STATE_VALUES 17
+
 const QString CRtOpenSky::strIcon("://icons/48x48/OpenSky.png");
 
-CRtOpenSky::CRtOpenSky(QTreeWidget* parent) : IRtSource(eTypeOpenSky, true, parent) {
+CRtOpenSky::CRtOpenSky(QTreeWidget* parent)
+    : IRtSource(eTypeOpenSky, true, parent),
+      parser([this](const QVector<CRtOpenSkyParser::value_t>& values) { updateAircraft(values); }),
+      iconAircraft("://icons/16x16/Aircraft.png"),
+      glyphsAircraft(360) {
   setIcon(eColumnIcon, QIcon(strIcon));
   setText(eColumnName, "OpenSky");
   setCheckState(eColumnCheckBox, Qt::Checked);
@@ -105,56 +111,79 @@ bool CRtOpenSky::getShowNames() const {
 
 CRtOpenSky::aircraft_t CRtOpenSky::getAircraftByKey(const QString& key, bool& ok) const {
   QMutexLocker lock(&IRtSource::mutex);
-  ok = false;
-  if (aircrafts.contains(key)) {
-    ok = true;
-    return aircrafts[key];
-  }
+  const auto& aircraft = aircrafts.constFind(key);
+  ok = aircraft != aircrafts.constEnd();
+  return ok ? *aircraft : aircraft_t();
+}
 
-  return aircraft_t();
+const QImage& CRtOpenSky::getAircraftGlyph(qreal heading) {
+  const int angle = ((qRound(heading) % 360) + 360) % 360;
+  QImage& glyph = glyphsAircraft[angle];
+  if (glyph.isNull()) {
+    // large enough for all angles
+    const int size = qCeil(M_SQRT2 * qMax(iconAircraft.width(), iconAircraft.height()));
+    glyph = QImage(size, size, QImage::Format_ARGB32_Premultiplied);
+    glyph.fill(Qt::transparent);
+
+    QPainter p(&glyph);
+    USE_ANTI_ALIASING(p, true);
+    p.translate(size / 2.0, size / 2.0);
+    p.rotate(angle);
+    p.drawImage(QPointF(-iconAircraft.width() / 2.0, -iconAircraft.height() / 2.0), iconAircraft);
+  }
+  return glyph;
 }
 
-void CRtOpenSky::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) {
+void CRtOpenSky::drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) {
   if (checkState(eColumnCheckBox) != Qt::Checked) {
     return;
   }
 
   QPolygonF tmp2 = viewport;
   rt->convertRad2Px(tmp2);
+  const QRectF& rectView = tmp2.boundingRect();
+
+  // On a partial redraw only aircrafts close to the clip region have to be painted.
+  // The margin covers the icon and the label.
+  QRectF rectDraw = rectView;
+  if (p.hasClipping()) {
+    rectDraw &= p.clipBoundingRect().adjusted(-CRtDraw::DIRTY_MARGIN, -CRtDraw::DIRTY_MARGIN, CRtDraw::DIRTY_MARGIN,
+                                              CRtDraw::DIRTY_MARGIN);
+  }
+
+  gridAircrafts.reset(rectView, 32);
+  aircraftsDrawn.clear();
 
   QFontMetrics fm(p.font());
 
-  p.setPen(Qt::yellow);
-  p.setBrush(Qt::yellow);
-  QPixmap icon("://icons/16x16/Aircraft.png");
-  QRect rectIcon = icon.rect();
-  rectIcon.moveCenter(QPoint(0, 0));
+  for (auto aircraft = aircrafts.begin(); aircraft != aircrafts.end(); ++aircraft) {
+    aircraft->point = aircraft->pos * DEG_TO_RAD;
+    rt->convertRad2Px(aircraft->point);
 
-  const QStringList& keys = aircrafts.keys();
-  for (const QString& key : keys) {
-    aircraft_t& aircraft = aircrafts[key];
+    if (!rectView.contains(aircraft->point)) {
+      continue;
+    }
 
-    aircraft.point = aircraft.pos * DEG_TO_RAD;
-    rt->convertRad2Px(aircraft.point);
+    gridAircrafts.insert(QRectF(aircraft->point - QPointF(20, 20), QSizeF(40, 40)));
+    aircraftsDrawn << aircraft.key();
 
-    if (!tmp2.boundingRect().contains(aircraft.point)) {
+    if (!rectDraw.contains(aircraft->point)) {
       continue;
     }
 
-    p.save();
-    p.translate(aircraft.point);
-    p.rotate(aircraft.heading);
-    p.drawPixmap(rectIcon, icon);
-    p.restore();
+    const QImage& icon = getAircraftGlyph(aircraft->heading);
+    QRectF rectIcon(QPointF(), icon.size());
+    rectIcon.moveCenter(aircraft->point);
+    p.drawImage(rectIcon.topLeft(), icon);
 
     if (showNames) {
-      QString name = aircraft.callsign.isEmpty() ? tr("unkn.") : aircraft.callsign;
+      const QString& name = aircraft->callsign.isEmpty() ? tr("unkn.") : aircraft->callsign;
       QRect rectLabel = fm.boundingRect(name);
-      rectLabel.moveCenter(aircraft.point.toPoint() + QPoint(0, -8));
+      rectLabel.moveCenter(aircraft->point.toPoint() + QPoint(0, -8));
       rectLabel.adjust(-1, -1, 1, 1);
       if (!CDraw::doesOverlap(blockedAreas, rectLabel)) {
         CDraw::text(name, p, rectLabel.center(), Qt::darkBlue);
-        blockedAreas << rectLabel;
+        blockedAreas.insert(rectLabel);
       }
     }
   }
@@ -165,10 +194,11 @@ void CRtOpenSky::drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>&
 }
 
 void CRtOpenSky::fastDraw(QPainter& p, const QRectF& viewport, CRtDraw* rt) {
-  if (!keyFocus.isEmpty() && aircrafts.contains(keyFocus)) {
+  const auto& focus = aircrafts.constFind(keyFocus);
+  if (!keyFocus.isEmpty() && focus != aircrafts.constEnd()) {
     p.save();
 
-    const aircraft_t& aircraft = aircrafts[keyFocus];
+    const aircraft_t& aircraft = *focus;
     p.setPen(Qt::red);
     p.setBrush(Qt::NoBrush);
     p.drawEllipse(aircraft.point, 10, 10);
@@ -223,11 +253,12 @@ void CRtOpenSky::mouseMove(const QPointF& pos) {
   QMutexLocker lock(&IRtSource::mutex);
 
   keyFocus.clear();
-  const QStringList& keys = aircrafts.keys();
-  for (const QString& key : keys) {
-    const aircraft_t& aircraft = aircrafts[key];
-    if ((aircraft.point - pos).manhattanLength() < 20) {
-      keyFocus = key;
+  QVector<qint32> hits;
+  gridAircrafts.findAll(QRectF(pos - QPointF(1, 1), QSizeF(2, 2)), hits);
+  for (qint32 idx : hits) {
+    const auto& aircraft = aircrafts.constFind(aircraftsDrawn[idx]);
+    if ((aircraft != aircrafts.constEnd()) && ((aircraft->point - pos).manhattanLength() < 20)) {
+      keyFocus = aircraft.key();
       break;
     }
   }
@@ -244,67 +275,129 @@ void CRtOpenSky::slotUpdate() {
     return;
   }
 
+  if (!replyPending.isNull()) {
+    // the last response is still streaming in
+    if (replyProgress) {
+      replyProgress = false;
+      return;
+    }
+
+    // The connection has stalled since the last tick. Abort it. Else no request would be sent anymore.
+    qDebug() << "OpenSky: abort stalled request";
+    QNetworkReply* reply = replyPending;
+    replyPending.clear();
+    reply->abort();
+
+    // redraw the aircrafts updated so far
+    QVector<QRectF> areas;
+    {
+      QMutexLocker lock(&IRtSource::mutex);
+      areas.swap(areasChanged);
+    }
+    emit sigChangedArea(areas);
+  }
+
   QUrl url("https://opensky-network.org/");
   url.setPath("/api/states/all");
 
   QNetworkRequest request;
   request.setUrl(url);
-  networkAccessManager->get(request);
-}
 
-void CRtOpenSky::slotRequestFinished(QNetworkReply* reply) {
-  if (reply->error() != QNetworkReply::NoError) {
-    qDebug() << reply->errorString();
-    reply->deleteLater();
-    return;
-  }
+  QMutexLocker lock(&IRtSource::mutex);
+  parser.reset();
+  areasChanged.clear();
+  update++;
 
-  QByteArray data = reply->readAll();
-  reply->deleteLater();
+  replyPending = networkAccessManager->get(request);
+  replyProgress = false;
+  connect(replyPending, &QNetworkReply::readyRead, this, &CRtOpenSky::slotReadyRead);
+}
 
-  if (data.isEmpty()) {
+void CRtOpenSky::slotReadyRead() {
+  if (replyPending.isNull() || replyPending->error() != QNetworkReply::NoError) {
     return;
   }
 
-  QJsonParseError error;
-  QJsonDocument json = QJsonDocument::fromJson(data, &error);
-  if (error.error != QJsonParseError::NoError) {
-    qDebug() << error.errorString();
+  replyProgress = true;
+  QMutexLocker lock(&IRtSource::mutex);
+  parser.feed(replyPending->readAll());
+}
+
+void CRtOpenSky::slotRequestFinished(QNetworkReply* reply) {
+  reply->deleteLater();
+  if (reply != replyPending) {
     return;
   }
+  replyPending.clear();
 
+  // Aircrafts are updated while the response streams in. Even if the response is broken
+  // the areas of the aircrafts updated so far have to be redrawn.
+  QVector<QRectF> areas;
   {
     QMutexLocker lock(&IRtSource::mutex);
-    aircrafts.clear();
-
-    timestamp = QDateTime::fromTime_t(json.object().value("time").toInt());
-    const QJsonArray& jsonStates = json.object().value("states").toArray();
-    for (const QJsonValue& jsonState : jsonStates) {
-      aircraft_t aircraft;
-      const QJsonArray& jsonStateArray = jsonState.toArray();
-      QString key = jsonStateArray[0].toString();
-
-      aircraft.key = key;
-      aircraft.callsign = jsonStateArray[1].toString();
-      aircraft.originCountry = jsonStateArray[2].toString();
-      aircraft.timePosition = jsonStateArray[3].toInt();
-      aircraft.lastContact = jsonStateArray[4].toInt();
-      aircraft.longitude = jsonStateArray[5].toDouble();
-      aircraft.latitude = jsonStateArray[6].toDouble();
-      aircraft.geoAltitude = jsonStateArray[7].toDouble();
-      aircraft.onGround = jsonStateArray[8].toBool();
-      aircraft.velocity = jsonStateArray[9].toDouble();
-      aircraft.heading = jsonStateArray[10].toDouble();
-      aircraft.verticalRate = jsonStateArray[11].toDouble();
-      aircraft.baroAltitude = jsonStateArray[13].toDouble();
-      aircraft.squawk = jsonStateArray[14].toString();
-      aircraft.spi = jsonStateArray[15].toBool();
-      aircraft.positionSource = jsonStateArray[16].toInt();
-
-      aircraft.pos = QPointF(aircraft.longitude, aircraft.latitude);
-      aircrafts[key] = aircraft;
+    if (reply->error() != QNetworkReply::NoError) {
+      qDebug() << reply->errorString();
+    } else {
+      parser.feed(reply->readAll());
+
+      // keep the state of the aircrafts not updated if the response is broken
+      if (parser.hasError() || !parser.isFinished()) {
+        qDebug() << "OpenSky: invalid response";
+      } else {
+        timestamp = QDateTime::fromTime_t(parser.getTime());
+
+        // aircrafts not part of the response have vanished
+        for (auto aircraft = aircrafts.begin(); aircraft != aircrafts.end();) {
+          if (aircraft->update == update) {
+            ++aircraft;
+            continue;
+          }
+          const QPointF& pos = aircraft->pos * DEG_TO_RAD;
+          areasChanged << QRectF(pos, pos);
+          aircraft = aircrafts.erase(aircraft);
+        }
+      }
     }
+
+    areas.swap(areasChanged);
   }
 
-  emit sigChanged();
+  emit sigChangedArea(areas);
+}
+
+void CRtOpenSky::updateAircraft(const QVector<CRtOpenSkyParser::value_t>& values) {
+  if (values.count() < MIN_STATE_VALUES) {
+    return;
+  }
+
+  const QString& key = values[0].toString();
+  aircraft_t& aircraft = aircrafts[key];
+  const QPointF posPrev = aircraft.pos;
+  const qreal headingPrev = aircraft.heading;
+  const QString callsignPrev = aircraft.callsign;
+
+  aircraft.key = key;
+  aircraft.callsign = values[1].toString();
+  aircraft.originCountry = values[2].toString();
+  aircraft.timePosition = values[3].toInt();
+  aircraft.lastContact = values[4].toInt();
+  aircraft.longitude = values[5].toDouble();
+  aircraft.latitude = values[6].toDouble();
+  aircraft.geoAltitude = values[7].toDouble();
+  aircraft.onGround = values[8].toBool();
+  aircraft.velocity = values[9].toDouble();
+  aircraft.heading = values[10].toDouble();
+  aircraft.verticalRate = values[11].toDouble();
+  aircraft.baroAltitude = values[13].toDouble();
+  aircraft.squawk = values[14].toString();
+  aircraft.spi = values[15].toBool();
+  aircraft.positionSource = values[16].toInt();
+
+  aircraft.pos = QPointF(aircraft.longitude, aircraft.latitude);
+  aircraft.update = update;
+
+  if (posPrev != aircraft.pos || headingPrev != aircraft.heading || callsignPrev != aircraft.callsign) {
+    const QPointF& pos = aircraft.pos * DEG_TO_RAD;
+    areasChanged << QRectF(posPrev == NOPOINTF ? pos : posPrev * DEG_TO_RAD, pos).normalized();
+  }
 }
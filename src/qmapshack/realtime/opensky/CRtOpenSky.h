@@ -20,9 +20,13 @@
 #define CRTOPENSKY_H
 
 #include <QDateTime>
+#include <QHash>
+#include <QImage>
 #include <QPointer>
 
+#include "helpers/COccupancyGrid.h"
 #include "realtime/IRtSource.h"
+#include "realtime/opensky/CRtOpenSkyParser.h"
 #include "units/IUnit.h"
 
 class QTimer;
@@ -57,6 +61,9 @@ class CRtOpenSky : public IRtSource {
     QString squawk;
     bool spi = false;
     qint32 positionSource = NOINT;
+
+    /// the number of the update the aircraft has been part of last
+    quint32 update = 0;
   };
 
   /**
@@ -92,7 +99,7 @@ class CRtOpenSky : public IRtSource {
 
   aircraft_t getAircraftByKey(const QString& key, bool& ok) const;
 
-  void drawItem(QPainter& p, const QPolygonF& viewport, QList<QRectF>& blockedAreas, CRtDraw* rt) override;
+  void drawItem(QPainter& p, const QPolygonF& viewport, COccupancyGrid& blockedAreas, CRtDraw* rt) override;
   void fastDraw(QPainter& p, const QRectF& viewport, CRtDraw* rt) override;
   void mouseMove(const QPointF& pos) override;
   static const QString strIcon;
@@ -109,6 +116,10 @@ class CRtOpenSky : public IRtSource {
      @brief Request a new data set from OpenSky
    */
   void slotUpdate();
+  /**
+     @brief Feed the next chunk of the pending reply into the parser
+   */
+  void slotReadyRead();
   /**
      @brief Handle incoming data set from OpenSky
      @param reply
@@ -116,14 +127,40 @@ class CRtOpenSky : public IRtSource {
   void slotRequestFinished(QNetworkReply* reply);
 
  private:
+  /**
+     @brief Update the aircraft of a state vector in place
+
+     Aircrafts that are new or have changed position, heading or callsign
+     add their old and new position to the list of changed areas.
+   */
+  void updateAircraft(const QVector<CRtOpenSkyParser::value_t>& values);
+  const QImage& getAircraftGlyph(qreal heading);
+
   QPointer<CRtOpenSkyInfo> info;
   QTimer* timer;
   QNetworkAccessManager* networkAccessManager;
+  /// the reply currently parsed, a new request is not sent before it is finished or aborted
+  QPointer<QNetworkReply> replyPending;
+  /// true if data of the pending reply has arrived since the last timer tick. If not, the reply is aborted.
+  bool replyProgress = false;
+  CRtOpenSkyParser parser;
 
   QDateTime timestamp;
-  QMap<QString, aircraft_t> aircrafts;
+  QHash<QString, aircraft_t> aircrafts;
+  /// the number of the current update
+  quint32 update = 0;
+  /// the bounding boxes of all changed aircrafts in [rad]
+  QVector<QRectF> areasChanged;
   bool showNames = true;
 
+  /// the area covered by each aircraft drawn last, the indices are the same as for aircraftsDrawn
+  COccupancyGrid gridAircrafts;
+  QVector<QString> aircraftsDrawn;
+
+  QImage iconAircraft;
+  /// the aircraft icon rotated in steps of 1°
+  QVector<QImage> glyphsAircraft;
+
   QString keyFocus;
 };
 
@@ -26,6 +26,7 @@
 CRtOpenSkyInfo::CRtOpenSkyInfo(CRtOpenSky& source, QWidget* parent) : IRtInfo(&source, parent) {
   setupUi(this);
   connect(&source, &CRtOpenSky::sigChanged, this, &CRtOpenSkyInfo::slotUpdate);
+  connect(&source, &CRtOpenSky::sigChangedArea, this, &CRtOpenSkyInfo::slotUpdate);
   connect(checkShowNames, &QCheckBox::toggled, &source, &CRtOpenSky::slotSetShowNames);
   connect(toolPause, &QToolButton::toggled, toolReset, &QToolButton::setEnabled);
   connect(toolPause, &QToolButton::toggled, toolFile, &QToolButton::setEnabled);
@@ -0,0 +1,230 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#include "realtime/opensky/CRtOpenSkyParser.h"
+
+// the container depth of the values of a state vector: root object, states array, state vector
+#define DEPTH_ROOT 1
+#define DEPTH_STATES 2
+#define DEPTH_STATE 3
+
+static inline bool isLiteral(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+static QByteArray unescape(const QByteArray& raw) {
+  QString str;
+  QByteArray run;
+  const int N = raw.size();
+  for (int i = 0; i < N; i++) {
+    char c = raw[i];
+    if (c != '\\' || (i + 1) == N) {
+      run += c;
+      continue;
+    }
+
+    c = raw[++i];
+    switch (c) {
+      case 'b':
+        run += '\b';
+        break;
+      case 'f':
+        run += '\f';
+        break;
+      case 'n':
+        run += '\n';
+        break;
+      case 'r':
+        run += '\r';
+        break;
+      case 't':
+        run += '\t';
+        break;
+      case 'u':
+        str += QString::fromUtf8(run);
+        run.clear();
+        str += QChar(raw.mid(i + 1, 4).toUShort(nullptr, 16));
+        i += 4;
+        break;
+      default:
+        // \" \\ and \/
+        run += c;
+    }
+  }
+  str += QString::fromUtf8(run);
+  return str.toUtf8();
+}
+
+CRtOpenSkyParser::CRtOpenSkyParser(const fState& onState) : onState(onState) {}
+
+void CRtOpenSkyParser::reset() {
+  stack.clear();
+  token.clear();
+  values.clear();
+  key.clear();
+  time = 0;
+  inString = false;
+  inEscape = false;
+  hasEscape = false;
+  inLiteral = false;
+  expectKey = false;
+  inStates = false;
+  finished = false;
+  error = false;
+}
+
+bool CRtOpenSkyParser::feed(const QByteArray& data) {
+  const char* p = data.constData();
+  const char* end = p + data.size();
+
+  while (p < end && !error) {
+    if (inString) {
+      // scan for the closing quote, the string can be continued with the next chunk
+      const char* start = p;
+      while (p < end) {
+        if (inEscape) {
+          inEscape = false;
+        } else if (*p == '\\') {
+          inEscape = true;
+          hasEscape = true;
+        } else if (*p == '"') {
+          break;
+        }
+        ++p;
+      }
+      token.append(start, p - start);
+      if (p == end) {
+        break;
+      }
+      ++p;
+      inString = false;
+      addValue(true);
+      continue;
+    }
+
+    if (isLiteral(*p)) {
+      if (!inLiteral) {
+        token.clear();
+        inLiteral = true;
+      }
+      const char* start = p;
+      while (p < end && isLiteral(*p)) {
+        ++p;
+      }
+      token.append(start, p - start);
+      continue;
+    }
+
+    if (inLiteral) {
+      inLiteral = false;
+      addValue(false);
+    }
+
+    const char c = *p++;
+    switch (c) {
+      case '"':
+        inString = true;
+        hasEscape = false;
+        token.clear();
+        break;
+
+      case '{':
+      case '[':
+        open(c);
+        break;
+
+      case '}':
+      case ']':
+        close(c);
+        break;
+
+      case ',':
+        expectKey = stack.size() == DEPTH_ROOT;
+        break;
+
+      case ':':
+        break;
+
+      default:
+        if (quint8(c) > ' ') {
+          error = true;
+        }
+    }
+  }
+
+  return !error;
+}
+
+void CRtOpenSkyParser::addValue(bool isString) {
+  const int depth = stack.size();
+  if (depth == DEPTH_ROOT) {
+    if (isString && expectKey) {
+      key = token;
+      expectKey = false;
+    } else if (key == "time") {
+      time = token.toLongLong();
+    }
+  } else if (depth == DEPTH_STATE && inStates) {
+    value_t value;
+    value.data = (isString && hasEscape) ? unescape(token) : token;
+    value.isString = isString;
+    values << value;
+  } else if (depth == 0) {
+    error = true;
+  }
+}
+
+void CRtOpenSkyParser::open(char c) {
+  const int depth = stack.size();
+  if (depth == 0 && (c != '{' || finished)) {
+    error = true;
+    return;
+  }
+
+  if (depth == DEPTH_ROOT) {
+    inStates = (c == '[') && (key == "states");
+  } else if (depth == DEPTH_STATES && inStates) {
+    values.clear();
+  } else if (depth == DEPTH_STATE && inStates) {
+    // nested containers are not parsed but take their place as null value
+    values << value_t();
+  }
+
+  stack += c;
+  expectKey = (c == '{') && (stack.size() == DEPTH_ROOT);
+}
+
+void CRtOpenSkyParser::close(char c) {
+  const char expected = c == '}' ? '{' : '[';
+  if (stack.isEmpty() || stack[stack.size() - 1] != expected) {
+    error = true;
+    return;
+  }
+
+  const int depth = stack.size();
+  if (depth == DEPTH_STATE && inStates) {
+    if (onState) {
+      onState(values);
+    }
+  } else if (depth == DEPTH_STATES) {
+    inStates = false;
+  }
+
+  stack.chop(1);
+  finished = stack.isEmpty();
+}
@@ -0,0 +1,103 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#ifndef CRTOPENSKYPARSER_H
+#define CRTOPENSKYPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+   @brief Incremental parser for the response of OpenSky's "/api/states/all"
+
+   The response is a JSON object with the keys "time" and "states". The latter
+   is an array of state vectors, each an array of values. Instead of building
+   a document of the complete response the parser is fed with the chunks as they
+   arrive from the network. Each state vector is passed to the callback as soon
+   as it is complete. Nested containers within a state vector (e.g. the sensor
+   list) are passed as null values.
+ */
+class CRtOpenSkyParser {
+ public:
+  /// a single value of a state vector
+  struct value_t {
+    /// the raw literal or the UTF8 string without quotes and escapes
+    QByteArray data;
+    bool isString = false;
+
+    /// the conversion follows QJsonValue, e.g. a null value becomes an empty string
+    QString toString() const { return isString ? QString::fromUtf8(data) : QString(); }
+    qreal toDouble() const { return isString ? 0 : data.toDouble(); }
+    qint32 toInt() const { return qint32(toDouble()); }
+    bool toBool() const { return !isString && data == "true"; }
+  };
+
+  using fState = std::function<void(const QVector<value_t>&)>;
+
+  CRtOpenSkyParser(const fState& onState);
+  virtual ~CRtOpenSkyParser() = default;
+
+  /// prepare for a new response
+  void reset();
+
+  /**
+     @brief Parse the next chunk of the response
+
+     @param data  the chunk, it can split the response at any byte
+     @return Return false if the response is not valid JSON.
+   */
+  bool feed(const QByteArray& data);
+
+  /// true if the response's root object is complete
+  bool isFinished() const { return finished; }
+  /// true if the response is not valid JSON
+  bool hasError() const { return error; }
+  /// the value of "time" as seconds since epoch
+  qint64 getTime() const { return time; }
+
+ private:
+  void addValue(bool isString);
+  void open(char c);
+  void close(char c);
+
+  const fState onState;
+
+  /// the currently open containers, '{' or '['
+  QByteArray stack;
+  /// the current string or literal
+  QByteArray token;
+  /// the values of the current state vector
+  QVector<value_t> values;
+  /// the last key of the root object
+  QByteArray key;
+
+  qint64 time = 0;
+
+  bool inString = false;
+  bool inEscape = false;
+  bool hasEscape = false;
+  bool inLiteral = false;
+  bool expectKey = false;
+  bool inStates = false;
+  bool finished = false;
+  bool error = false;
+};
+
+#endif  // CRTOPENSKYPARSER_H
@@ -36,7 +36,6 @@ bool CRtOpenSkyRecord::writeEntry(const CRtOpenSky::aircraft_t& aircraft) {
   trkpt.time = QDateTime::fromTime_t(aircraft.timePosition);
 
   stream << trkpt;
-  track << trkpt;
 
-  return writeEntry(data);
+  return writeEntry(data, trkpt);
 }
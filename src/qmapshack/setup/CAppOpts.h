@@ -22,6 +22,7 @@
  * including the positional arguments.
  */
 
+#include <QSize>
 #include <QStringList>
 
 class CAppOpts {
@@ -32,8 +33,25 @@ class CAppOpts {
   const QString configfile;
   const QStringList arguments;
 
-  CAppOpts(bool doDebug, bool doLogfile, bool noSplash, const QString& config, const QStringList& args)
-      : debug(doDebug), logfile(doLogfile), nosplash(noSplash), configfile(config), arguments(args) {}
+  const QString exportView;  // --export-view, render view file without window
+  const QString exportFile;  // --export-file, the image file to write
+  const QSize exportSize;    // --export-size, the image size in pixel
+  const int exportTileSize;  // --export-tile-size, the tile edge length in pixel
+  const int exportThreads;   // --export-threads, number of tiles rendered in parallel
+
+  CAppOpts(bool doDebug, bool doLogfile, bool noSplash, const QString& config, const QStringList& args,
+           const QString& view = QString(), const QString& file = QString(), const QSize& size = QSize(),
+           int tileSize = 512, int threads = 1)
+      : debug(doDebug),
+        logfile(doLogfile),
+        nosplash(noSplash),
+        configfile(config),
+        arguments(args),
+        exportView(view),
+        exportFile(file),
+        exportSize(size),
+        exportTileSize(tileSize),
+        exportThreads(threads) {}
 };
 
 extern CAppOpts* qlOpts;
@@ -20,6 +20,7 @@
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QThread>
 #include <iostream>
 
 CAppOpts* CCommandProcessor::processOptions(const QStringList& arguments) {
@@ -46,6 +47,26 @@ CAppOpts* CCommandProcessor::processOptions(const QStringList& arguments) {
                                   tr("File with QMapShack configuration."), tr("file"));
   parser.addOption(configOption);
 
+  QCommandLineOption exportViewOption(
+      "export-view", tr("Render the view stored in file into an image without showing a window."), tr("file"));
+  parser.addOption(exportViewOption);
+
+  QCommandLineOption exportFileOption("export-file", tr("Image file (*.tif, *.png, *.jpg) to write by --export-view."),
+                                      tr("file"));
+  parser.addOption(exportFileOption);
+
+  QCommandLineOption exportSizeOption("export-size", tr("Size of the exported image centered on the view's focus."),
+                                      tr("WxH"));
+  parser.addOption(exportSizeOption);
+
+  QCommandLineOption exportTileSizeOption("export-tile-size", tr("Edge length of the tiles rendered by --export-view."),
+                                          tr("pixel"), "512");
+  parser.addOption(exportTileSizeOption);
+
+  QCommandLineOption exportThreadsOption("export-threads", tr("Number of tiles rendered in parallel."), tr("count"),
+                                         QString::number(QThread::idealThreadCount()));
+  parser.addOption(exportThreadsOption);
+
   parser.addPositionalArgument("files", tr("Files for future use."));
 
   if (!parser.parse(arguments)) {
@@ -58,6 +79,22 @@ CAppOpts* CCommandProcessor::processOptions(const QStringList& arguments) {
     exit(0);
   }
 
+  QSize exportSize;
+  if (parser.isSet(exportViewOption)) {
+    const QStringList& size = parser.value(exportSizeOption).split('x');
+    if (size.count() == 2) {
+      exportSize = QSize(size[0].toInt(), size[1].toInt());
+    }
+
+    if (parser.value(exportFileOption).isEmpty() || exportSize.isEmpty()) {
+      std::cerr << tr("--export-view needs --export-file and a valid --export-size.\n").toUtf8().constData();
+      std::cerr << parser.helpText().toUtf8().constData();
+      exit(1);
+    }
+  }
+
   return new CAppOpts(parser.isSet(debugOption), parser.isSet(logfileOption), parser.isSet(nosplashOption),
-                      parser.value(configOption), parser.positionalArguments());
+                      parser.value(configOption), parser.positionalArguments(), parser.value(exportViewOption),
+                      parser.value(exportFileOption), exportSize, parser.value(exportTileSizeOption).toInt(),
+                      parser.value(exportThreadsOption).toInt());
 }
@@ -31,8 +31,12 @@
 #include <stdlib.h>
 #include <wctype.h>
 
+#include <condition_variable>
 #include <list>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 extern "C" {
@@ -56,6 +60,9 @@ extern "C" {
 
 #define HEADER_BLOCK_SIZE 1024
 
+// the number of tiles encoded in advance per worker thread
+#define TILES_PER_WORKER 4
+
 #pragma pack(1)
 
 struct jnx_hdr_t {
@@ -139,6 +146,29 @@ struct scale_t {
   uint32_t jnxScale;
 };
 
+/// a tile to be read from a file and encoded by a worker thread
+struct tile_job_t {
+  file_t* file;
+  uint32_t xoff;
+  uint32_t yoff;
+  uint32_t xsize;
+  uint32_t ysize;
+};
+
+/// the JPEG coded tile passed from a worker thread to the writer
+struct tile_result_t {
+  tile_result_t() : done(false), ok(false) {}
+  std::vector<JOCTET> jpg;
+  bool done;
+  bool ok;
+};
+
+/// the libjpeg destination manager writing into a worker's buffer
+struct jpg_destination_t {
+  jpeg_destination_mgr mgr;
+  std::vector<JOCTET>* buffer;
+};
+
 /// number of used levels
 static int32_t nLevels;
 /// up to five levels. nLevels gives the actual count
@@ -149,14 +179,17 @@ static std::list<file_t> files;
 static jnx_hdr_t jnx_hdr;
 /// the tile information table for all 5 levels
 static jnx_tile_t tileTable[JNX_MAX_TILES * 5];
-/// tile buffer for 8 bit palette tiles, private to readTile
-static uint8_t tileBuf8Bit[JNX_MAX_TILE_SIZE * JNX_MAX_TILE_SIZE] = {0};
-/// tile buffer for 24 bit raw RGB tiles, private to writeTile
-static uint8_t tileBuf24Bit[JNX_MAX_TILE_SIZE * JNX_MAX_TILE_SIZE * 3] = {0};
-/// tile buffer for 32 bit raw RGBA tiles
-static uint32_t tileBuf32Bit[JNX_MAX_TILE_SIZE * JNX_MAX_TILE_SIZE] = {0};
-/// internal jpeg buffer used by write tile.
-static std::vector<JOCTET> jpgbuf;
+/// all tiles in the order they are written to the output file
+static std::vector<tile_job_t> tileJobs;
+/// ring buffer of encoded tiles, indexed by the tile's index modulo it's size
+static std::vector<tile_result_t> tileResults;
+/// the index of the next tile to be encoded
+static uint32_t tileJobNext = 0;
+/// the index of the next tile to be written
+static uint32_t tileWriteNext = 0;
+/// guards tileResults, tileJobNext and tileWriteNext
+static std::mutex tileMutex;
+static std::condition_variable tileCondition;
 
 static void prinfFileinfo(const file_t& file) {
   printf("\n\n----------------------");
@@ -173,8 +206,8 @@ static void prinfFileinfo(const file_t& file) {
   printf("\nreal scale: %f m/px", file.scale);
 }
 
-bool readTile(uint32_t xoff, uint32_t yoff, uint32_t xsize, uint32_t ysize, file_t& file, uint32_t* output) {
-  GDALDataset* dataset = file.dataset;
+bool readTile(uint32_t xoff, uint32_t yoff, uint32_t xsize, uint32_t ysize, const file_t& file, GDALDataset* dataset,
+              uint8_t* tileBuf8Bit, uint32_t* output) {
   int32_t rasterBandCount = dataset->GetRasterCount();
 
   memset(output, -1, sizeof(uint32_t) * xsize * ysize);
@@ -216,12 +249,14 @@ bool readTile(uint32_t xoff, uint32_t yoff, uint32_t xsize, uint32_t ysize, file
 }
 
 static void init_destination(j_compress_ptr cinfo) {
+  std::vector<JOCTET>& jpgbuf = *((jpg_destination_t*)cinfo->dest)->buffer;
   jpgbuf.resize(JPG_BLOCK_SIZE);
   cinfo->dest->next_output_byte = &jpgbuf[0];
   cinfo->dest->free_in_buffer = jpgbuf.size();
 }
 
 static boolean empty_output_buffer(j_compress_ptr cinfo) {
+  std::vector<JOCTET>& jpgbuf = *((jpg_destination_t*)cinfo->dest)->buffer;
   size_t oldsize = jpgbuf.size();
   jpgbuf.resize(oldsize + JPG_BLOCK_SIZE);
   cinfo->dest->next_output_byte = &jpgbuf[oldsize];
@@ -229,19 +264,23 @@ static boolean empty_output_buffer(j_compress_ptr cinfo) {
   return true;
 }
 
-static void term_destination(j_compress_ptr cinfo) { jpgbuf.resize(jpgbuf.size() - cinfo->dest->free_in_buffer); }
+static void term_destination(j_compress_ptr cinfo) {
+  std::vector<JOCTET>& jpgbuf = *((jpg_destination_t*)cinfo->dest)->buffer;
+  jpgbuf.resize(jpgbuf.size() - cinfo->dest->free_in_buffer);
+}
 
-static uint32_t writeTile(uint32_t xsize, uint32_t ysize, uint32_t* raw_image, FILE* fid, int quality,
-                          int subsampling) {
-  uint32_t size = 0;
+static void encodeTile(uint32_t xsize, uint32_t ysize, uint32_t* raw_image, uint8_t* tileBuf24Bit,
+                       std::vector<JOCTET>& jpgbuf, int quality, int subsampling) {
   struct jpeg_compress_struct cinfo;
   struct jpeg_error_mgr jerr;
   JSAMPROW row_pointer[1];
 
-  jpeg_destination_mgr destmgr = {0};
-  destmgr.init_destination = init_destination;
-  destmgr.empty_output_buffer = empty_output_buffer;
-  destmgr.term_destination = term_destination;
+  jpg_destination_t destmgr;
+  memset(&destmgr, 0, sizeof(destmgr));
+  destmgr.mgr.init_destination = init_destination;
+  destmgr.mgr.empty_output_buffer = empty_output_buffer;
+  destmgr.mgr.term_destination = term_destination;
+  destmgr.buffer = &jpgbuf;
 
   // convert from RGBA to RGB
   for (uint32_t r = 0; r < ysize; r++) {
@@ -256,7 +295,7 @@ static uint32_t writeTile(uint32_t xsize, uint32_t ysize, uint32_t* raw_image, F
   cinfo.err = jpeg_std_error(&jerr);
   jpeg_create_compress(&cinfo);
 
-  cinfo.dest = &destmgr;
+  cinfo.dest = &destmgr.mgr;
   cinfo.image_width = xsize;
   cinfo.image_height = ysize;
   cinfo.input_components = 3;
@@ -314,12 +353,62 @@ static uint32_t writeTile(uint32_t xsize, uint32_t ysize, uint32_t* raw_image, F
   /* similar to read file, clean up after we're done compressing */
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
+}
+
+/**
+   Read and encode tiles until all tiles are done. Each worker has it's own dataset
+   handles and buffers. The number of tiles encoded ahead of the writer is limited
+   by the size of tileResults.
+ */
+static void tileWorker(int quality, int subsampling) {
+  std::vector<uint8_t> tileBuf8Bit(JNX_MAX_TILE_SIZE * JNX_MAX_TILE_SIZE);
+  std::vector<uint8_t> tileBuf24Bit(JNX_MAX_TILE_SIZE * JNX_MAX_TILE_SIZE * 3);
+  std::vector<uint32_t> tileBuf32Bit(JNX_MAX_TILE_SIZE * JNX_MAX_TILE_SIZE);
+  // GDAL datasets must not be shared between threads
+  std::map<file_t*, GDALDataset*> datasets;
+
+  const uint32_t nJobs = tileJobs.size();
+  const uint32_t nResults = tileResults.size();
+  while (true) {
+    uint32_t idx;
+    {
+      std::unique_lock<std::mutex> lock(tileMutex);
+      tileCondition.wait(lock, [&] { return tileJobNext >= nJobs || tileJobNext < tileWriteNext + nResults; });
+      if (tileJobNext >= nJobs) {
+        break;
+      }
+      idx = tileJobNext++;
+    }
+
+    const tile_job_t& job = tileJobs[idx];
+    GDALDataset*& dataset = datasets[job.file];
+    if (dataset == 0) {
+      dataset = (GDALDataset*)GDALOpen(job.file->filename.c_str(), GA_ReadOnly);
+    }
 
-  // write data to output file
-  size = jpgbuf.size() - 2;
-  fwrite(&jpgbuf[2], size, 1, fid);
+    std::vector<JOCTET> jpg;
+    bool ok = dataset != 0 && readTile(job.xoff, job.yoff, job.xsize, job.ysize, *job.file, dataset,
+                                       tileBuf8Bit.data(), tileBuf32Bit.data());
+    if (ok) {
+      encodeTile(job.xsize, job.ysize, tileBuf32Bit.data(), tileBuf24Bit.data(), jpg, quality, subsampling);
+    }
 
-  return size;
+    {
+      std::lock_guard<std::mutex> lock(tileMutex);
+      tile_result_t& result = tileResults[idx % nResults];
+      result.jpg.swap(jpg);
+      result.ok = ok;
+      result.done = true;
+    }
+    tileCondition.notify_all();
+  }
+
+  std::map<file_t*, GDALDataset*>::iterator d;
+  for (d = datasets.begin(); d != datasets.end(); d++) {
+    if (d->second != 0) {
+      GDALClose(d->second);
+    }
+  }
 }
 
 static double distance(const double u1, const double v1, const double u2, const double v2) {
@@ -466,6 +555,7 @@ int main(int argc, char** argv) {
   OGRSpatialReference oSRS;
   int quality = -1;
   int subsampling = -1;
+  int threads = std::thread::hardware_concurrency();
 
   const char* copyright = "Unknown";
   const char* subscname = "BirdsEye";
@@ -482,7 +572,8 @@ int main(int argc, char** argv) {
   if (argc < 2) {
     fprintf(stderr,
             "\nusage: qmt_map2jnx -q <1..100> -s <411|422|444> -p <0..> -c \"copyright notice\" -m \"BirdsEye\" -n "
-            "\"Unknown\" -x file1_scale,file2_scale,...,fileN_scale <file1> <file2> ... <fileN> <outputfile>\n");
+            "\"Unknown\" -x file1_scale,file2_scale,...,fileN_scale -t <1..> <file1> <file2> ... <fileN> "
+            "<outputfile>\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "  -q The JPEG quality from 1 to 100. Default is 75 \n");
     fprintf(stderr, "  -s The chroma subsampling. Default is 411  \n");
@@ -492,6 +583,7 @@ int main(int argc, char** argv) {
     fprintf(stderr, "  -n The map name. Default is \"Unknown\"  \n");
     fprintf(stderr, "  -z The z order (drawing order). Default is 25\n");
     fprintf(stderr, "  -x Override levels scale. Default: autodetect\n");
+    fprintf(stderr, "  -t The number of threads reading and encoding tiles. Default is the number of cores\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "\nThe projection of the input files must have the same latitude along");
     fprintf(stderr, "\na pixel row. Mecator and Longitude/Latitude projections match this");
@@ -565,6 +657,10 @@ int main(int argc, char** argv) {
         jnx_hdr.zorder = atol(argv[i + 1]);
         skip_next_arg = 1;
         continue;
+      } else if (towupper(argv[i][1]) == 'T') {
+        threads = atol(argv[i + 1]);
+        skip_next_arg = 1;
+        continue;
       } else if (towupper(argv[i][1]) == 'X') {
         skip_next_arg = 1;
 
@@ -812,8 +908,7 @@ int main(int argc, char** argv) {
   fwrite(tileTable, sizeof(jnx_tile_t), tilesTotal, fid);
 
   // --------------------------------------------------------------
-  // read tiles from input files and write jpeg coded tiles to output file
-  printf("\n\nStart conversion:\n");
+  // collect all tiles in the order of the tile table
   for (int l = 0; l < nLevels; l++) {
     level_t& level = levels[l];
 
@@ -840,12 +935,6 @@ int main(int argc, char** argv) {
             xsize = (file.width - xoff);
           }
 
-          // //
-          if (!readTile(xoff, yoff, xsize, ysize, file, tileBuf32Bit)) {
-            fprintf(stderr, "\nError reading tiles from map file\n");
-            exit(-1);
-          }
-
           jnx_tile_t& tile = tileTable[tileCnt++];
           if (file.proj.isSrcLatLong()) {
             double u1 = file.lon1 + xoff * file.xscale;
@@ -874,11 +963,15 @@ int main(int argc, char** argv) {
 
           tile.width = xsize;
           tile.height = ysize;
-          tile.offset = (uint32_t)(ftello(fid) & 0x0FFFFFFFF);
-          tile.size = writeTile(xsize, ysize, tileBuf32Bit, fid, quality, subsampling);
 
-          printProgress(tileCnt, tilesTotal);
-          // //
+          tile_job_t job;
+          job.file = &file;
+          job.xoff = xoff;
+          job.yoff = yoff;
+          job.xsize = xsize;
+          job.ysize = ysize;
+          tileJobs.push_back(job);
+
           xoff += xsize;
         }
 
@@ -887,6 +980,58 @@ int main(int argc, char** argv) {
     }
   }
 
+  // --------------------------------------------------------------
+  // read and encode the tiles in worker threads and write them in order of the tile table
+  threads = MAX(1, threads);
+  printf("\n\nStart conversion with %i threads:\n", threads);
+
+  tileResults.resize(threads * TILES_PER_WORKER);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; i++) {
+    workers.push_back(std::thread(tileWorker, quality, subsampling));
+  }
+
+  std::vector<JOCTET> jpg;
+  for (uint32_t i = 0; i < tileCnt; i++) {
+    bool ok;
+    {
+      std::unique_lock<std::mutex> lock(tileMutex);
+      tile_result_t& result = tileResults[i % tileResults.size()];
+      tileCondition.wait(lock, [&] { return result.done; });
+      jpg.swap(result.jpg);
+      ok = result.ok;
+      result.done = false;
+      tileWriteNext = i + 1;
+    }
+    tileCondition.notify_all();
+
+    if (!ok) {
+      fprintf(stderr, "\nError reading tiles from map file\n");
+      {
+        // stop the workers before leaving
+        std::lock_guard<std::mutex> lock(tileMutex);
+        tileJobNext = tileCnt;
+      }
+      tileCondition.notify_all();
+      for (size_t w = 0; w < workers.size(); w++) {
+        workers[w].join();
+      }
+      exit(-1);
+    }
+
+    // the JPEG's SOI marker is not stored
+    jnx_tile_t& tile = tileTable[i];
+    tile.offset = (uint32_t)(ftello(fid) & 0x0FFFFFFFF);
+    tile.size = jpg.size() - 2;
+    fwrite(&jpg[2], tile.size, 1, fid);
+
+    printProgress(i + 1, tilesTotal);
+  }
+
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+
   // terminate output file
   fwrite("BirdsEye", 8, 1, fid);
 
@@ -23,8 +23,62 @@
 
 #include <iostream>
 
+// the histogram of the median cut has 5 bits per color channel
+#define HIST_BITS 5
+#define HIST_SIZE (1 << (3 * HIST_BITS))
+// the lookup table of the nearest palette entry has 6 bits per color channel
+#define CUBE_BITS 6
+#define CUBE_SIZE (1 << (3 * CUBE_BITS))
+// the size of the tiles processed by the worker threads, a multiple of the target's block size
+#define TILE_SIZE 1024
+// the height of the full width strips dithered by the worker threads, a multiple of the target's block size
+#define STRIP_HEIGHT 256
+// the width of the blocks a strip is dithered in, at least STRIP_HEIGHT
+#define BLOCK_WIDTH 1024
+// the maximum number of pixels sampled for the histogram
+#define MAX_SAMPLES (4096 * 4096)
+
 const GDALColorEntry CApp::noColor = {255, 255, 255, 0};
 
+/// a box of the median cut in histogram coordinates
+struct box_t {
+  qint32 min[3];
+  qint32 max[3];
+  quint64 count;
+};
+
+static inline qint32 histIndex(qint32 r, qint32 g, qint32 b) { return (r << (2 * HIST_BITS)) | (g << HIST_BITS) | b; }
+
+/// shrink the box to the populated part of the histogram and count the pixels
+static void shrinkBox(box_t& box, const QVector<quint32>& histogram) {
+  qint32 min[3] = {box.max[0], box.max[1], box.max[2]};
+  qint32 max[3] = {box.min[0], box.min[1], box.min[2]};
+  box.count = 0;
+
+  for (qint32 r = box.min[0]; r <= box.max[0]; r++) {
+    for (qint32 g = box.min[1]; g <= box.max[1]; g++) {
+      for (qint32 b = box.min[2]; b <= box.max[2]; b++) {
+        const quint32 n = histogram[histIndex(r, g, b)];
+        if (n == 0) {
+          continue;
+        }
+        box.count += n;
+        min[0] = qMin(min[0], r);
+        min[1] = qMin(min[1], g);
+        min[2] = qMin(min[2], b);
+        max[0] = qMax(max[0], r);
+        max[1] = qMax(max[1], g);
+        max[2] = qMax(max[2], b);
+      }
+    }
+  }
+
+  if (box.count != 0) {
+    memcpy(box.min, min, sizeof(min));
+    memcpy(box.max, max, sizeof(max));
+  }
+}
+
 void printStdoutQString(const QString& str) {
   QByteArray array = str.toUtf8();
   printf("%s", array.data());
@@ -38,12 +92,13 @@ void printStderrQString(const QString& str) {
 }
 
 CApp::CApp(qint32 ncolors, const QString& pctFilename, const QString& sctFilename, const QString& srcFilename,
-           const QString& tarFilename)
+           const QString& tarFilename, qint32 threads)
     : ncolors(ncolors),
       pctFilename(pctFilename),
       sctFilename(sctFilename),
       srcFilename(srcFilename),
-      tarFilename(tarFilename) {
+      tarFilename(tarFilename),
+      threads(qMax(1, threads)) {
   GDALAllRegister();
 }
 
@@ -82,16 +137,8 @@ GDALColorTable* CApp::createColorTable(qint32 ncolors, const QString& pctFilenam
   GDALColorTable* ct = nullptr;
   try {
     if (pctFilename.isEmpty()) {
-      ct = (GDALColorTable*)GDALCreateColorTable(GPI_RGB);
-
       printStdoutQString(tr("Calculate optimal color table from source file"));
-
-      int ok = GDALComputeMedianCutPCT(dataset->GetRasterBand(1), dataset->GetRasterBand(2), dataset->GetRasterBand(3),
-                                       nullptr, ncolors, ct, GDALTermProgress, 0);
-
-      if (ok != CE_None) {
-        throw tr("Failed to create color table.");
-      }
+      ct = computeMedianCut(ncolors, dataset);
     } else {
       GDALDataset* dsPct = (GDALDataset*)GDALOpenShared(pctFilename.toUtf8(), GA_ReadOnly);
       if (dsPct == nullptr) {
@@ -175,49 +222,195 @@ void CApp::ditherMap(GDALDataset* dsSrc, const QString& tarFilename, GDALColorTa
     dsSrc->GetGeoTransform(adfGeoTransform);
     dataset->SetGeoTransform(adfGeoTransform);
 
-    printStdoutQString(tr("Dither source file to target file"));
-    int res = GDALDitherRGB2PCT(dsSrc->GetRasterBand(1), dsSrc->GetRasterBand(2), dsSrc->GetRasterBand(3),
-                                dataset->GetRasterBand(1), ct, GDALTermProgress, 0);
-    if (res != CE_None) {
-      throw tr("Failed to dither file.");
-    }
+    QVector<quint8> cube;
+    createColorCube(ct, cube);
 
-    if (dsSrc->GetRasterCount() == 3) {
-      return;
+    const qint32 N = ct->GetColorEntryCount();
+    QVector<qint32> palette(N * 3);
+    for (qint32 i = 0; i < N; i++) {
+      const GDALColorEntry* entry = ct->GetColorEntry(i);
+      palette[i * 3] = entry->c1;
+      palette[i * 3 + 1] = entry->c2;
+      palette[i * 3 + 2] = entry->c3;
     }
 
-    GDALRasterBand* alpha = dsSrc->GetRasterBand(4);
+    // pixels with an alpha value other than 255 become "no data"
+    const qint32 nBands = dsSrc->GetRasterCount();
+    const quint8 nodata = N;
     GDALRasterBand* band = dataset->GetRasterBand(1);
 
-    QByteArray buffer1(xsize, 0);
-    QByteArray buffer2(xsize, 0);
-
-    quint8 nodata = band->GetNoDataValue();
-    printStdoutQString(tr("Apply alpha channel as no data value to target file"));
-    for (int y = 0; y < ysize; y++) {
-      GDALTermProgress(double(xsize * y) / (xsize * ysize), 0, 0);
-      res = alpha->RasterIO(GF_Read, 0, y, xsize, 1, buffer1.data(), xsize, 1, GDT_Byte, 0, 0);
-      if (res != CE_None) {
-        throw tr("Failed to read from alpha channel.");
+    // The image is split into full width strips. Each worker thread takes a strip and dithers it block
+    // by block from left to right. A pixel passes it's error to the right and to the row below. The
+    // blocks are parallelograms: each row starts one pixel left of the row above. Thus all errors of a
+    // pixel are known when it's block is dithered, and block j of a strip can start as soon as block
+    // j + 1 of the strip above is done (wavefront). The strips are taken in order, so the strip waited
+    // for is always processed by another worker.
+    QVector<QRect> strips;
+    for (qint32 y = 0; y < ysize; y += STRIP_HEIGHT) {
+      strips << QRect(0, y, xsize, qMin(STRIP_HEIGHT, ysize - y));
+    }
+    const qint32 nBlocks = (xsize + BLOCK_WIDTH - 1) / BLOCK_WIDTH;
+
+    QMutex mutex;
+    QWaitCondition condition;
+    QVector<qint32> cntBlocksDone(strips.count(), 0);
+    qint32 cntBlocks = 0;
+    bool abort = false;
+    // the errors passed to the first row of each strip, in 1/16 units with one extra pixel to the left
+    // and right. A strip's entry is allocated by whichever of the two strips sharing it starts first.
+    const qint32 sizeError = (xsize + 2) * 3;
+    QVector<QVector<qint32>> errorStrips(strips.count() + 1);
+
+    auto ditherStrip = [&](GDALDataset* src, const QRect& strip) {
+      const qint32 idxStrip = strip.y() / STRIP_HEIGHT;
+      const qint32 h = strip.height();
+
+      const qint32* errorIn;
+      qint32* errorOut;
+      {
+        QMutexLocker lock(&mutex);
+        for (qint32 i : {idxStrip, idxStrip + 1}) {
+          if (errorStrips[i].isEmpty()) {
+            errorStrips[i].fill(0, sizeError);
+          }
+        }
+        errorIn = errorStrips[idxStrip].constData();
+        errorOut = errorStrips[idxStrip + 1].data();
       }
 
-      res = band->RasterIO(GF_Read, 0, y, xsize, 1, buffer2.data(), xsize, 1, GDT_Byte, 0, 0);
-      if (res != CE_None) {
-        throw tr("Failed to read from target file.");
-      }
+      // Floyd-Steinberg error diffusion, the errors of the current and the next row are stored in
+      // 1/16 units by column with one extra pixel to the left and right
+      QVector<qint32> error1(sizeError, 0);
+      QVector<qint32> error2(sizeError, 0);
+      // the errors left over for the first two columns of each row of the next block
+      QVector<qint32> carry(h * 6, 0);
+      QVector<quint8> indices(xsize * h);
+
+      const qint32* pal = palette.constData();
+      const quint8* lut = cube.constData();
+
+      for (qint32 j = 0; j < nBlocks; j++) {
+        const qint32 x0 = j * BLOCK_WIDTH;
+        const qint32 x1 = qMin(x0 + BLOCK_WIDTH, xsize);
+        // the columns of row k of the block
+        auto first = [&](qint32 k) { return j == 0 ? 0 : x0 - k; };
+        auto last = [&](qint32 k) { return j == nBlocks - 1 ? xsize : x1 - k; };
+
+        const qint32 rx = first(h - 1);
+        const qint32 rw = last(0) - rx;
+        QVector<quint8> pixels(rw * h * nBands);
+        CPLErr res = src->RasterIO(GF_Read, rx, strip.y(), rw, h, pixels.data(), rw, h, GDT_Byte, nBands, nullptr,
+                                   nBands, rw * nBands, 1);
+
+        // wait for the blocks of the strip above passing errors to the first row of this block
+        {
+          QMutexLocker lock(&mutex);
+          if (res != CE_None) {
+            abort = true;
+            condition.wakeAll();
+            return false;
+          }
+          while (!abort && idxStrip > 0 && cntBlocksDone[idxStrip - 1] < qMin(j + 2, nBlocks)) {
+            condition.wait(&mutex);
+          }
+          if (abort) {
+            return false;
+          }
+        }
 
-      for (int x = 0; x < xsize; x++) {
-        if (buffer1[x] != char(0xFF)) {
-          buffer2[x] = nodata;
+        qint32* errCurr = error1.data();
+        qint32* errNext = error2.data();
+
+        // the first row starts with the errors passed by the strip above
+        {
+          const qint32 from = first(0);
+          const qint32 to = last(0);
+          // including the column after the next one, it is carried to the next block
+          memset(errCurr + from * 3, 0, sizeof(qint32) * (qMin(to + 1, xsize) - from + 2) * 3);
+          memcpy(errCurr + (from + 1) * 3, errorIn + (from + 1) * 3, sizeof(qint32) * (to - from) * 3);
+          if (j > 0) {
+            for (qint32 i = 0; i < 6; i++) {
+              errCurr[(from + 1) * 3 + i] += carry[i];
+            }
+          }
+        }
+
+        for (qint32 k = 0; k < h; k++) {
+          const qint32 from = first(k);
+          const qint32 to = last(k);
+
+          // the next row gets the errors of this row and the ones left over by the last block
+          memset(errNext + from * 3, 0, sizeof(qint32) * (to - from + 2) * 3);
+          if (j > 0 && k + 1 < h) {
+            for (qint32 i = 0; i < 6; i++) {
+              errNext[from * 3 + i] += carry[(k + 1) * 6 + i];
+            }
+          }
+
+          const quint8* pixel = pixels.constData() + (k * rw + from - rx) * nBands;
+          quint8* index = indices.data() + k * xsize + from;
+          for (qint32 x = from; x < to; x++, pixel += nBands, index++) {
+            if (nBands == 4 && pixel[3] != 0xFF) {
+              *index = nodata;
+              continue;
+            }
+
+            qint32* e = errCurr + (x + 1) * 3;
+            const qint32 r = qBound(0, pixel[0] + ((e[0] + 8) >> 4), 255);
+            const qint32 g = qBound(0, pixel[1] + ((e[1] + 8) >> 4), 255);
+            const qint32 b = qBound(0, pixel[2] + ((e[2] + 8) >> 4), 255);
+
+            const qint32 shift = 8 - CUBE_BITS;
+            const quint8 i = lut[((r >> shift) << (2 * CUBE_BITS)) | ((g >> shift) << CUBE_BITS) | (b >> shift)];
+            *index = i;
+
+            const qint32 err[3] = {r - pal[i * 3], g - pal[i * 3 + 1], b - pal[i * 3 + 2]};
+            qint32* n = errNext + (x + 1) * 3;
+            for (qint32 c = 0; c < 3; c++) {
+              e[c + 3] += err[c] * 7;
+              n[c - 3] += err[c] * 3;
+              n[c] += err[c] * 5;
+              n[c + 3] += err[c];
+            }
+          }
+
+          // the last two columns have not received all errors yet, the next block continues with them
+          if (j < nBlocks - 1) {
+            memcpy(carry.data() + k * 6, errCurr + (to + 1) * 3, sizeof(qint32) * 6);
+          }
+          qSwap(errCurr, errNext);
         }
-      }
 
-      res = band->RasterIO(GF_Write, 0, y, xsize, 1, buffer2.data(), xsize, 1, GDT_Byte, 0, 0);
-      if (res != CE_None) {
-        throw tr("Failed to write to target file.");
+        // pass the errors of the row below the last row to the strip below, the blocks to the left
+        // and right add their share to the columns next to this block
+        const qint32 from = first(h - 1);
+        const qint32 to = last(h - 1);
+        for (qint32 i = from * 3; i < (to + 2) * 3; i++) {
+          errorOut[i] += errCurr[i];
+        }
+
+        QMutexLocker lock(&mutex);
+        if (j == nBlocks - 1) {
+          // GDAL datasets must not be accessed by several threads at the same time
+          errorStrips[idxStrip].clear();
+          res = band->RasterIO(GF_Write, 0, strip.y(), xsize, h, indices.data(), xsize, h, GDT_Byte, 0, 0);
+          if (res != CE_None) {
+            abort = true;
+            condition.wakeAll();
+            return false;
+          }
+        }
+        cntBlocksDone[idxStrip]++;
+        GDALTermProgress(double(++cntBlocks) / (strips.count() * nBlocks), 0, 0);
+        condition.wakeAll();
       }
+      return true;
+    };
+
+    printStdoutQString(tr("Dither source file to target file"));
+    if (!forEachTile(strips, ditherStrip)) {
+      throw tr("Failed to dither file.");
     }
-    GDALTermProgress(1.0, 0, 0);
   } catch (const QString& msg) {
     GDALClose(dataset);
     throw msg;
@@ -226,3 +419,225 @@ void CApp::ditherMap(GDALDataset* dsSrc, const QString& tarFilename, GDALColorTa
   dataset->FlushCache();
   GDALClose(dataset);
 }
+
+GDALColorTable* CApp::computeMedianCut(qint32 ncolors, GDALDataset* dataset) {
+  const qint32 xsize = dataset->GetRasterXSize();
+  const qint32 ysize = dataset->GetRasterYSize();
+  const qint32 nBands = dataset->GetRasterCount();
+
+  // Large files are sampled by reading the tiles with reduced resolution. Each worker
+  // thread builds its own histogram. They are summed up at the end. Next to the pixel
+  // count the sum of each color channel is kept for each bin of the histogram.
+  const qint32 step = qMax(1, qCeil(qSqrt(double(xsize) * ysize / MAX_SAMPLES)));
+  const QVector<QRect>& tiles = splitIntoTiles(xsize, ysize, TILE_SIZE * step);
+
+  QVector<quint32> histogram(HIST_SIZE, 0);
+  QVector<quint64> sums(HIST_SIZE * 3, 0);
+  QMutex mutex;
+  qint32 cntTiles = 0;
+
+  auto sampleTile = [&](GDALDataset* src, const QRect& tile) {
+    const qint32 w = (tile.width() + step - 1) / step;
+    const qint32 h = (tile.height() + step - 1) / step;
+
+    QVector<quint8> pixels(w * h * nBands);
+    CPLErr res = src->RasterIO(GF_Read, tile.x(), tile.y(), tile.width(), tile.height(), pixels.data(), w, h,
+                               GDT_Byte, nBands, nullptr, nBands, w * nBands, 1);
+    if (res != CE_None) {
+      return false;
+    }
+
+    const qint32 shift = 8 - HIST_BITS;
+    QVector<quint32> hist(HIST_SIZE, 0);
+    QVector<quint64> sum(HIST_SIZE * 3, 0);
+    const quint8* pixel = pixels.constData();
+    for (qint32 i = 0; i < w * h; i++, pixel += nBands) {
+      if (nBands == 4 && pixel[3] != 0xFF) {
+        continue;
+      }
+      const qint32 idx = histIndex(pixel[0] >> shift, pixel[1] >> shift, pixel[2] >> shift);
+      hist[idx]++;
+      sum[idx * 3] += pixel[0];
+      sum[idx * 3 + 1] += pixel[1];
+      sum[idx * 3 + 2] += pixel[2];
+    }
+
+    QMutexLocker lock(&mutex);
+    for (qint32 i = 0; i < HIST_SIZE; i++) {
+      histogram[i] += hist[i];
+    }
+    for (qint32 i = 0; i < HIST_SIZE * 3; i++) {
+      sums[i] += sum[i];
+    }
+    GDALTermProgress(double(++cntTiles) / tiles.count(), 0, 0);
+    return true;
+  };
+
+  if (!forEachTile(tiles, sampleTile)) {
+    throw tr("Failed to create color table.");
+  }
+
+  // Split the box with the most pixels at the median of it's longest edge until
+  // there are enough boxes or no box can be split anymore.
+  const qint32 last = (1 << HIST_BITS) - 1;
+  box_t box = {{0, 0, 0}, {last, last, last}, 0};
+  shrinkBox(box, histogram);
+
+  QVector<box_t> boxes = {box};
+  while (boxes.count() < ncolors) {
+    qint32 idx = -1;
+    for (qint32 i = 0; i < boxes.count(); i++) {
+      const box_t& b = boxes[i];
+      const bool canSplit = b.max[0] > b.min[0] || b.max[1] > b.min[1] || b.max[2] > b.min[2];
+      if (canSplit && (idx < 0 || b.count > boxes[idx].count)) {
+        idx = i;
+      }
+    }
+    if (idx < 0) {
+      break;
+    }
+
+    box_t& box1 = boxes[idx];
+    qint32 axis = 0;
+    for (qint32 c = 1; c < 3; c++) {
+      if ((box1.max[c] - box1.min[c]) > (box1.max[axis] - box1.min[axis])) {
+        axis = c;
+      }
+    }
+
+    // count the pixels slice by slice along the axis until half of the box is reached
+    qint32 split = box1.min[axis];
+    quint64 sum = 0;
+    for (qint32 v = box1.min[axis]; v < box1.max[axis]; v++) {
+      qint32 lo[3] = {box1.min[0], box1.min[1], box1.min[2]};
+      qint32 hi[3] = {box1.max[0], box1.max[1], box1.max[2]};
+      lo[axis] = hi[axis] = v;
+      for (qint32 r = lo[0]; r <= hi[0]; r++) {
+        for (qint32 g = lo[1]; g <= hi[1]; g++) {
+          for (qint32 b = lo[2]; b <= hi[2]; b++) {
+            sum += histogram[histIndex(r, g, b)];
+          }
+        }
+      }
+      split = v;
+      if (sum * 2 >= box1.count) {
+        break;
+      }
+    }
+
+    box_t box2 = box1;
+    box1.max[axis] = split;
+    box2.min[axis] = split + 1;
+    shrinkBox(box1, histogram);
+    shrinkBox(box2, histogram);
+    boxes << box2;
+  }
+
+  // the color of each box is the mean of it's pixels
+  GDALColorTable* ct = (GDALColorTable*)GDALCreateColorTable(GPI_RGB);
+  for (qint32 i = 0; i < boxes.count(); i++) {
+    const box_t& b = boxes[i];
+    quint64 sum[3] = {0, 0, 0};
+    for (qint32 r = b.min[0]; r <= b.max[0]; r++) {
+      for (qint32 g = b.min[1]; g <= b.max[1]; g++) {
+        for (qint32 bl = b.min[2]; bl <= b.max[2]; bl++) {
+          const qint32 idx = histIndex(r, g, bl);
+          sum[0] += sums[idx * 3];
+          sum[1] += sums[idx * 3 + 1];
+          sum[2] += sums[idx * 3 + 2];
+        }
+      }
+    }
+
+    GDALColorEntry entry = {0, 0, 0, 255};
+    if (b.count != 0) {
+      entry.c1 = short((sum[0] + b.count / 2) / b.count);
+      entry.c2 = short((sum[1] + b.count / 2) / b.count);
+      entry.c3 = short((sum[2] + b.count / 2) / b.count);
+    }
+    ct->SetColorEntry(i, &entry);
+  }
+
+  return ct;
+}
+
+void CApp::createColorCube(const GDALColorTable* ct, QVector<quint8>& cube) {
+  // The palette is stored as one array per channel. Thus the compiler can vectorize
+  // the distance calculation for all entries.
+  const qint32 N = ct->GetColorEntryCount();
+  QVector<qint32> red(N), green(N), blue(N), dist(N);
+  for (qint32 i = 0; i < N; i++) {
+    const GDALColorEntry* entry = ct->GetColorEntry(i);
+    red[i] = entry->c1;
+    green[i] = entry->c2;
+    blue[i] = entry->c3;
+  }
+
+  const qint32 shift = 8 - CUBE_BITS;
+  const qint32 center = 1 << (shift - 1);
+  const qint32* pr = red.constData();
+  const qint32* pg = green.constData();
+  const qint32* pb = blue.constData();
+  qint32* pd = dist.data();
+
+  cube.resize(CUBE_SIZE);
+  for (qint32 idx = 0; idx < CUBE_SIZE; idx++) {
+    const qint32 r = ((idx >> (2 * CUBE_BITS)) << shift) + center;
+    const qint32 g = (((idx >> CUBE_BITS) & ((1 << CUBE_BITS) - 1)) << shift) + center;
+    const qint32 b = ((idx & ((1 << CUBE_BITS) - 1)) << shift) + center;
+
+    for (qint32 i = 0; i < N; i++) {
+      const qint32 dr = pr[i] - r;
+      const qint32 dg = pg[i] - g;
+      const qint32 db = pb[i] - b;
+      pd[i] = dr * dr + dg * dg + db * db;
+    }
+
+    qint32 best = 0;
+    for (qint32 i = 1; i < N; i++) {
+      if (pd[i] < pd[best]) {
+        best = i;
+      }
+    }
+    cube[idx] = best;
+  }
+}
+
+QVector<QRect> CApp::splitIntoTiles(qint32 xsize, qint32 ysize, qint32 tileSize) {
+  QVector<QRect> tiles;
+  for (qint32 y = 0; y < ysize; y += tileSize) {
+    for (qint32 x = 0; x < xsize; x += tileSize) {
+      tiles << QRect(x, y, qMin(tileSize, xsize - x), qMin(tileSize, ysize - y));
+    }
+  }
+  return tiles;
+}
+
+bool CApp::forEachTile(const QVector<QRect>& tiles, const fTile& func) {
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(threads);
+
+  QAtomicInt next(0);
+  QAtomicInt failed(0);
+  for (qint32 i = 0; i < threads; i++) {
+    threadPool.start([&]() {
+      // GDAL datasets must not be shared between threads
+      GDALDataset* dataset = (GDALDataset*)GDALOpen(srcFilename.toUtf8(), GA_ReadOnly);
+      if (dataset == nullptr) {
+        failed.ref();
+        return;
+      }
+
+      qint32 idx;
+      while (int(failed) == 0 && (idx = next.fetchAndAddRelaxed(1)) < tiles.count()) {
+        if (!func(dataset, tiles[idx])) {
+          failed.ref();
+        }
+      }
+      GDALClose(dataset);
+    });
+  }
+  threadPool.waitForDone();
+
+  return int(failed) == 0;
+}
@@ -22,6 +22,7 @@
 #include <gdal.h>
 
 #include <QtCore>
+#include <functional>
 
 class GDALColorTable;
 class GDALDataset;
@@ -30,21 +31,33 @@ class CApp {
   Q_DECLARE_TR_FUNCTIONS(CApp)
  public:
   CApp(qint32 ncolors, const QString& pctFilename, const QString& sctFilename, const QString& srcFilename,
-       const QString& tarFilename);
+       const QString& tarFilename, qint32 threads);
   virtual ~CApp() = default;
 
   qint32 exec();
 
  private:
-  static GDALColorTable* createColorTable(qint32 ncolors, const QString& pctFilename, GDALDataset* dataset);
+  /// process a tile of the source file, called by the worker threads with their own handle of the source file
+  using fTile = std::function<bool(GDALDataset* dataset, const QRect& tile)>;
+
+  GDALColorTable* createColorTable(qint32 ncolors, const QString& pctFilename, GDALDataset* dataset);
   static void saveColorTable(GDALColorTable* ct, QString& sctFilename);
-  static void ditherMap(GDALDataset* dsSrc, const QString& tarFilename, GDALColorTable* ct);
+  void ditherMap(GDALDataset* dsSrc, const QString& tarFilename, GDALColorTable* ct);
+
+  /// median cut on a histogram sampled from the source file
+  GDALColorTable* computeMedianCut(qint32 ncolors, GDALDataset* dataset);
+  /// the index of the nearest palette entry for all colors with reduced resolution
+  static void createColorCube(const GDALColorTable* ct, QVector<quint8>& cube);
+  static QVector<QRect> splitIntoTiles(qint32 xsize, qint32 ysize, qint32 tileSize);
+  /// call func for all tiles in parallel, return false if a call fails
+  bool forEachTile(const QVector<QRect>& tiles, const fTile& func);
 
   qint32 ncolors = 0;
   QString pctFilename;
   QString sctFilename;
   QString srcFilename;
   QString tarFilename;
+  qint32 threads = 1;
 
   static const GDALColorEntry noColor;
 };
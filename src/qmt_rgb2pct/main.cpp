@@ -95,6 +95,8 @@ int main(int argc, char** argv) {
       {{"n", "ncolors"}, QCoreApplication::translate("main", "Number of colors. (default: 255)"), "number", "255"},
       {{"p", "pct"}, QCoreApplication::translate("main", "Input palette file for color table (*.vrt)"), "filename", ""},
       {{"s", "sct"}, QCoreApplication::translate("main", "Save color table to palette file (*.vrt)"), "filename", ""},
+      {{"t", "threads"}, QCoreApplication::translate("main", "Number of threads. (default: number of cores)"), "number",
+       "0"},
   });
 
   // Process the actual command line arguments given by the user
@@ -129,6 +131,11 @@ int main(int argc, char** argv) {
   QString pctFilename = parser.value("pct");
   QString sctFilename = parser.value("sct");
 
-  CApp theApp(ncolors, pctFilename, sctFilename, srcFilename, tarFilename);
+  qint32 threads = parser.value("threads").toInt();
+  if (threads <= 0) {
+    threads = QThread::idealThreadCount();
+  }
+
+  CApp theApp(ncolors, pctFilename, sctFilename, srcFilename, tarFilename, threads);
   return theApp.exec();
 }
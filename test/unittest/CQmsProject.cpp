@@ -17,12 +17,14 @@
 **********************************************************************************************/
 
 #include <QtCore>
+#include <limits>
 
 #include "TestHelper.h"
 #include "test_QMapShack.h"
 
 #include "gis/gpx/CGpxProject.h"
 #include "gis/qms/CQmsProject.h"
+#include "gis/trk/CGisItemTrk.h"
 
 void test_QMapShack::_readQmsFile_1_6_0()
 {
@@ -37,17 +39,109 @@ void test_QMapShack::_readQmsFile_1_6_0()
 
 void test_QMapShack::_writeReadQmsFile()
 {
+    for(CQmsProject::format_e format : {CQmsProject::eFormatStream, CQmsProject::eFormatContainer})
+    {
+        for(const QString &file : inputFiles)
+        {
+            IGisProject *proj = readProjFile(file);
+
+            QString tmpFile = TestHelper::getTempFileName("qms");
+            CQmsProject::saveAs(tmpFile, *proj, format);
+
+            delete proj;
+
+            proj = readProjFile(tmpFile, true, false);
+            verify(file, *proj);
+
+            delete proj;
+
+            QFile(tmpFile).remove();
+        }
+    }
+}
+
+void test_QMapShack::_readQmsSummary()
+{
+    // files written by older versions have no index
+    CQmsProject::summary_t summary;
+    SUBVERIFY(!CQmsProject::readSummary(fileToPath("V1.6.0_file1.qms"), summary), "Old file has a summary");
+
     for(const QString &file : inputFiles)
     {
         IGisProject *proj = readProjFile(file);
 
+        // the plain stream has no index
         QString tmpFile = TestHelper::getTempFileName("qms");
-        CQmsProject::saveAs(tmpFile, *proj);
+        CQmsProject::saveAs(tmpFile, *proj, CQmsProject::eFormatStream);
+        SUBVERIFY(!CQmsProject::readSummary(tmpFile, summary), "Plain stream has a summary");
+
+        CQmsProject::saveAs(tmpFile, *proj, CQmsProject::eFormatContainer);
+
+        SUBVERIFY(CQmsProject::readSummary(tmpFile, summary), "Failed to read summary");
+        VERIFY_EQUAL(proj->getName(), summary.name);
+        VERIFY_EQUAL(proj->getItemCountByType(IGisItem::eTypeWpt), summary.cntItemsByType[IGisItem::eTypeWpt]);
+        VERIFY_EQUAL(proj->getItemCountByType(IGisItem::eTypeTrk), summary.cntItemsByType[IGisItem::eTypeTrk]);
+        VERIFY_EQUAL(proj->getItemCountByType(IGisItem::eTypeRte), summary.cntItemsByType[IGisItem::eTypeRte]);
+        VERIFY_EQUAL(proj->getItemCountByType(IGisItem::eTypeOvl), summary.cntItemsByType[IGisItem::eTypeOvl]);
+
+        // the boundary and the time span have to match the items
+        QRectF boundary;
+        QDateTime timeStart, timeEnd;
+        QSet<QString> keys;
+        bool first = true;
+        for(int i = 0; i < proj->childCount(); i++)
+        {
+            const IGisItem *item = dynamic_cast<const IGisItem*>(proj->child(i));
+            if(nullptr == item)
+            {
+                continue;
+            }
+            keys << item->getKey().item;
+
+            const QRectF &rect = item->getBoundingRect();
+            if(first)
+            {
+                boundary = rect;
+                first = false;
+            }
+            else
+            {
+                boundary = QRectF(QPointF(qMin(boundary.left(), rect.left()), qMax(boundary.top(), rect.top())),
+                                  QPointF(qMax(boundary.right(), rect.right()), qMin(boundary.bottom(), rect.bottom())));
+            }
+
+            const QDateTime &time = item->getTimestamp();
+            if(time.isValid() && (!timeStart.isValid() || time < timeStart))
+            {
+                timeStart = time;
+            }
+
+            // a track ends with it's last point
+            const CGisItemTrk *trk = dynamic_cast<const CGisItemTrk*>(item);
+            const QDateTime &end = (nullptr != trk) ? trk->getTimeEnd() : time;
+            if(end.isValid() && (!timeEnd.isValid() || end > timeEnd))
+            {
+                timeEnd = end;
+            }
+        }
+        SUBVERIFY(boundary == summary.boundary, "Boundary of summary does not match items");
+        SUBVERIFY(timeStart == summary.timeStart, "Start time of summary does not match items");
+        SUBVERIFY(timeEnd == summary.timeEnd, "End time of summary does not match items");
 
         delete proj;
 
+        // the items read back from the container have to be the same
         proj = readProjFile(tmpFile, true, false);
-        verify(file, *proj);
+        QSet<QString> keysRead;
+        for(int i = 0; i < proj->childCount(); i++)
+        {
+            const IGisItem *item = dynamic_cast<const IGisItem*>(proj->child(i));
+            if(nullptr != item)
+            {
+                keysRead << item->getKey().item;
+            }
+        }
+        SUBVERIFY(keys == keysRead, "Items read from container do not match");
 
         delete proj;
 
@@ -55,3 +149,62 @@ void test_QMapShack::_writeReadQmsFile()
     }
 }
 
+void test_QMapShack::_readQmsTrackPoints()
+{
+    // files written by older versions have no point chunks
+    QList<CQmsProject::track_points_t> tracks;
+    SUBVERIFY(!CQmsProject::readTrackPoints(fileToPath("V1.6.0_file1.qms"), tracks), "Old file has point chunks");
+
+    for(const QString &file : inputFiles)
+    {
+        IGisProject *proj = readProjFile(file);
+
+        QString tmpFile = TestHelper::getTempFileName("qms");
+        CQmsProject::saveAs(tmpFile, *proj, CQmsProject::eFormatContainer);
+
+        tracks.clear();
+        SUBVERIFY(CQmsProject::readTrackPoints(tmpFile, tracks), "Failed to read point chunks");
+
+        // the chunks are in the order of the tracks
+        int n = 0;
+        for(int i = 0; i < proj->childCount(); i++)
+        {
+            const CGisItemTrk *trk = dynamic_cast<const CGisItemTrk*>(proj->child(i));
+            if(nullptr == trk)
+            {
+                continue;
+            }
+            SUBVERIFY(n < tracks.size(), "Missing point chunk");
+            const CQmsProject::track_points_t &points = tracks[n++];
+
+            const CTrackData &data = trk->getTrackData();
+            VERIFY_EQUAL(data.segs.size(), points.segments.size());
+
+            int idx = 0;
+            for(int s = 0; s < data.segs.size(); s++)
+            {
+                const QVector<CTrackData::trkpt_t> &pts = data.segs[s].pts;
+                VERIFY_EQUAL(quint32(pts.size()), points.segments[s]);
+
+                for(const CTrackData::trkpt_t &pt : pts)
+                {
+                    SUBVERIFY(idx < points.lon.size(), "Missing points in chunk");
+                    VERIFY_EQUAL(pt.lon, points.lon[idx]);
+                    VERIFY_EQUAL(pt.lat, points.lat[idx]);
+                    VERIFY_EQUAL(pt.ele, points.ele[idx]);
+                    const qint64 time = pt.time.isValid() ? pt.time.toMSecsSinceEpoch()
+                                        : std::numeric_limits<qint64>::min();
+                    VERIFY_EQUAL(time, points.time[idx]);
+                    VERIFY_EQUAL(pt.flags, points.flags[idx]);
+                    idx++;
+                }
+            }
+            VERIFY_EQUAL(idx, points.lon.size());
+        }
+        VERIFY_EQUAL(n, tracks.size());
+
+        delete proj;
+
+        QFile(tmpFile).remove();
+    }
+}
@@ -0,0 +1,74 @@
+/**********************************************************************************************
+    Copyright (C) 2026 Oliver Eichler <oliver.eichler@gmx.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+**********************************************************************************************/
+
+#include <QtCore>
+
+#include "TestHelper.h"
+#include "test_QMapShack.h"
+
+#include "realtime/opensky/CRtOpenSkyParser.h"
+
+void test_QMapShack::_parseOpenSkyStates()
+{
+    QFile file(testInput + "/opensky/states.json");
+    SUBVERIFY(file.open(QIODevice::ReadOnly), "Failed to open recorded response");
+    const QByteArray &data = file.readAll();
+
+    const QJsonObject &json = QJsonDocument::fromJson(data).object();
+    const QJsonArray &jsonStates = json.value("states").toArray();
+
+    QList<QVector<CRtOpenSkyParser::value_t> > states;
+    CRtOpenSkyParser parser([&states](const QVector<CRtOpenSkyParser::value_t> &values){ states << values; });
+
+    // the result must not depend on how the response is split into chunks
+    for(int chunkSize : {1, 7, 64, data.size()})
+    {
+        states.clear();
+        parser.reset();
+        for(int i = 0; i < data.size(); i += chunkSize)
+        {
+            SUBVERIFY(parser.feed(data.mid(i, chunkSize)), "Parser error");
+        }
+
+        SUBVERIFY(parser.isFinished(), "Response not finished");
+        VERIFY_EQUAL(json.value("time").toInt(), parser.getTime());
+        VERIFY_EQUAL(jsonStates.count(), states.count());
+
+        for(int n = 0; n < states.count(); n++)
+        {
+            const QJsonArray &jsonState = jsonStates[n].toArray();
+            const QVector<CRtOpenSkyParser::value_t> &state = states[n];
+            VERIFY_EQUAL(jsonState.count(), state.count());
+
+            for(int i = 0; i < state.count(); i++)
+            {
+                VERIFY_EQUAL(jsonState[i].toString(), state[i].toString());
+                VERIFY_EQUAL(jsonState[i].toDouble(), state[i].toDouble());
+                VERIFY_EQUAL(jsonState[i].toBool(), state[i].toBool());
+            }
+        }
+    }
+
+    // a truncated response is not finished
+    parser.reset();
+    parser.feed(data.left(data.size() / 2));
+    SUBVERIFY(!parser.isFinished(), "Truncated response is finished");
+
+    parser.reset();
+    SUBVERIFY(!parser.feed("<html></html>"), "No error on invalid response");
+}
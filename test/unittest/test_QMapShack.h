@@ -63,6 +63,8 @@ class test_QMapShack : public QObject
     // CQmsProject
     void _readQmsFile_1_6_0();
     void _writeReadQmsFile();
+    void _readQmsSummary();
+    void _readQmsTrackPoints();
 
     // CFitProject
     void _readValidFitFiles();
@@ -70,6 +72,9 @@ class test_QMapShack : public QObject
     // CGisItemTrk
     void _filterDeleteExtension();
 
+    // CRtOpenSkyParser
+    void _parseOpenSkyStates();
+
 private slots:
     void initTestCase();
 
@@ -78,8 +83,11 @@ private slots:
     void testwriteReadGpxFile()         { TCWRAPPER( _writeReadGpxFile()         ) }
     void testreadQmsFile_1_6_0()        { TCWRAPPER( _readQmsFile_1_6_0()        ) }
     void testwriteReadQmsFile()         { TCWRAPPER( _writeReadQmsFile()         ) }
+    void testreadQmsSummary()           { TCWRAPPER( _readQmsSummary()           ) }
+    void testreadQmsTrackPoints()       { TCWRAPPER( _readQmsTrackPoints()       ) }
     void testreadExtGarminTPX1_gpxtpx() { TCWRAPPER( _readExtGarminTPX1_gpxtpx() ) }
     void testreadExtGarminTPX1_tp1()    { TCWRAPPER( _readExtGarminTPX1_tp1()    ) }
     void testreadValidFitFiles()        { TCWRAPPER( _readValidFitFiles()        ) }
     void testfilterDeleteExtension()    { TCWRAPPER( _filterDeleteExtension()    ) }
+    void testparseOpenSkyStates()       { TCWRAPPER( _parseOpenSkyStates()       ) }
 };